@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+#include <audio_mix.h>
+#include <vector>
+
+// One buffer of a typical audio callback
+constexpr int frames = 2048;
+
+static void BM_ToFloatS16(benchmark::State& state) {
+	std::vector<int16_t> src(frames * 2);
+	for (size_t i = 0; i < src.size(); ++i) {
+		src[i] = static_cast<int16_t>(i * 37);
+	}
+	std::vector<float> dst(src.size());
+	for (auto _: state) {
+		AudioMix::ToFloat(dst.data(), src.data(), AudioDecoder::Format::S16, static_cast<int>(src.size()));
+		benchmark::DoNotOptimize(dst.data());
+	}
+}
+
+BENCHMARK(BM_ToFloatS16);
+
+static void BM_Accumulate(benchmark::State& state) {
+	const int channels = state.range(0);
+	std::vector<float> src(frames * channels, 0.25f);
+	std::vector<float> mix(frames * 2, 0.0f);
+	for (auto _: state) {
+		AudioMix::Accumulate(mix.data(), src.data(), frames, channels, 0.5f, 0.75f);
+		benchmark::DoNotOptimize(mix.data());
+	}
+}
+
+BENCHMARK(BM_Accumulate)->Arg(1)->Arg(2);
+
+static void BM_ToS16(benchmark::State& state) {
+	const float total_volume = state.range(0) / 100.0f;
+	std::vector<float> mix(frames * 2);
+	for (size_t i = 0; i < mix.size(); ++i) {
+		mix[i] = static_cast<float>(static_cast<int>(i % 200) - 100) / 100.0f * total_volume;
+	}
+	std::vector<int16_t> dst(mix.size());
+	for (auto _: state) {
+		AudioMix::ToS16(dst.data(), mix.data(), static_cast<int>(mix.size()), total_volume);
+		benchmark::DoNotOptimize(dst.data());
+	}
+}
+
+BENCHMARK(BM_ToS16)->Arg(100)->Arg(300);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <audio_resampler.h>
+#include <audio_sinc_resampler.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// One buffer of a typical audio callback
+constexpr int frames = 2048;
+
+namespace {
+// Endless stereo sine at 22050 Hz, the rate of many RPG Maker sound effects
+class SineDecoder : public AudioDecoder {
+public:
+	bool Open(Filesystem_Stream::InputStream) override { return true; }
+	bool Seek(std::streamoff, std::ios_base::seekdir) override { return false; }
+	bool IsFinished() const override { return false; }
+	void GetFormat(int& frequency, Format& format, int& channels) const override {
+		frequency = 22050;
+		format = Format::F32;
+		channels = 2;
+	}
+	int GetTicks() const override { return 0; }
+
+private:
+	int FillBuffer(uint8_t* buffer, int size) override {
+		float* samples = reinterpret_cast<float*>(buffer);
+		const int count = size / 8;
+		for (int i = 0; i < count; ++i) {
+			samples[i * 2] = samples[i * 2 + 1] = std::sin(phase);
+			phase = std::fmod(phase + 0.125f, 6.2831853f);
+		}
+		return count * 8;
+	}
+
+	float phase = 0.0f;
+};
+}
+
+// Measures the backend the Player was built with: libspeexdsp, libsamplerate or the built-in one
+static void BM_AudioResampler(benchmark::State& state) {
+	AudioResampler resampler(std::make_unique<SineDecoder>(), static_cast<AudioResampler::Quality>(state.range(0)));
+	resampler.Open(Filesystem_Stream::InputStream());
+	resampler.SetFormat(44100, AudioDecoder::Format::F32, 2);
+	resampler.SetPitch(static_cast<int>(state.range(1)));
+
+	std::vector<float> out(frames * 2);
+	for (auto _: state) {
+		resampler.Decode(reinterpret_cast<uint8_t*>(out.data()), static_cast<int>(out.size() * sizeof(float)));
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * frames);
+}
+
+BENCHMARK(BM_AudioResampler)
+	->Args({static_cast<int>(AudioResampler::Quality::Linear), 150})
+	->Args({static_cast<int>(AudioResampler::Quality::Low), 100})
+	->Args({static_cast<int>(AudioResampler::Quality::Low), 150})
+	->Args({static_cast<int>(AudioResampler::Quality::Medium), 100})
+	->Args({static_cast<int>(AudioResampler::Quality::High), 100});
+
+// The built-in resampler without the decoder and format conversion overhead
+static void BM_SincResampler(benchmark::State& state) {
+	AudioSincResampler resampler(2, static_cast<AudioSincResampler::Quality>(state.range(0)));
+	resampler.SetRatio(22050.0 / 44100.0);
+
+	std::vector<float> in(frames + 2 * resampler.GetTaps());
+	for (size_t i = 0; i < in.size(); ++i) {
+		in[i] = std::sin(i * 0.125f);
+	}
+	std::vector<float> out(frames * 2);
+
+	for (auto _: state) {
+		int produced = 0;
+		while (produced < frames) {
+			int in_frames = static_cast<int>(in.size()) / 2;
+			int out_frames = frames - produced;
+			resampler.Process(in.data(), in_frames, out.data() + produced * 2, out_frames);
+			produced += out_frames;
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * frames);
+}
+
+BENCHMARK(BM_SincResampler)
+	->Arg(static_cast<int>(AudioSincResampler::Quality::Linear))
+	->Arg(static_cast<int>(AudioSincResampler::Quality::Low))
+	->Arg(static_cast<int>(AudioSincResampler::Quality::Medium))
+	->Arg(static_cast<int>(AudioSincResampler::Quality::High));
+
+BENCHMARK_MAIN();
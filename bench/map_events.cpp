@@ -0,0 +1,151 @@
+#include <benchmark/benchmark.h>
+#include <condition_variable>
+#include <functional>
+#include <game_event.h>
+#include <mutex>
+#include <thread>
+#include "render_game.h"
+
+constexpr int map_width = 40;
+constexpr int map_height = 30;
+
+static std::unique_ptr<lcf::rpg::Map> MakeMap(int num_events) {
+	auto map = std::make_unique<lcf::rpg::Map>();
+	map->chipset_id = 1;
+	map->width = map_width;
+	map->height = map_height;
+
+	map->lower_layer.resize(map_width * map_height);
+	map->upper_layer.resize(map_width * map_height, BLOCK_F);
+	for (int i = 0; i < map_width * map_height; ++i) {
+		map->lower_layer[i] = BLOCK_E + (i % BLOCK_E_TILES);
+	}
+
+	// Autonomous NPCs moving at the highest frequency
+	for (int i = 0; i < num_events; ++i) {
+		lcf::rpg::Event event;
+		event.ID = i + 1;
+		event.x = (i * 7) % map_width;
+		event.y = (i * 11 + i / map_width) % map_height;
+
+		lcf::rpg::EventPage page;
+		page.ID = 1;
+		page.character_name = lcf::DBString(CACHE_DEFAULT_BITMAP);
+		page.character_index = i % 8;
+		page.move_frequency = 8;
+		page.animation_type = lcf::rpg::EventPage::AnimType_continuous;
+		switch (i % 3) {
+			case 0:
+				page.move_type = lcf::rpg::EventPage::MoveType_random;
+				break;
+			case 1:
+				page.move_type = lcf::rpg::EventPage::MoveType_toward;
+				break;
+			default:
+				page.move_type = lcf::rpg::EventPage::MoveType_away;
+				break;
+		}
+		event.pages.push_back(std::move(page));
+
+		map->events.push_back(std::move(event));
+	}
+
+	return map;
+}
+
+/** The read-only passability pre-check of all four neighbours of every event */
+static int CheckPassability() {
+	int passable = 0;
+	for (auto& ev: Game_Map::GetEvents()) {
+		for (int dir = Game_Character::Up; dir <= Game_Character::Left; ++dir) {
+			int x = ev.GetX() + Game_Character::GetDxFromDirection(dir);
+			int y = ev.GetY() + Game_Character::GetDyFromDirection(dir);
+			passable += Game_Map::CheckWay(ev, ev.GetX(), ev.GetY(), x, y);
+		}
+	}
+	return passable;
+}
+
+/** Smallest possible worker thread: runs one job at a time while the caller waits */
+class Worker {
+public:
+	Worker() : thread([this]() { Loop(); }) {}
+
+	~Worker() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		cv.notify_all();
+		thread.join();
+	}
+
+	void Run(const std::function<void()>& fn) {
+		std::unique_lock<std::mutex> lock(mutex);
+		job = &fn;
+		cv.notify_all();
+		cv.wait(lock, [this]() { return job == nullptr; });
+	}
+
+private:
+	void Loop() {
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			cv.wait(lock, [this]() { return job || quit; });
+			if (quit) {
+				return;
+			}
+			(*job)();
+			job = nullptr;
+			cv.notify_all();
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	const std::function<void()>* job = nullptr;
+	bool quit = false;
+	std::thread thread;
+};
+
+static void BM_UpdateMapEvents(benchmark::State& state) {
+	RenderGame game(false);
+	Game_Map::Setup(MakeMap(state.range(0)));
+
+	for (auto _: state) {
+		MapUpdateAsyncContext actx;
+		// Pre-update covers the interpreters and the movement of all events
+		Game_Map::Update(actx, true);
+	}
+}
+
+BENCHMARK(BM_UpdateMapEvents)->Arg(100)->Arg(300)->Arg(500);
+
+static void BM_CheckPassability(benchmark::State& state) {
+	RenderGame game(false);
+	Game_Map::Setup(MakeMap(state.range(0)));
+
+	for (auto _: state) {
+		benchmark::DoNotOptimize(CheckPassability());
+	}
+}
+
+BENCHMARK(BM_CheckPassability)->Arg(100)->Arg(300)->Arg(500);
+
+static void BM_CheckPassabilityWorker(benchmark::State& state) {
+	RenderGame game(false);
+	Game_Map::Setup(MakeMap(state.range(0)));
+
+	Worker worker;
+	int passable = 0;
+	std::function<void()> job = [&]() { passable = CheckPassability(); };
+
+	for (auto _: state) {
+		worker.Run(job);
+		benchmark::DoNotOptimize(passable);
+	}
+}
+
+BENCHMARK(BM_CheckPassabilityWorker)->Arg(100)->Arg(300)->Arg(500);
+
+BENCHMARK_MAIN();
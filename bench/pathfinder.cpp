@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include <pathfinder.h>
+#include <cstdlib>
+#include <vector>
+
+constexpr int map_size = 500;
+
+// Wall rows with gaps at alternating ends, so long paths must zigzag.
+// In between random pillars, which never cut off any tile.
+static std::vector<bool> MakeMaze() {
+	std::vector<bool> walls(map_size * map_size, false);
+	uint32_t seed = 12345;
+	for (int y = 0; y < map_size; ++y) {
+		for (int x = 0; x < map_size; ++x) {
+			bool wall = false;
+			if (y % 8 == 7) {
+				int gap = ((y / 8) % 2) ? 2 : map_size - 3;
+				wall = std::abs(x - gap) > 1;
+			} else if (x % 2 == 1 && y % 2 == 1) {
+				seed = seed * 1103515245 + 12345;
+				wall = ((seed >> 16) % 100) < 40;
+			}
+			walls[y * map_size + x] = wall;
+		}
+	}
+	return walls;
+}
+
+static Pathfinder::CheckWayFn MakeCheckWay(const std::vector<bool>& walls) {
+	return [&walls](int, int, int to_x, int to_y) {
+		if (to_x < 0 || to_y < 0 || to_x >= map_size || to_y >= map_size) {
+			return false;
+		}
+		return !walls[to_y * map_size + to_x];
+	};
+}
+
+static Pathfinder::Args MakeArgs(int sx, int sy, int dx, int dy, bool diagonal) {
+	Pathfinder::Args args;
+	args.width = map_size;
+	args.height = map_size;
+	args.start_x = sx;
+	args.start_y = sy;
+	args.dest_x = dx;
+	args.dest_y = dy;
+	args.allow_diagonal = diagonal;
+	return args;
+}
+
+static void BM_FindPathOpen(benchmark::State& state) {
+	std::vector<bool> walls(map_size * map_size, false);
+	auto check_way = MakeCheckWay(walls);
+	auto args = MakeArgs(0, 0, map_size - 1, map_size - 1, state.range(0) != 0);
+
+	for (auto _: state) {
+		auto path = Pathfinder::FindPath(args, check_way);
+		benchmark::DoNotOptimize(path.directions.data());
+	}
+}
+
+BENCHMARK(BM_FindPathOpen)->Arg(0)->Arg(1);
+
+static void BM_FindPathMaze(benchmark::State& state) {
+	auto walls = MakeMaze();
+	auto check_way = MakeCheckWay(walls);
+	auto args = MakeArgs(0, 0, map_size - 1, map_size - 2, state.range(0) != 0);
+
+	for (auto _: state) {
+		auto path = Pathfinder::FindPath(args, check_way);
+		benchmark::DoNotOptimize(path.directions.data());
+	}
+}
+
+BENCHMARK(BM_FindPathMaze)->Arg(0)->Arg(1);
+
+// Many NPCs walking to nearby targets, like a crowded town map
+static void BM_FindPathNpcs(benchmark::State& state) {
+	auto walls = MakeMaze();
+	auto check_way = MakeCheckWay(walls);
+	const int num_npcs = state.range(0);
+
+	std::vector<Pathfinder::Args> searches;
+	for (int i = 0; i < num_npcs; ++i) {
+		// Start and destination between the same wall rows
+		int x = (i * 37) % (map_size - 30);
+		int y = ((i * 11) % (map_size / 8)) * 8;
+		auto args = MakeArgs(x, y, x + 30, y + 6, true);
+		args.search_max = 2000;
+		searches.push_back(args);
+	}
+
+	for (auto _: state) {
+		for (auto& args: searches) {
+			auto path = Pathfinder::FindPath(args, check_way);
+			benchmark::DoNotOptimize(path.directions.data());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * num_npcs);
+}
+
+BENCHMARK(BM_FindPathNpcs)->Arg(10)->Arg(100);
+
+BENCHMARK_MAIN();
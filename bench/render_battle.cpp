@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+#include <game_enemy.h>
+#include <sprite_enemy.h>
+#include "render_game.h"
+
+constexpr int num_pictures = 4;
+constexpr int num_cells = 8;
+
+static void SetupDatabase(int num_enemies, bool large) {
+	lcf::rpg::Enemy enemy;
+	enemy.ID = 1;
+	enemy.battler_name = lcf::DBString(CACHE_DEFAULT_BITMAP);
+	enemy.max_hp = 100;
+	lcf::Data::enemies.push_back(std::move(enemy));
+
+	lcf::rpg::Troop troop;
+	troop.ID = 1;
+	for (int i = 0; i < num_enemies; ++i) {
+		lcf::rpg::TroopMember member;
+		member.ID = i + 1;
+		member.enemy_id = 1;
+		member.x = 40 + (i % 4) * 60;
+		member.y = 60 + (i / 4) * 50;
+		troop.members.push_back(member);
+	}
+	lcf::Data::troops.push_back(std::move(troop));
+
+	// Looping animation where every frame uses all cells
+	lcf::rpg::Animation anim;
+	anim.ID = 1;
+	anim.animation_name = lcf::DBString(CACHE_DEFAULT_BITMAP);
+	anim.large = large;
+	for (int f = 0; f < 10; ++f) {
+		lcf::rpg::AnimationFrame frame;
+		frame.ID = f + 1;
+		for (int c = 0; c < num_cells; ++c) {
+			lcf::rpg::AnimationCellData cell;
+			cell.ID = c + 1;
+			cell.valid = 1;
+			cell.cell_id = (f + c) % 5;
+			cell.x = (c - num_cells / 2) * 12;
+			cell.y = (c % 3) * 10 - 10;
+			cell.zoom = 80 + c * 10;
+			cell.tone_red = 100 + c * 10;
+			cell.transparency = c * 10;
+			frame.cells.push_back(std::move(cell));
+		}
+		anim.frames.push_back(std::move(frame));
+	}
+	lcf::Data::animations.push_back(std::move(anim));
+}
+
+static void BM_RenderBattle(benchmark::State& state) {
+	RenderGame game(state.range(2) != 0);
+	SetupDatabase(state.range(0), state.range(1) != 0);
+
+	Main_Data::game_screen->InitGraphics();
+	Main_Data::game_pictures->InitGraphics();
+	game.ShowPictures(num_pictures);
+	game.SetScreenEffects();
+
+	Game_Battle::ChangeBackground(CACHE_DEFAULT_BITMAP);
+	Game_Battle::Init(1);
+
+	std::vector<Game_Battler*> targets;
+	for (auto* enemy: Main_Data::game_enemyparty->GetEnemies()) {
+		auto sprite = std::make_unique<Sprite_Enemy>(enemy);
+		sprite->SetVisible(true);
+		enemy->SetBattleSprite(std::move(sprite));
+		targets.push_back(enemy);
+	}
+
+	for (auto _: state) {
+		if (!Game_Battle::IsBattleAnimationWaiting()) {
+			Game_Battle::ShowBattleAnimation(1, targets);
+		}
+
+		Main_Data::game_screen->Update();
+		Main_Data::game_pictures->Update(true);
+		for (auto* battler: targets) {
+			battler->UpdateBattle();
+		}
+		Game_Battle::UpdateAnimation();
+		Game_Battle::UpdateGraphics();
+		game.Draw();
+	}
+}
+
+BENCHMARK(BM_RenderBattle)->ArgsProduct({{1, 8}, {0, 1}, {0, 1}});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,137 @@
+#ifndef EP_BENCH_RENDER_GAME_H
+#define EP_BENCH_RENDER_GAME_H
+
+#include <async_handler.h>
+#include <baseui.h>
+#include <cache.h>
+#include <game_actors.h>
+#include <game_battle.h>
+#include <game_config.h>
+#include <game_constants.h>
+#include <game_destiny.h>
+#include <game_dynrpg.h>
+#include <game_enemyparty.h>
+#include <game_ineluki.h>
+#include <game_map.h>
+#include <game_party.h>
+#include <game_pictures.h>
+#include <game_player.h>
+#include <game_quit.h>
+#include <game_screen.h>
+#include <game_strings.h>
+#include <game_switches.h>
+#include <game_system.h>
+#include <game_targets.h>
+#include <game_variables.h>
+#include <game_windows.h>
+#include <graphics.h>
+#include <main_data.h>
+#include <map_data.h>
+#include <platform/headless/ui.h>
+#include <player.h>
+#include <lcf/data.h>
+#include <memory>
+
+/**
+ * Sets up just enough of the engine to render a scene offscreen.
+ * All graphics are the builtin checkerboard assets, no game is needed.
+ * Everything is torn down again on destruction.
+ */
+class RenderGame {
+public:
+	explicit RenderGame(bool damage_tracking) {
+		Game_Config cfg;
+		DisplayUi = std::make_shared<HeadlessUi>(Player::screen_width, Player::screen_height, cfg);
+		DisplayUi->SetDamageTracking(damage_tracking);
+
+		Graphics::Init();
+
+		lcf::Data::terrains.push_back({});
+		lcf::Data::terrains.back().ID = 1;
+
+		lcf::rpg::Chipset chipset;
+		chipset.ID = 1;
+		chipset.chipset_name = lcf::DBString(CACHE_DEFAULT_BITMAP);
+		chipset.passable_data_lower.resize(162, 0xF);
+		chipset.passable_data_upper.resize(162, 0xF);
+		chipset.terrain_data.resize(144, 1);
+		lcf::Data::chipsets.push_back(std::move(chipset));
+
+		auto& treemap = lcf::Data::treemap;
+		treemap.maps.push_back({});
+		treemap.maps.back().type = lcf::rpg::TreeMap::MapType_root;
+		treemap.maps.push_back({});
+		treemap.maps.back().ID = 1;
+		treemap.maps.back().type = lcf::rpg::TreeMap::MapType_map;
+
+		Main_Data::game_constants = std::make_unique<Game_Constants>();
+		Main_Data::game_switches = std::make_unique<Game_Switches>();
+		Main_Data::game_variables = std::make_unique<Game_Variables>(Game_Variables::min_2k3, Game_Variables::max_2k3);
+		Main_Data::game_strings = std::make_unique<Game_Strings>();
+		Main_Data::game_screen = std::make_unique<Game_Screen>();
+		Main_Data::game_pictures = std::make_unique<Game_Pictures>();
+		Main_Data::game_windows = std::make_unique<Game_Windows>();
+		Main_Data::game_actors = std::make_unique<Game_Actors>();
+
+		Game_Map::Init();
+
+		Main_Data::game_system = std::make_unique<Game_System>();
+		Main_Data::game_targets = std::make_unique<Game_Targets>();
+		Main_Data::game_enemyparty = std::make_unique<Game_EnemyParty>();
+		Main_Data::game_party = std::make_unique<Game_Party>();
+		Main_Data::game_player = std::make_unique<Game_Player>();
+		Main_Data::game_quit = std::make_unique<Game_Quit>();
+		Main_Data::game_dynrpg = std::make_unique<Game_DynRpg>();
+		Main_Data::game_ineluki = std::make_unique<Game_Ineluki>();
+		Main_Data::game_destiny = std::make_unique<Game_Destiny>();
+
+		Main_Data::game_player->SetMapId(1);
+	}
+
+	~RenderGame() {
+		Game_Battle::Quit();
+
+		Main_Data::Cleanup();
+		Main_Data::game_variables.reset();
+		Main_Data::game_strings.reset();
+
+		Graphics::Quit();
+		AsyncHandler::ClearRequests();
+		DisplayUi.reset();
+
+		lcf::Data::data = {};
+		lcf::Data::treemap = {};
+	}
+
+	RenderGame(const RenderGame&) = delete;
+	RenderGame& operator=(const RenderGame&) = delete;
+
+	/** Shows pictures spread over the screen with different effects */
+	void ShowPictures(int count) {
+		for (int i = 0; i < count; ++i) {
+			Game_Pictures::ShowParams params;
+			params.name = CACHE_DEFAULT_BITMAP;
+			params.position_x = (i * 37) % Player::screen_width;
+			params.position_y = (i * 53) % Player::screen_height;
+			params.magnify_width = params.magnify_height = 50 + (i % 3) * 25;
+			params.top_trans = params.bottom_trans = (i % 4) * 20;
+			params.saturation = (i % 2) ? 100 : 50;
+			params.effect_mode = i % 3;
+			params.effect_power = 4;
+			Main_Data::game_pictures->Show(i + 1, params);
+		}
+	}
+
+	/** Enables weather and a screen tone which differs from the neutral one */
+	void SetScreenEffects() {
+		Main_Data::game_screen->SetWeatherEffect(Game_Screen::Weather_Rain, 2);
+		Main_Data::game_screen->TintScreen(120, 90, 100, 80, 0);
+	}
+
+	/** Renders one frame into the display surface */
+	void Draw() {
+		Graphics::Draw(*DisplayUi->GetDisplaySurface());
+	}
+};
+
+#endif
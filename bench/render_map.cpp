@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+#include <spriteset_map.h>
+#include "render_game.h"
+
+constexpr int map_width = 40;
+constexpr int map_height = 30;
+constexpr int num_pictures = 8;
+
+static std::unique_ptr<lcf::rpg::Map> MakeMap(int num_events) {
+	auto map = std::make_unique<lcf::rpg::Map>();
+	map->chipset_id = 1;
+	map->width = map_width;
+	map->height = map_height;
+	map->scroll_type = lcf::rpg::Map::ScrollType_both;
+	map->parallax_flag = true;
+	map->parallax_name = lcf::DBString(CACHE_DEFAULT_BITMAP);
+	map->parallax_loop_x = true;
+	map->parallax_loop_y = true;
+	map->parallax_auto_loop_x = true;
+	map->parallax_sx = 2;
+
+	map->lower_layer.resize(map_width * map_height);
+	map->upper_layer.resize(map_width * map_height);
+
+	// Mix of animated water, animated tiles, autotiles and plain tiles
+	for (int y = 0; y < map_height; ++y) {
+		for (int x = 0; x < map_width; ++x) {
+			int i = y * map_width + x;
+			switch ((x / 4 + y / 3) % 4) {
+				case 0:
+					map->lower_layer[i] = BLOCK_A + (i % 47);
+					break;
+				case 1:
+					map->lower_layer[i] = BLOCK_C + (i % BLOCK_C_TILES) * BLOCK_C_STRIDE;
+					break;
+				case 2:
+					map->lower_layer[i] = BLOCK_D + ((x + y) % BLOCK_D_TILES) * BLOCK_D_STRIDE + (i % 47);
+					break;
+				default:
+					map->lower_layer[i] = BLOCK_E + (i % BLOCK_E_TILES);
+					break;
+			}
+			map->upper_layer[i] = (i % 5 == 0) ? BLOCK_F + 1 + (i % (BLOCK_F_TILES - 1)) : BLOCK_F;
+		}
+	}
+
+	for (int i = 0; i < num_events; ++i) {
+		lcf::rpg::Event event;
+		event.ID = i + 1;
+		event.x = (i * 7) % map_width;
+		event.y = (i * 11) % map_height;
+
+		lcf::rpg::EventPage page;
+		page.ID = 1;
+		page.character_name = lcf::DBString(CACHE_DEFAULT_BITMAP);
+		page.character_index = i % 8;
+		page.character_direction = i % 4;
+		page.character_pattern = i % 3;
+		page.move_type = lcf::rpg::EventPage::MoveType_stationary;
+		event.pages.push_back(std::move(page));
+
+		map->events.push_back(std::move(event));
+	}
+
+	return map;
+}
+
+static void RenderMap(benchmark::State& state, bool scroll) {
+	RenderGame game(state.range(1) != 0);
+
+	Game_Map::Setup(MakeMap(state.range(0)));
+	Main_Data::game_screen->InitGraphics();
+	Main_Data::game_pictures->InitGraphics();
+	game.ShowPictures(num_pictures);
+	game.SetScreenEffects();
+
+	auto spriteset = std::make_unique<Spriteset_Map>();
+
+	int dx = SCREEN_TILE_SIZE / 8;
+	for (auto _: state) {
+		if (scroll) {
+			Game_Map::Scroll(dx, dx / 2);
+		}
+		Game_Map::Parallax::Update();
+		Main_Data::game_screen->Update();
+		Main_Data::game_pictures->Update(false);
+		spriteset->Update();
+		game.Draw();
+	}
+
+	spriteset.reset();
+}
+
+static void BM_RenderMap(benchmark::State& state) {
+	RenderMap(state, false);
+}
+
+BENCHMARK(BM_RenderMap)->ArgsProduct({{0, 50, 200}, {0, 1}});
+
+static void BM_RenderMapScroll(benchmark::State& state) {
+	RenderMap(state, true);
+}
+
+BENCHMARK(BM_RenderMapScroll)->ArgsProduct({{0, 50, 200}, {0, 1}});
+
+BENCHMARK_MAIN();
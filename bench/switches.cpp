@@ -64,5 +64,29 @@ static void BM_SwitchFlipRange(benchmark::State& state) {
 
 BENCHMARK(BM_SwitchFlipRange);
 
+static void BM_SwitchSetRangeUnaligned(benchmark::State& state) {
+	BM_SwitchOp(state, [](auto& s, auto id, bool val) { s.SetRange(id % 64 + 1, max_sws - id % 64, val); });
+}
+
+BENCHMARK(BM_SwitchSetRangeUnaligned);
+
+static void BM_SwitchFlipRangeUnaligned(benchmark::State& state) {
+	BM_SwitchOp(state, [](auto& s, auto id, bool) { s.FlipRange(id % 64 + 1, max_sws - id % 64); });
+}
+
+BENCHMARK(BM_SwitchFlipRangeUnaligned);
+
+static void BM_SwitchSetRangeSmall(benchmark::State& state) {
+	BM_SwitchOp(state, [](auto& s, auto id, bool val) { s.SetRange(id, std::min(id + 8, max_sws), val); });
+}
+
+BENCHMARK(BM_SwitchSetRangeSmall);
+
+static void BM_SwitchGetData(benchmark::State& state) {
+	BM_SwitchOp(state, [](auto& s, auto, bool) { benchmark::DoNotOptimize(s.GetData()); });
+}
+
+BENCHMARK(BM_SwitchGetData);
+
 
 BENCHMARK_MAIN();
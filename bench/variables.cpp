@@ -106,22 +106,70 @@ static void BM_VariableModRange(benchmark::State& state) {
 
 BENCHMARK(BM_VariableModRange);
 
+static void BM_VariableBitOrRange(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.BitOrRange(1, max_vars, val); });
+}
+
+BENCHMARK(BM_VariableBitOrRange);
+
+static void BM_VariableBitAndRange(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.BitAndRange(1, max_vars, val); });
+}
+
+BENCHMARK(BM_VariableBitAndRange);
+
+static void BM_VariableBitXorRange(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.BitXorRange(1, max_vars, val); });
+}
+
+BENCHMARK(BM_VariableBitXorRange);
+
 static void BM_VariableSetRangeVariable(benchmark::State& state) {
 	BM_VariableOp(state, [](auto& v, auto, auto val) { v.SetRangeVariable(1, max_vars, val); });
 }
 
 BENCHMARK(BM_VariableSetRangeVariable);
 
+static void BM_VariableAddRangeVariable(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.AddRangeVariable(1, max_vars, val); });
+}
+
+BENCHMARK(BM_VariableAddRangeVariable);
+
 static void BM_VariableSetRangeVariableIndirect(benchmark::State& state) {
 	BM_VariableOp(state, [](auto& v, auto, auto val) { v.SetRangeVariableIndirect(1, max_vars, val); });
 }
 
 BENCHMARK(BM_VariableSetRangeVariableIndirect);
 
+static void BM_VariableAddRangeVariableIndirect(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto val) { v.AddRangeVariableIndirect(1, max_vars, val); });
+}
+
+BENCHMARK(BM_VariableAddRangeVariableIndirect);
+
 static void BM_VariableSetRangeRandom(benchmark::State& state) {
 	BM_VariableOp(state, [](auto& v, auto, auto val) { v.SetRangeRandom(1, max_vars, -100, 100); });
 }
 
 BENCHMARK(BM_VariableSetRangeRandom);
 
+static void BM_VariableAddRangeRandom(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto) { v.AddRangeRandom(1, max_vars, -100, 100); });
+}
+
+BENCHMARK(BM_VariableAddRangeRandom);
+
+static void BM_VariableAddArray(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto) { v.AddArray(1, max_vars / 2, max_vars / 2 + 1); });
+}
+
+BENCHMARK(BM_VariableAddArray);
+
+static void BM_VariableSetArray(benchmark::State& state) {
+	BM_VariableOp(state, [](auto& v, auto, auto) { v.SetArray(1, max_vars / 2, max_vars / 2 + 1); });
+}
+
+BENCHMARK(BM_VariableSetArray);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,179 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "async_decoder.h"
+
+#ifdef WANT_ASYNC_DECODE
+#  include <algorithm>
+#  include <condition_variable>
+#  include <deque>
+#  include <mutex>
+#  include <thread>
+#  include <vector>
+#  include "output.h"
+
+namespace {
+	// Decoding is mostly memory bound, more threads do not help
+	constexpr unsigned max_workers = 2;
+
+	struct Task {
+		AsyncDecoder::Work work;
+		AsyncDecoder::Done done;
+	};
+
+	std::mutex mutex;
+	std::condition_variable work_cv;
+	std::condition_variable idle_cv;
+	std::deque<Task> queued;
+	std::vector<AsyncDecoder::Done> finished;
+	int running = 0;
+	bool stop = false;
+
+	// Threads must be joined before exit, also when Quit was not called
+	struct Workers {
+		std::vector<std::thread> threads;
+		~Workers() { AsyncDecoder::Quit(); }
+	} workers;
+
+	void WorkerMain() {
+		// The log is not thread-safe. Failed work is retried on the main thread.
+		Output::SetThreadMuted(true);
+
+		for (;;) {
+			Task task;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				work_cv.wait(lock, []() { return stop || !queued.empty(); });
+				if (stop) {
+					return;
+				}
+				task = std::move(queued.front());
+				queued.pop_front();
+				++running;
+			}
+
+			task.work();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				finished.push_back(std::move(task.done));
+				--running;
+			}
+			idle_cv.notify_all();
+		}
+	}
+
+	void StartWorkers() {
+		if (!workers.threads.empty()) {
+			return;
+		}
+
+		// Keep one core for the main thread
+		unsigned hw = std::thread::hardware_concurrency();
+		unsigned num = std::clamp(hw > 1 ? hw - 1 : 1u, 1u, max_workers);
+
+		stop = false;
+		for (unsigned i = 0; i < num; ++i) {
+			workers.threads.emplace_back(WorkerMain);
+		}
+	}
+}
+
+bool AsyncDecoder::IsSupported() {
+	return true;
+}
+
+void AsyncDecoder::Submit(Work work, Done done) {
+	StartWorkers();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queued.push_back({ std::move(work), std::move(done) });
+	}
+	work_cv.notify_one();
+}
+
+void AsyncDecoder::Update() {
+	std::vector<Done> done;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		done.swap(finished);
+	}
+
+	for (auto& fn: done) {
+		fn();
+	}
+}
+
+void AsyncDecoder::Flush() {
+	// Done functions can queue new work, repeat until nothing is left
+	while (IsBusy()) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			idle_cv.wait(lock, []() { return queued.empty() && running == 0; });
+		}
+		Update();
+	}
+}
+
+bool AsyncDecoder::IsBusy() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return !queued.empty() || running > 0 || !finished.empty();
+}
+
+void AsyncDecoder::Quit() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+		queued.clear();
+	}
+	work_cv.notify_all();
+
+	for (auto& thread: workers.threads) {
+		thread.join();
+	}
+	workers.threads.clear();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	finished.clear();
+}
+
+#else
+
+bool AsyncDecoder::IsSupported() {
+	return false;
+}
+
+void AsyncDecoder::Submit(Work work, Done done) {
+	work();
+	done();
+}
+
+void AsyncDecoder::Update() {
+}
+
+void AsyncDecoder::Flush() {
+}
+
+bool AsyncDecoder::IsBusy() {
+	return false;
+}
+
+void AsyncDecoder::Quit() {
+}
+
+#endif
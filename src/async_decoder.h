@@ -0,0 +1,70 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_ASYNC_DECODER_H
+#define EP_ASYNC_DECODER_H
+
+#include <functional>
+
+/**
+ * AsyncDecoder runs expensive asset decoding (e.g. images) on worker threads.
+ *
+ * The work function runs on a worker thread and must not touch any global
+ * state of the Player. The done function runs afterwards on the main thread
+ * when Update or Flush is called and publishes the result.
+ *
+ * Only available when the Player is built with WANT_ASYNC_DECODE.
+ */
+namespace AsyncDecoder {
+	using Work = std::function<void()>;
+	using Done = std::function<void()>;
+
+	/** @return Whether worker threads are available */
+	bool IsSupported();
+
+	/**
+	 * Queues work for a worker thread. The threads are started on first use.
+	 * When workers are not supported both functions are invoked immediately.
+	 *
+	 * @param work function invoked on a worker thread
+	 * @param done function invoked on the main thread after work finished
+	 */
+	void Submit(Work work, Done done);
+
+	/**
+	 * Invokes the done functions of all finished work.
+	 * Must be called from the main thread.
+	 */
+	void Update();
+
+	/**
+	 * Waits until all queued work is finished and invokes the done functions.
+	 * Must be called from the main thread.
+	 */
+	void Flush();
+
+	/** @return Whether work is queued or running or not published yet */
+	bool IsBusy();
+
+	/**
+	 * Stops all worker threads. Queued work that did not start yet is
+	 * discarded, the done functions of it are not invoked.
+	 */
+	void Quit();
+}
+
+#endif
@@ -26,6 +26,7 @@
    using json = nlohmann::json;
 #endif
 
+#include "async_decoder.h"
 #include "async_handler.h"
 #include "cache.h"
 #include "filefinder.h"
@@ -243,7 +244,28 @@ FileRequestAsync* AsyncHandler::RequestFile(std::string_view file_name) {
 	return RequestFile(".", file_name);
 }
 
+void AsyncHandler::Update() {
+	AsyncDecoder::Update();
+}
+
 bool AsyncHandler::IsFilePending(bool important, bool graphic) {
+#ifndef __EMSCRIPTEN__
+	if (important && AsyncDecoder::IsBusy()) {
+		// Waiting for the decoder takes a few milliseconds, this is better than skipping frames
+		bool must_wait = false;
+		for (auto& ap: async_requests) {
+			FileRequestAsync& request = ap.second;
+			if (!request.IsReady() && request.IsImportantFile() && (!graphic || request.IsGraphicFile())) {
+				must_wait = true;
+				break;
+			}
+		}
+		if (must_wait) {
+			AsyncDecoder::Flush();
+		}
+	}
+#endif
+
 	for (auto& ap: async_requests) {
 		FileRequestAsync& request = ap.second;
 
@@ -382,6 +404,19 @@ void FileRequestAsync::Start() {
 #  endif
 
 #  ifndef EP_DEBUG_SIMULATE_ASYNC
+	if (graphic) {
+		// Decode the image in the background. The request can be cleared meanwhile, look it up again.
+		bool decoding = Cache::DecodeAsync(directory, file, [path = path]() {
+			auto* request = GetRequest(path);
+			if (request && !request->IsReady()) {
+				request->DownloadDone(true);
+			}
+		});
+		if (decoding) {
+			return;
+		}
+	}
+
 	DownloadDone(true);
 #  endif
 #endif
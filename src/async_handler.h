@@ -30,6 +30,8 @@ struct FileRequestResult;
 /**
  * AsyncHandler supports asynchronous file requests for platforms that don't
  * support synchronous IO (e.g. Emscripten).
+ * On other platforms requests of graphic files are finished after the image
+ * was decoded on a worker thread (see AsyncDecoder).
  */
 namespace AsyncHandler {
 	/**
@@ -69,6 +71,12 @@ namespace AsyncHandler {
 	 */
 	FileRequestAsync* RequestFile(std::string_view file_name);
 
+	/**
+	 * Finishes requests of images that were decoded in the background.
+	 * Called once per frame by the main loop.
+	 */
+	void Update();
+
 	/**
 	 * Checks if any file with important-flag hasn't finished downloading yet.
 	 *
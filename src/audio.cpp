@@ -90,6 +90,9 @@ Game_ConfigAudio AudioInterface::GetConfig() const {
 	// FIXME: URI encoded SAF paths are not supported
 	acfg.soundfont.SetOptionVisible(false);
 #endif
+#ifndef WANT_ASYNC_DECODE
+	acfg.se_preload.SetOptionVisible(false);
+#endif
 
 	vGetConfig(acfg);
 	return acfg;
@@ -143,3 +146,19 @@ void AudioInterface::SetFluidsynthSoundfont(std::string_view sf) {
 	cfg.soundfont.Set(ToString(sf));
 	MidiDecoder::ChangeFluidsynthSoundfont(sf);
 }
+
+int AudioInterface::SE_GetCacheSize() const {
+	return cfg.se_cache_size.Get();
+}
+
+void AudioInterface::SE_SetCacheSize(int size) {
+	cfg.se_cache_size.Set(size);
+}
+
+bool AudioInterface::SE_GetPreloadEnabled() const {
+	return cfg.se_preload.Get();
+}
+
+void AudioInterface::SE_SetPreloadEnabled(bool enable) {
+	cfg.se_preload.Set(enable);
+}
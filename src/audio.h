@@ -162,6 +162,12 @@ struct AudioInterface {
 	std::string GetFluidsynthSoundfont() const;
 	void SetFluidsynthSoundfont(std::string_view sf);
 
+	int SE_GetCacheSize() const;
+	void SE_SetCacheSize(int size);
+
+	bool SE_GetPreloadEnabled() const;
+	void SE_SetPreloadEnabled(bool enable);
+
 protected:
 	Game_ConfigAudio cfg;
 };
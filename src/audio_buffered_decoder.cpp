@@ -0,0 +1,208 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "audio_buffered_decoder.h"
+
+#ifdef WANT_ASYNC_DECODE
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "output.h"
+
+namespace {
+	// The ring buffer is filled in chunks of this size
+	constexpr int chunks_per_ring = 8;
+}
+
+AudioBufferedDecoder::AudioBufferedDecoder(std::unique_ptr<AudioDecoderBase> wrapped, std::chrono::milliseconds ahead)
+	: decoder(std::move(wrapped))
+{
+	assert(decoder);
+
+	music_type = decoder->GetType();
+	pitch = decoder->GetPitch();
+	decoder->GetFormat(frequency, format, channels);
+
+	// Volume is applied by the mixer through this class
+	decoder->SetVolume(100);
+
+	const size_t frame_size = AudioDecoder::GetSamplesizeForFormat(format) * channels;
+	const size_t frames = std::max<size_t>(frequency * ahead.count() / 1000 / chunks_per_ring, 256);
+	chunk_size = frames * frame_size;
+	chunk_buffer.resize(chunk_size);
+	ring.resize(chunk_size * chunks_per_ring);
+
+	thread = std::thread(&AudioBufferedDecoder::WorkerMain, this);
+}
+
+AudioBufferedDecoder::~AudioBufferedDecoder() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	cv.notify_one();
+	thread.join();
+}
+
+bool AudioBufferedDecoder::Open(Filesystem_Stream::InputStream) {
+	// The wrapped decoder is already open
+	return false;
+}
+
+bool AudioBufferedDecoder::Seek(std::streamoff, std::ios_base::seekdir) {
+	return false;
+}
+
+bool AudioBufferedDecoder::IsFinished() const {
+	// The worker sets the flags after publishing its last data
+	const bool done = finished || failed;
+	return done && read_pos.load(std::memory_order_relaxed) == write_pos.load(std::memory_order_acquire);
+}
+
+void AudioBufferedDecoder::GetFormat(int& frequency, Format& format, int& channels) const {
+	frequency = this->frequency;
+	format = this->format;
+	channels = this->channels;
+}
+
+int AudioBufferedDecoder::GetPitch() const {
+	return pitch;
+}
+
+bool AudioBufferedDecoder::SetPitch(int new_pitch) {
+	if (new_pitch != pitch) {
+		pitch = new_pitch;
+		requested_pitch.store(new_pitch, std::memory_order_relaxed);
+		cv.notify_one();
+	}
+	return true;
+}
+
+int AudioBufferedDecoder::GetLoopCount() const {
+	return loop_count;
+}
+
+int AudioBufferedDecoder::GetTicks() const {
+	return ticks;
+}
+
+int AudioBufferedDecoder::FillBuffer(uint8_t* buffer, int size) {
+	// Loaded before the write position, then no data is missed when done
+	const bool error = failed;
+	const bool done = finished || error;
+	// The discard position is loaded first, it never exceeds the write position loaded afterwards
+	const size_t discard = discard_pos.load(std::memory_order_acquire);
+	const size_t write = write_pos.load(std::memory_order_acquire);
+	size_t read = std::max(read_pos.load(std::memory_order_relaxed), discard);
+
+	const size_t amount = std::min<size_t>(write - read, size);
+	const size_t offset = read % ring.size();
+	const size_t first = std::min(amount, ring.size() - offset);
+	memcpy(buffer, ring.data() + offset, first);
+	memcpy(buffer + first, ring.data(), amount - first);
+	read += amount;
+	read_pos.store(read, std::memory_order_release);
+
+	// Report the position of the consumed audio, not of the decoder
+	for (;;) {
+		if (!has_pending_marker) {
+			has_pending_marker = markers.Pop(pending_marker);
+		}
+		if (!has_pending_marker || pending_marker.end > read) {
+			break;
+		}
+		ticks = pending_marker.ticks;
+		loop_count = pending_marker.loop_count;
+		has_pending_marker = false;
+	}
+
+	cv.notify_one();
+
+	if (amount < static_cast<size_t>(size)) {
+		if (error && amount == 0) {
+			return -1;
+		}
+		if (!done) {
+			// The worker fell behind: Play silence instead of ending the stream
+			memset(buffer + amount, '\0', size - amount);
+			return size;
+		}
+	}
+
+	return static_cast<int>(amount);
+}
+
+void AudioBufferedDecoder::WorkerMain() {
+	// The log is not thread-safe
+	Output::SetThreadMuted(true);
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			// Time out because the audio thread notifies without taking the lock
+			cv.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+				const size_t used = write_pos.load(std::memory_order_relaxed) - read_pos.load(std::memory_order_acquire);
+				return stop || requested_pitch.load(std::memory_order_relaxed) >= 0 ||
+					(!finished && !failed && used + chunk_size <= ring.size());
+			});
+			if (stop) {
+				return;
+			}
+		}
+
+		size_t write = write_pos.load(std::memory_order_relaxed);
+
+		const int new_pitch = requested_pitch.exchange(-1, std::memory_order_relaxed);
+		if (new_pitch >= 0) {
+			decoder->SetPitch(new_pitch);
+			discard_pos.store(write, std::memory_order_release);
+		}
+
+		const size_t used = write - read_pos.load(std::memory_order_acquire);
+		if (finished || failed || used + chunk_size > ring.size()) {
+			continue;
+		}
+
+		int res = decoder->Decode(chunk_buffer.data(), static_cast<int>(chunk_buffer.size()));
+		if (res < 0) {
+			failed = true;
+			continue;
+		}
+
+		const size_t offset = write % ring.size();
+		const size_t first = std::min<size_t>(res, ring.size() - offset);
+		memcpy(ring.data() + offset, chunk_buffer.data(), first);
+		memcpy(ring.data(), chunk_buffer.data() + first, res - first);
+
+		Marker marker;
+		marker.end = write + res;
+		marker.ticks = decoder->GetTicks();
+		marker.loop_count = decoder->GetLoopCount();
+		// When the audio thread is not consuming losing a position update is harmless
+		markers.Push(std::move(marker));
+
+		write_pos.store(write + res, std::memory_order_release);
+
+		if (decoder->IsFinished() || res == 0) {
+			finished = true;
+		}
+	}
+}
+
+#endif
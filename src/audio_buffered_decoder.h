@@ -0,0 +1,129 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_AUDIO_BUFFERED_DECODER_H
+#define EP_AUDIO_BUFFERED_DECODER_H
+
+// Headers
+#include "audio_decoder.h"
+#include <memory>
+
+#ifdef WANT_ASYNC_DECODE
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "spsc_queue.h"
+
+/**
+ * Wraps another decoder and decodes it on a worker thread ahead of
+ * playback into a ring buffer. Decode only copies from the ring buffer,
+ * so expensive decoders (e.g. FluidSynth or resampling) do not stall the
+ * audio thread.
+ *
+ * The wrapped decoder must be opened and configured (format, pitch,
+ * looping) before it is passed to the constructor. Afterwards only the
+ * worker thread touches it.
+ *
+ * Volume, fade and balance are handled by this class and applied by the
+ * mixer, the wrapped decoder plays at full volume. This way they take
+ * effect immediately instead of after the buffered audio.
+ * A pitch change discards the buffered audio.
+ *
+ * Except for the constructor all functions must be called by the same
+ * thread, usually the audio thread.
+ */
+class AudioBufferedDecoder : public AudioDecoder {
+public:
+	/**
+	 * Starts decoding on the worker thread.
+	 *
+	 * @param decoder opened decoder, will be owned by this class
+	 * @param ahead amount of audio to decode ahead
+	 */
+	AudioBufferedDecoder(std::unique_ptr<AudioDecoderBase> decoder, std::chrono::milliseconds ahead);
+
+	/** Stops the worker thread and destroys the wrapped decoder */
+	~AudioBufferedDecoder();
+
+	bool Open(Filesystem_Stream::InputStream stream) override;
+	bool Seek(std::streamoff offset, std::ios_base::seekdir origin) override;
+	bool IsFinished() const override;
+	void GetFormat(int& frequency, Format& format, int& channels) const override;
+	int GetPitch() const override;
+
+	/**
+	 * Requests a pitch change from the worker thread.
+	 * Audio already decoded with the old pitch is discarded.
+	 *
+	 * @param pitch new pitch
+	 * @return always true
+	 */
+	bool SetPitch(int pitch) override;
+
+	/** @return loop count of the audio consumed so far */
+	int GetLoopCount() const override;
+
+	/** @return ticks of the audio consumed so far */
+	int GetTicks() const override;
+
+private:
+	/** Position in the audio stream after a decoded chunk */
+	struct Marker {
+		size_t end = 0;
+		int ticks = 0;
+		int loop_count = 0;
+	};
+
+	int FillBuffer(uint8_t* buffer, int size) override;
+	void WorkerMain();
+
+	std::unique_ptr<AudioDecoderBase> decoder;
+	int frequency = 0;
+	Format format = Format::F32;
+	int channels = 0;
+	int pitch = 100;
+
+	std::vector<uint8_t> ring;
+	std::vector<uint8_t> chunk_buffer;
+	size_t chunk_size = 0;
+	// Monotonic byte positions, the buffer index is the position modulo the ring size
+	std::atomic<size_t> read_pos = { 0 };
+	std::atomic<size_t> write_pos = { 0 };
+	/** Data before this position was decoded with an outdated pitch */
+	std::atomic<size_t> discard_pos = { 0 };
+
+	SpscQueue<Marker, 64> markers;
+	Marker pending_marker;
+	bool has_pending_marker = false;
+	int ticks = 0;
+	int loop_count = 0;
+
+	std::atomic<int> requested_pitch = { -1 };
+	std::atomic<bool> finished = { false };
+	std::atomic<bool> failed = { false };
+	std::atomic<bool> stop = { false };
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::thread thread;
+};
+
+#endif
+
+#endif
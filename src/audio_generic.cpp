@@ -20,9 +20,19 @@
 #include <cstring>
 #include <cassert>
 #include <memory>
+#include "audio_buffered_decoder.h"
 #include "audio_generic.h"
+#include "audio_mix.h"
+#include "instrumentation.h"
 #include "output.h"
 
+#ifdef WANT_ASYNC_DECODE
+namespace {
+	// Enough to cover a few late callbacks and expensive synthesizer passages
+	constexpr std::chrono::milliseconds bgm_decode_ahead(300);
+}
+#endif
+
 GenericAudio::GenericAudio(const Game_ConfigAudio& cfg) : AudioInterface(cfg) {
 	int i = 0;
 	for (auto& BGM_Channel : BGM_Channels) {
@@ -34,9 +44,7 @@ GenericAudio::GenericAudio(const Game_ConfigAudio& cfg) : AudioInterface(cfg) {
 	for (auto& SE_Channel : SE_Channels) {
 		SE_Channel.id = i++;
 		SE_Channel.decoder.reset();
-		SE_Channel.instance = this;
 	}
-	BGM_PlayedOnceIndicator = false;
 	midi_thread.reset();
 
 	// Initialize to some arbitrary (low-quality) format to prevent crashes
@@ -50,17 +58,14 @@ void GenericAudio::BGM_Play(Filesystem_Stream::InputStream stream, int volume, i
 		return;
 	}
 
+	++bgm_serial;
 	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.stopped = true; //Stop all running background music
-		if (!BGM_Channel.IsUsed()) {
-			// If there is an unused bgm channel
-			LockMutex();
-			BGM_PlayedOnceIndicator = false;
-			UnlockMutex();
-			PlayOnChannel(BGM_Channel, std::move(stream), volume, pitch, fadein, balance);
-			return;
+		if (BGM_Channel.IsUsed()) {
+			BGM_Channel.Stop(); //Stop all running background music
 		}
 	}
+
+	PlayOnChannel(BGM_Channels[0], std::move(stream), volume, pitch, fadein, balance);
 }
 
 void GenericAudio::BGM_Pause() {
@@ -80,29 +85,24 @@ void GenericAudio::BGM_Resume() {
 }
 
 void GenericAudio::BGM_Stop() {
-	LockMutex();
+	++bgm_serial;
 	for (auto& BGM_Channel : BGM_Channels) {
 		BGM_Channel.Stop();
 	}
-	BGM_PlayedOnceIndicator = false;
-	UnlockMutex();
 }
 
 bool GenericAudio::BGM_PlayedOnce() const {
-	if (BGM_PlayedOnceIndicator) {
-		return BGM_PlayedOnceIndicator;
-	}
-
-	LockMutex();
-	// Audio Decoders set this in the Decoding thread
 	for (auto& BGM_Channel : BGM_Channels) {
 		if (BGM_Channel.midi_out_used) {
-			BGM_PlayedOnceIndicator = midi_thread->GetMidiOut().GetLoopCount() > 0;
+			return midi_thread->GetMidiOut().GetLoopCount() > 0;
 		}
 	}
-	UnlockMutex();
 
-	return BGM_PlayedOnceIndicator;
+	// The state of the audio thread belongs to an older BGM until it applied the play
+	if (bgm_applied_serial.load(std::memory_order_acquire) != bgm_serial) {
+		return false;
+	}
+	return bgm_played_once.load(std::memory_order_relaxed);
 }
 
 bool GenericAudio::BGM_IsPlaying() const {
@@ -115,68 +115,49 @@ bool GenericAudio::BGM_IsPlaying() const {
 }
 
 int GenericAudio::BGM_GetTicks() const {
-	unsigned ticks = 0;
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
-		int cur_ticks = BGM_Channel.GetTicks();
-		if (cur_ticks >= 0) {
-			ticks = static_cast<unsigned>(cur_ticks);
+		if (BGM_Channel.midi_out_used) {
+			return std::max(midi_thread->GetMidiOut().GetTicks(), 0);
 		}
 	}
-	UnlockMutex();
-	return ticks;
+
+	if (bgm_applied_serial.load(std::memory_order_acquire) != bgm_serial) {
+		return 0;
+	}
+	return bgm_ticks.load(std::memory_order_relaxed);
 }
 
 void GenericAudio::BGM_Fade(int fade) {
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
 		BGM_Channel.SetFade(fade);
 	}
-	UnlockMutex();
 }
 
 void GenericAudio::BGM_Volume(int volume) {
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
 		BGM_Channel.SetVolume(volume);
 	}
-	UnlockMutex();
 }
 
 void GenericAudio::BGM_Pitch(int pitch) {
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
 		BGM_Channel.SetPitch(pitch);
 	}
-	UnlockMutex();
 }
 
 void GenericAudio::BGM_Balance(int balance) {
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
 		BGM_Channel.SetBalance(balance);
 	}
-	UnlockMutex();
 }
 
 std::string GenericAudio::BGM_GetType() const {
-	std::string type;
-
-	LockMutex();
 	for (auto& BGM_Channel : BGM_Channels) {
 		if (BGM_Channel.IsUsed()) {
-			if (BGM_Channel.midi_out_used) {
-				type = "midi";
-				break;
-			} else {
-				type = BGM_Channel.decoder->GetType();
-				break;
-			}
+			return BGM_Channel.midi_out_used ? "midi" : BGM_Channel.type;
 		}
 	}
-	UnlockMutex();
-
-	return type;
+	return {};
 }
 
 void GenericAudio::SE_Play(std::unique_ptr<AudioSeCache> se, int volume, int pitch, int balance) {
@@ -186,7 +167,7 @@ void GenericAudio::SE_Play(std::unique_ptr<AudioSeCache> se, int volume, int pit
 	}
 
 	for (auto& SE_Channel : SE_Channels) {
-		if (!SE_Channel.decoder) {
+		if (!SE_Channel.busy.load(std::memory_order_acquire)) {
 			//If there is an unused se channel
 			PlayOnChannel(SE_Channel, std::move(se), volume, pitch, balance);
 			return;
@@ -197,13 +178,16 @@ void GenericAudio::SE_Play(std::unique_ptr<AudioSeCache> se, int volume, int pit
 }
 
 void GenericAudio::SE_Stop() {
-	for (auto& SE_Channel : SE_Channels) {
-		SE_Channel.stopped = true; //Stop all running sound effects
-	}
+	PushCommand({ Command::Type::SeStop });
 }
 
 void GenericAudio::Update() {
-	// no-op, handled by the Decode function called through a thread
+	// Decoding happens in the Decode function called through a thread,
+	// only free the decoders it finished with
+	std::unique_ptr<AudioDecoderBase> decoder;
+	while (retired_decoders.Pop(decoder)) {
+		decoder.reset();
+	}
 }
 
 GenericAudioMidiOut* GenericAudio::CreateAndGetMidiOut() {
@@ -223,12 +207,12 @@ void GenericAudio::SetFormat(int frequency, AudioDecoder::Format format, int cha
 	output_format.frequency = frequency;
 	output_format.format = format;
 	output_format.channels = channels;
+
+	// Sound effects are cached in the output frequency
+	AudioSeCache::SetOutputFrequency(frequency);
 }
 
 bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStream filestream, int volume, int pitch, int fadein, int balance) {
-	chan.paused = true; // Pause channel so the audio thread doesn't work on it
-	chan.stopped = false; // Unstop channel so the audio thread doesn't delete it
-
 	std::string_view name = filestream.GetName();
 	if (!filestream) {
 		Output::Warning("BGM file not readable: {}", name);
@@ -237,8 +221,6 @@ bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStrea
 
 	// Midiout is only supported on channel 0 because this is an exclusive resource
 	if (chan.id == 0 && GenericAudioMidiOut::IsSupported(filestream)) {
-		chan.decoder.reset();
-
 		// Order is Fluidsynth, WildMidi, Native, FmMidi
 		bool fluidsynth = Audio().GetFluidsynthEnabled() && MidiDecoder::CreateFluidsynth(true);
 		bool wildmidi = Audio().GetWildMidiEnabled() && MidiDecoder::CreateWildMidi(true);
@@ -257,6 +239,7 @@ bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStrea
 					midi_out.SetBalance(balance);
 					midi_out.Resume();
 					chan.paused = false;
+					chan.stopped = false;
 					chan.midi_out_used = true;
 					midi_thread->UnlockMutex();
 					return true;
@@ -270,17 +253,28 @@ bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStrea
 		midi_thread->GetMidiOut().Reset();
 	}
 
-	chan.decoder = AudioDecoder::Create(filestream);
+	// The decoder is prepared here and handed over to the audio thread when ready
+	auto decoder = AudioDecoder::Create(filestream);
 	chan.midi_out_used = false;
-	if (chan.decoder && chan.decoder->Open(std::move(filestream))) {
-		chan.decoder->SetPitch(pitch);
-		chan.decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
-		chan.decoder->SetVolume(0);
-		chan.decoder->SetFade(volume, std::chrono::milliseconds(fadein));
-		chan.decoder->SetLooping(true);
-		chan.decoder->SetBalance(balance);
-		chan.paused = false; // Unpause channel -> Play it.
+	if (decoder && decoder->Open(std::move(filestream))) {
+		decoder->SetPitch(pitch);
+		// The mixer works on float, decoders which support it skip a conversion
+		decoder->SetFormat(output_format.frequency, AudioDecoder::Format::F32, output_format.channels);
+		decoder->SetLooping(true);
+#ifdef WANT_ASYNC_DECODE
+		// Decode on a worker thread, the audio thread only copies the samples
+		decoder = std::make_unique<AudioBufferedDecoder>(std::move(decoder), bgm_decode_ahead);
+#endif
+		decoder->SetVolume(0);
+		decoder->SetFade(volume, std::chrono::milliseconds(fadein));
+		decoder->SetBalance(balance);
 
+		chan.type = decoder->GetType();
+		chan.used = true;
+		chan.paused = false;
+		chan.stopped = false;
+
+		PushCommand({ Command::Type::BgmPlay, chan.id, bgm_serial, std::move(decoder) });
 		return true;
 	} else {
 		Output::Warning("Couldn't play BGM {}. Format not supported", name);
@@ -290,25 +284,108 @@ bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStrea
 }
 
 bool GenericAudio::PlayOnChannel(SeChannel& chan, std::unique_ptr<AudioSeCache> se, int volume, int pitch, int balance) {
-	chan.paused = true; // Pause channel so the audio thread doesn't work on it
-	chan.stopped = false; // Unstop channel so the audio thread doesn't delete it
-
-	chan.decoder = se->CreateSeDecoder();
-	chan.decoder->SetPitch(pitch);
-	chan.decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
-	chan.decoder->SetVolume(volume);
-	chan.decoder->SetBalance(balance);
-	chan.paused = false; // Unpause channel -> Play it.
+	auto decoder = se->CreateSeDecoder(pitch);
+	decoder->SetFormat(output_format.frequency, AudioDecoder::Format::F32, output_format.channels);
+	decoder->SetVolume(volume);
+	decoder->SetBalance(balance);
+
+	chan.busy.store(true, std::memory_order_relaxed);
+
+	PushCommand({ Command::Type::SePlay, chan.id, 0, std::move(decoder) });
 	return true;
 }
 
+void GenericAudio::PushCommand(Command&& command) {
+	if (commands.Push(std::move(command))) {
+		return;
+	}
+
+	// The audio thread is stalled, apply the commands here instead
+	LockMutex();
+	ProcessCommands();
+	commands.Push(std::move(command));
+	ProcessCommands();
+	UnlockMutex();
+}
+
+void GenericAudio::ProcessCommands() {
+	Command command;
+	while (commands.Pop(command)) {
+		switch (command.type) {
+			case Command::Type::BgmPlay: {
+				auto& chan = BGM_Channels[command.channel];
+				RetireDecoder(chan.decoder);
+				chan.decoder = std::move(command.decoder);
+				chan.decoder_paused = false;
+				bgm_played_once.store(false, std::memory_order_relaxed);
+				bgm_ticks.store(0, std::memory_order_relaxed);
+				bgm_applied_serial.store(command.value, std::memory_order_release);
+				break;
+			}
+			case Command::Type::BgmStop:
+				RetireDecoder(BGM_Channels[command.channel].decoder);
+				bgm_played_once.store(false, std::memory_order_relaxed);
+				bgm_ticks.store(0, std::memory_order_relaxed);
+				bgm_applied_serial.store(command.value, std::memory_order_release);
+				break;
+			case Command::Type::BgmPause:
+				BGM_Channels[command.channel].decoder_paused = command.value != 0;
+				break;
+			case Command::Type::BgmFade:
+			case Command::Type::BgmVolume:
+			case Command::Type::BgmPitch:
+			case Command::Type::BgmBalance: {
+				auto& decoder = BGM_Channels[command.channel].decoder;
+				if (!decoder) {
+					break;
+				}
+				if (command.type == Command::Type::BgmFade) {
+					decoder->SetFade(0, std::chrono::milliseconds(command.value));
+				} else if (command.type == Command::Type::BgmVolume) {
+					decoder->SetVolume(command.value);
+				} else if (command.type == Command::Type::BgmPitch) {
+					decoder->SetPitch(command.value);
+				} else {
+					decoder->SetBalance(command.value);
+				}
+				break;
+			}
+			case Command::Type::SePlay: {
+				auto& chan = SE_Channels[command.channel];
+				RetireDecoder(chan.decoder);
+				chan.decoder = std::move(command.decoder);
+				break;
+			}
+			case Command::Type::SeStop:
+				for (auto& SE_Channel : SE_Channels) {
+					if (SE_Channel.decoder) {
+						RetireDecoder(SE_Channel.decoder);
+						SE_Channel.busy.store(false, std::memory_order_release);
+					}
+				}
+				break;
+		}
+	}
+}
+
+void GenericAudio::RetireDecoder(std::unique_ptr<AudioDecoderBase>& decoder) {
+	if (decoder && !retired_decoders.Push(std::move(decoder))) {
+		// The game thread is not collecting them
+		decoder.reset();
+	}
+}
+
 void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
+	Instrumentation::ZoneScope zone(Instrumentation::Zone::AudioDecode);
+
 	bool channel_active = false;
 	float total_volume = 0;
 	int samples_per_frame = buffer_length / output_format.channels / 2;
 
 	assert(buffer_length > 0);
 
+	ProcessCommands();
+
 	if (sample_buffer.size() != (size_t)buffer_length) {
 		sample_buffer.resize(buffer_length);
 	}
@@ -319,7 +396,10 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 	if (scrap_buffer.size() != scrap_buffer_size) {
 		scrap_buffer.resize(scrap_buffer_size);
 	}
-	std::fill(mixer_buffer.begin(), mixer_buffer.end(), '\0');
+	if (float_buffer.size() != scrap_buffer_size) {
+		float_buffer.resize(scrap_buffer_size);
+	}
+	std::fill(mixer_buffer.begin(), mixer_buffer.end(), 0.0f);
 
 	for (unsigned i = 0; i < nr_of_bgm_channels + nr_of_se_channels; i++) {
 		int read_bytes = 0;
@@ -337,74 +417,69 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 			BgmChannel& currently_mixed_channel = BGM_Channels[i];
 			float current_master_volume = cfg.music_volume.Get() / 100.0f;
 
-			if (currently_mixed_channel.decoder && !currently_mixed_channel.paused) {
-				if (currently_mixed_channel.stopped) {
-					currently_mixed_channel.decoder.reset();
-				} else {
-					StereoVolume volume = currently_mixed_channel.decoder->GetVolume();
-					vleft = volume.left_volume / 100.0f * current_master_volume;
-					vright = volume.right_volume / 100.0f * current_master_volume;
-					currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
-					currently_mixed_channel.decoder->Update(std::chrono::milliseconds(samples_per_frame * 1000 / frequency));
-					samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
-
-					total_volume += std::max(vleft, vright);
+			if (currently_mixed_channel.decoder && !currently_mixed_channel.decoder_paused) {
+				StereoVolume volume = currently_mixed_channel.decoder->GetVolume();
+				vleft = volume.left_volume / 100.0f * current_master_volume;
+				vright = volume.right_volume / 100.0f * current_master_volume;
+				currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
+				currently_mixed_channel.decoder->Update(std::chrono::milliseconds(samples_per_frame * 1000 / frequency));
+				samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
 
-					// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
-					unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
-					bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
+				total_volume += std::max(vleft, vright);
 
-					read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
+				// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
+				unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
+				bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
 
-					if (read_bytes <= 0) {
-						// An error occured when reading - the channel is faulty - discard
-						currently_mixed_channel.decoder.reset();
-						continue; // skip this loop run - there is nothing to mix
-					}
+				read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
 
-					if (!currently_mixed_channel.stopped) {
-						BGM_PlayedOnceIndicator = currently_mixed_channel.decoder->GetLoopCount() > 0;
-					}
+				if (read_bytes <= 0) {
+					// An error occured when reading - the channel is faulty - discard
+					RetireDecoder(currently_mixed_channel.decoder);
+					continue; // skip this loop run - there is nothing to mix
+				}
 
-					channel_used = true;
+				if (currently_mixed_channel.decoder->GetLoopCount() > 0) {
+					bgm_played_once.store(true, std::memory_order_relaxed);
 				}
+				bgm_ticks.store(std::max(currently_mixed_channel.decoder->GetTicks(), 0), std::memory_order_relaxed);
+
+				channel_used = true;
 			}
 		} else {
 			SeChannel& currently_mixed_channel = SE_Channels[i - nr_of_bgm_channels];
 			float current_master_volume = cfg.sound_volume.Get() / 100.0f;
 
-			if (currently_mixed_channel.decoder && !currently_mixed_channel.paused) {
-				if (currently_mixed_channel.stopped) {
-					currently_mixed_channel.decoder.reset();
-				} else {
-					StereoVolume volume = currently_mixed_channel.decoder->GetVolume();
-					vleft = volume.left_volume / 100.0f * current_master_volume;
-					vright = volume.right_volume / 100.0f * current_master_volume;
-					currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
-					samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
-
-					total_volume += std::max(vleft, vright);
+			if (currently_mixed_channel.decoder) {
+				StereoVolume volume = currently_mixed_channel.decoder->GetVolume();
+				vleft = volume.left_volume / 100.0f * current_master_volume;
+				vright = volume.right_volume / 100.0f * current_master_volume;
+				currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
+				samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
 
-					// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
-					unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
-					bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
+				total_volume += std::max(vleft, vright);
 
-					read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
+				// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
+				unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
+				bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
 
-					if (read_bytes <= 0) {
-						// An error occured when reading - the channel is faulty - discard
-						currently_mixed_channel.decoder.reset();
-						continue; // skip this loop run - there is nothing to mix
-					}
+				read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
 
-					// Now decide what to do when a channel has reached its end
-					if (currently_mixed_channel.decoder->IsFinished()) {
-						// SE are only played once so free the se if finished
-						currently_mixed_channel.decoder.reset();
-					}
+				if (read_bytes <= 0) {
+					// An error occured when reading - the channel is faulty - discard
+					RetireDecoder(currently_mixed_channel.decoder);
+					currently_mixed_channel.busy.store(false, std::memory_order_release);
+					continue; // skip this loop run - there is nothing to mix
+				}
 
-					channel_used = true;
+				// Now decide what to do when a channel has reached its end
+				if (currently_mixed_channel.decoder->IsFinished()) {
+					// SE are only played once so free the se if finished
+					RetireDecoder(currently_mixed_channel.decoder);
+					currently_mixed_channel.busy.store(false, std::memory_order_release);
 				}
+
+				channel_used = true;
 			}
 		}
 
@@ -413,85 +488,24 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 		//--------------------------------------------------------------------------------------------------------------------//
 
 		if (channel_used) {
-			for (unsigned ii = 0; ii < (unsigned)(read_bytes / (samplesize * channels)); ii++) {
-
-				float vall = vleft;
-				float valr = vright;
-
-				// Convert to floating point
-				switch (sampleformat) {
-					case AudioDecoder::Format::S8:
-						vall *= (((int8_t *) scrap_buffer.data())[ii * channels] / 128.0);
-						valr *= (((int8_t *) scrap_buffer.data())[ii * channels + 1] / 128.0);
-						break;
-					case AudioDecoder::Format::U8:
-						vall *= (((uint8_t *) scrap_buffer.data())[ii * channels] / 128.0 - 1.0);
-						valr *= (((uint8_t *) scrap_buffer.data())[ii * channels + 1] / 128.0 - 1.0);
-						break;
-					case AudioDecoder::Format::S16:
-						vall *= (((int16_t *) scrap_buffer.data())[ii * channels] / 32768.0);
-						valr *= (((int16_t *) scrap_buffer.data())[ii * channels + 1] / 32768.0);
-						break;
-					case AudioDecoder::Format::U16:
-						vall *= (((uint16_t *) scrap_buffer.data())[ii * channels] / 32768.0 - 1.0);
-						valr *= (((uint16_t *) scrap_buffer.data())[ii * channels + 1] / 32768.0 - 1.0);
-						break;
-					case AudioDecoder::Format::S32:
-						vall *= (((int32_t *) scrap_buffer.data())[ii * channels] / 2147483648.0);
-						valr *= (((int32_t *) scrap_buffer.data())[ii * channels + 1] / 2147483648.0);
-						break;
-					case AudioDecoder::Format::U32:
-						vall *= (((uint32_t *) scrap_buffer.data())[ii * channels] / 2147483648.0 - 1.0);
-						valr *= (((uint32_t *) scrap_buffer.data())[ii * channels + 1] / 2147483648.0 - 1.0);
-						break;
-					case AudioDecoder::Format::F32:
-						vall *= (((float *) scrap_buffer.data())[ii * channels]);
-						valr *= (((float *) scrap_buffer.data())[ii * channels + 1]);
-						break;
-				}
-
-				if (!channel_active) {
-					// first channel
-					mixer_buffer[ii * output_format.channels] = vall;
-					if (channels > 1) {
-						mixer_buffer[ii * output_format.channels + 1] = valr;
-					} else {
-						mixer_buffer[ii * output_format.channels + 1] = mixer_buffer[ii * output_format.channels];
-					}
-				} else {
-					mixer_buffer[ii * output_format.channels] += vall;
-					if (channels > 1) {
-						mixer_buffer[ii * output_format.channels + 1] += valr;
-					} else {
-						mixer_buffer[ii * output_format.channels + 1] = mixer_buffer[ii * output_format.channels];
-					}
-				}
-
+			const int samples = read_bytes / samplesize;
+			const int frames = samples / channels;
+
+			// Normalize to float once, then accumulate the whole channel with its gain
+			const float* float_samples = reinterpret_cast<const float*>(scrap_buffer.data());
+			if (sampleformat != AudioDecoder::Format::F32) {
+				AudioMix::ToFloat(float_buffer.data(), scrap_buffer.data(), sampleformat, samples);
+				float_samples = float_buffer.data();
 			}
+			AudioMix::Accumulate(mixer_buffer.data(), float_samples, frames, channels, vleft, vright);
+
 			channel_active = true;
 		}
 	}
 
 	if (channel_active) {
-		if (total_volume > 1.0) {
-			float threshold = 0.8f;
-			for (unsigned i = 0; i < (unsigned)(samples_per_frame * 2); i++) {
-				float sample = mixer_buffer[i];
-				float sign = (sample < 0) ? -1.0 : 1.0;
-				sample /= sign;
-				//dynamic range compression
-				if (sample > threshold) {
-					sample_buffer[i] = sign * 32768.0 * (threshold + (1.0 - threshold) * (sample - threshold) / (total_volume - threshold));
-				} else {
-					sample_buffer[i] = sign * sample * 32768.0;
-				}
-			}
-		} else {
-			//No dynamic range compression necessary
-			for (unsigned i = 0; i < (unsigned)(samples_per_frame * 2); i++) {
-				sample_buffer[i] = mixer_buffer[i] * 32768.0;
-			}
-		}
+		// Single clamp and convert pass, compresses the dynamic range when the mix is too loud
+		AudioMix::ToS16(sample_buffer.data(), mixer_buffer.data(), samples_per_frame * 2, total_volume);
 
 		memcpy(output_buffer, sample_buffer.data(), buffer_length);
 	} else {
@@ -500,14 +514,15 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 }
 
 void GenericAudio::BgmChannel::Stop() {
-	stopped = true;
 	if (midi_out_used) {
 		midi_out_used = false;
 		instance->midi_thread->GetMidiOut().Reset();
 		instance->midi_thread->GetMidiOut().Pause();
-	} else if (decoder) {
-		decoder.reset();
+	} else if (used) {
+		instance->PushCommand({ Command::Type::BgmStop, id, instance->bgm_serial });
 	}
+	used = false;
+	stopped = true;
 }
 
 void GenericAudio::BgmChannel::SetPaused(bool newPaused) {
@@ -518,50 +533,43 @@ void GenericAudio::BgmChannel::SetPaused(bool newPaused) {
 		} else {
 			instance->midi_thread->GetMidiOut().Resume();
 		}
+	} else if (used) {
+		instance->PushCommand({ Command::Type::BgmPause, id, newPaused ? 1 : 0 });
 	}
 }
 
-int GenericAudio::BgmChannel::GetTicks() const {
-	if (midi_out_used) {
-		return instance->midi_thread->GetMidiOut().GetTicks();
-	} else if (decoder) {
-		return decoder->GetTicks();
-	}
-	return -1;
-}
-
 void GenericAudio::BgmChannel::SetFade(int fade) {
 	if (midi_out_used) {
 		instance->midi_thread->GetMidiOut().SetFade(0, std::chrono::milliseconds(fade));
-	} else if (decoder) {
-		decoder->SetFade(0, std::chrono::milliseconds(fade));
+	} else if (used) {
+		instance->PushCommand({ Command::Type::BgmFade, id, fade });
 	}
 }
 
 void GenericAudio::BgmChannel::SetVolume(int volume) {
 	if (midi_out_used) {
 		instance->midi_thread->GetMidiOut().SetVolume(volume);
-	} else if (decoder) {
-		decoder->SetVolume(volume);
+	} else if (used) {
+		instance->PushCommand({ Command::Type::BgmVolume, id, volume });
 	}
 }
 
 void GenericAudio::BgmChannel::SetPitch(int pitch) {
 	if (midi_out_used) {
 		instance->midi_thread->GetMidiOut().SetPitch(pitch);
-	} else if (decoder) {
-		decoder->SetPitch(pitch);
+	} else if (used) {
+		instance->PushCommand({ Command::Type::BgmPitch, id, pitch });
 	}
 }
 
 void GenericAudio::BgmChannel::SetBalance(int balance) {
 	if (midi_out_used) {
 		instance->midi_thread->GetMidiOut().SetBalance(balance);
-	} else if (decoder) {
-		decoder->SetBalance(balance);
+	} else if (used) {
+		instance->PushCommand({ Command::Type::BgmBalance, id, balance });
 	}
 }
 
 bool GenericAudio::BgmChannel::IsUsed() const {
-	return decoder || midi_out_used;
+	return used || midi_out_used;
 }
@@ -22,7 +22,10 @@
 #include "audio_secache.h"
 #include "audio_decoder_base.h"
 #include "audio_generic_midiout.h"
+#include "spsc_queue.h"
+#include <atomic>
 #include <memory>
+#include <string>
 
 /**
  * A software implementation for handling EasyRPG Audio utilizing the
@@ -36,6 +39,10 @@
  * 3. Initialize the "output_format" (must match the format of the hardware)
  * 4. Implement LockMutex and UnlockMutex. Locking and Unlocking when
  *    calling Decode must be done manually.
+ *    The game thread does not take this lock during normal operation:
+ *    Every change is queued as a command and applied at the start of
+ *    Decode. Only when the queue overflows the game thread locks and
+ *    applies the commands itself.
  * 5. Implement update function (optional)
  */
 class GenericAudio : public AudioInterface {
@@ -72,16 +79,42 @@ public:
 	void Decode(uint8_t* output_buffer, int buffer_length);
 
 private:
+	/** Change requested by the game thread, applied by the audio thread */
+	struct Command {
+		enum class Type {
+			BgmPlay,
+			BgmStop,
+			BgmPause,
+			BgmFade,
+			BgmVolume,
+			BgmPitch,
+			BgmBalance,
+			SePlay,
+			SeStop
+		};
+		Command() = default;
+		Command(Type type, int channel = 0, int value = 0, std::unique_ptr<AudioDecoderBase> decoder = {}) :
+			type(type), channel(channel), value(value), decoder(std::move(decoder)) {}
+
+		Type type = Type::BgmStop;
+		int channel = 0;
+		int value = 0;
+		std::unique_ptr<AudioDecoderBase> decoder;
+	};
 	struct BgmChannel {
 		int id;
-		std::unique_ptr<AudioDecoderBase> decoder;
 		GenericAudio* instance = nullptr;
-		bool paused;
-		bool stopped;
+		// State of the game thread
+		bool used = false;
+		bool paused = false;
+		bool stopped = true;
 		bool midi_out_used = false;
+		std::string type;
+		// State of the audio thread
+		std::unique_ptr<AudioDecoderBase> decoder;
+		bool decoder_paused = false;
 		void Stop();
 		void SetPaused(bool newPaused);
-		int GetTicks() const;
 		void SetFade(int fade);
 		void SetVolume(int volume);
 		void SetPitch(int pitch);
@@ -90,10 +123,10 @@ private:
 	};
 	struct SeChannel {
 		int id;
+		/** Set by the game thread on play, cleared by the audio thread when done */
+		std::atomic<bool> busy = { false };
+		/** Owned by the audio thread */
 		std::unique_ptr<AudioDecoderBase> decoder;
-		GenericAudio* instance = nullptr;
-		bool paused;
-		bool stopped;
 	};
 	struct Format {
 		int frequency;
@@ -105,16 +138,41 @@ private:
 	bool PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStream stream, int volume, int pitch, int fadein, int balance);
 	bool PlayOnChannel(SeChannel& chan, std::unique_ptr<AudioSeCache> se, int volume, int pitch, int balance);
 
+	/**
+	 * Queues a command for the audio thread.
+	 * Applies all pending commands under the lock when the queue is full.
+	 */
+	void PushCommand(Command&& command);
+
+	/** Applies the pending commands, called by the audio thread. */
+	void ProcessCommands();
+
+	/** Hands a decoder back to the game thread for destruction. */
+	void RetireDecoder(std::unique_ptr<AudioDecoderBase>& decoder);
+
 	static constexpr unsigned nr_of_se_channels = 31;
 	static constexpr unsigned nr_of_bgm_channels = 2;
 
 	BgmChannel BGM_Channels[nr_of_bgm_channels];
 	SeChannel SE_Channels[nr_of_se_channels];
-	mutable bool BGM_PlayedOnceIndicator;
+
+	SpscQueue<Command, 256> commands;
+	/** Decoders are freed by the game thread to keep the audio thread free of deallocations */
+	SpscQueue<std::unique_ptr<AudioDecoderBase>, 64> retired_decoders;
+
+	/** Incremented by the game thread on every BGM play and stop */
+	int bgm_serial = 0;
+	/** Serial of the last BGM play or stop applied by the audio thread */
+	std::atomic<int> bgm_applied_serial = { 0 };
+	std::atomic<bool> bgm_played_once = { false };
+	std::atomic<int> bgm_ticks = { 0 };
 
 	std::vector<int16_t> sample_buffer = {};
 	std::vector<uint8_t> scrap_buffer = {};
 	unsigned scrap_buffer_size = 0;
+	/** Samples of the current channel converted to float */
+	std::vector<float> float_buffer = {};
+	/** Interleaved stereo mix of all channels */
 	std::vector<float> mixer_buffer = {};
 
 	std::unique_ptr<GenericAudioMidiOut> midi_thread;
@@ -0,0 +1,264 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "audio_mix.h"
+#include "compiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef EP_HAVE_SSE2
+#  include <emmintrin.h>
+#endif
+
+#ifdef EP_HAVE_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace {
+
+// Samples above this level are compressed when the mix is too loud
+constexpr float compression_threshold = 0.8f;
+
+template <typename T>
+void ConvertScalar(float* dst, const void* src, int samples, float scale, float offset) {
+	// The samples can be unaligned in the decoder buffer
+	for (int i = 0; i < samples; ++i) {
+		T value;
+		std::memcpy(&value, static_cast<const uint8_t*>(src) + i * sizeof(T), sizeof(T));
+		dst[i] = value * scale - offset;
+	}
+}
+
+#if defined(EP_HAVE_SSE2)
+/** @return amount of processed samples, the remainder is left for the scalar code */
+int ConvertS16Vector(float* dst, const int16_t* src, int samples) {
+	const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+
+	int i = 0;
+	for (; i + 8 <= samples; i += 8) {
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+	return i;
+}
+
+int AccumulateStereoVector(float* mix, const float* src, int frames, float left, float right) {
+	const __m128 gain = _mm_setr_ps(left, right, left, right);
+
+	int i = 0;
+	for (; i + 2 <= frames; i += 2) {
+		__m128 m = _mm_loadu_ps(mix + i * 2);
+		__m128 s = _mm_loadu_ps(src + i * 2);
+		_mm_storeu_ps(mix + i * 2, _mm_add_ps(m, _mm_mul_ps(s, gain)));
+	}
+	return i;
+}
+
+int AccumulateMonoVector(float* mix, const float* src, int frames, float left, float right) {
+	const __m128 gain = _mm_setr_ps(left, right, left, right);
+
+	int i = 0;
+	for (; i + 4 <= frames; i += 4) {
+		__m128 s = _mm_loadu_ps(src + i);
+		__m128 m0 = _mm_loadu_ps(mix + i * 2);
+		__m128 m1 = _mm_loadu_ps(mix + i * 2 + 4);
+		_mm_storeu_ps(mix + i * 2, _mm_add_ps(m0, _mm_mul_ps(_mm_unpacklo_ps(s, s), gain)));
+		_mm_storeu_ps(mix + i * 2 + 4, _mm_add_ps(m1, _mm_mul_ps(_mm_unpackhi_ps(s, s), gain)));
+	}
+	return i;
+}
+
+int ToS16Vector(int16_t* dst, const float* mix, int samples, float k, float c) {
+	const __m128 sign_mask = _mm_set1_ps(-0.0f);
+	const __m128 vk = _mm_set1_ps(k);
+	const __m128 vc = _mm_set1_ps(c);
+	const __m128 scale = _mm_set1_ps(32768.0f);
+	const __m128 lo = _mm_set1_ps(-32768.0f);
+	const __m128 hi = _mm_set1_ps(32767.0f);
+
+	auto convert = [&](__m128 v) {
+		__m128 sign = _mm_and_ps(v, sign_mask);
+		__m128 a = _mm_andnot_ps(sign_mask, v);
+		a = _mm_min_ps(a, _mm_add_ps(_mm_mul_ps(a, vk), vc));
+		v = _mm_mul_ps(_mm_or_ps(a, sign), scale);
+		return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(v, lo), hi));
+	};
+
+	int i = 0;
+	for (; i + 8 <= samples; i += 8) {
+		__m128i s0 = convert(_mm_loadu_ps(mix + i));
+		__m128i s1 = convert(_mm_loadu_ps(mix + i + 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(s0, s1));
+	}
+	return i;
+}
+#elif defined(EP_HAVE_NEON)
+int ConvertS16Vector(float* dst, const int16_t* src, int samples) {
+	int i = 0;
+	for (; i + 8 <= samples; i += 8) {
+		int16x8_t s = vld1q_s16(src + i);
+		vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), 1.0f / 32768.0f));
+		vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), 1.0f / 32768.0f));
+	}
+	return i;
+}
+
+int AccumulateStereoVector(float* mix, const float* src, int frames, float left, float right) {
+	const float gains[4] = { left, right, left, right };
+	const float32x4_t gain = vld1q_f32(gains);
+
+	int i = 0;
+	for (; i + 2 <= frames; i += 2) {
+		vst1q_f32(mix + i * 2, vmlaq_f32(vld1q_f32(mix + i * 2), vld1q_f32(src + i * 2), gain));
+	}
+	return i;
+}
+
+int AccumulateMonoVector(float* mix, const float* src, int frames, float left, float right) {
+	const float gains[4] = { left, right, left, right };
+	const float32x4_t gain = vld1q_f32(gains);
+
+	int i = 0;
+	for (; i + 4 <= frames; i += 4) {
+		float32x4_t s = vld1q_f32(src + i);
+		float32x4x2_t z = vzipq_f32(s, s);
+		vst1q_f32(mix + i * 2, vmlaq_f32(vld1q_f32(mix + i * 2), z.val[0], gain));
+		vst1q_f32(mix + i * 2 + 4, vmlaq_f32(vld1q_f32(mix + i * 2 + 4), z.val[1], gain));
+	}
+	return i;
+}
+
+int ToS16Vector(int16_t* dst, const float* mix, int samples, float k, float c) {
+	const float32x4_t vk = vdupq_n_f32(k);
+	const float32x4_t vc = vdupq_n_f32(c);
+	const float32x4_t lo = vdupq_n_f32(-32768.0f);
+	const float32x4_t hi = vdupq_n_f32(32767.0f);
+	const uint32x4_t sign_mask = vdupq_n_u32(0x80000000u);
+
+	auto convert = [&](float32x4_t v) {
+		uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(v), sign_mask);
+		float32x4_t a = vabsq_f32(v);
+		a = vminq_f32(a, vmlaq_f32(vc, a, vk));
+		v = vmulq_n_f32(vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), sign)), 32768.0f);
+		return vcvtq_s32_f32(vminq_f32(vmaxq_f32(v, lo), hi));
+	};
+
+	int i = 0;
+	for (; i + 8 <= samples; i += 8) {
+		int32x4_t s0 = convert(vld1q_f32(mix + i));
+		int32x4_t s1 = convert(vld1q_f32(mix + i + 4));
+		vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(s0), vqmovn_s32(s1)));
+	}
+	return i;
+}
+#else
+int ConvertS16Vector(float*, const int16_t*, int) {
+	return 0;
+}
+
+int AccumulateStereoVector(float*, const float*, int, float, float) {
+	return 0;
+}
+
+int AccumulateMonoVector(float*, const float*, int, float, float) {
+	return 0;
+}
+
+int ToS16Vector(int16_t*, const float*, int, float, float) {
+	return 0;
+}
+#endif
+
+}
+
+void AudioMix::ToFloat(float* dst, const void* src, AudioDecoder::Format format, int samples) {
+	using Format = AudioDecoder::Format;
+
+	switch (format) {
+		case Format::S8:
+			ConvertScalar<int8_t>(dst, src, samples, 1.0f / 128.0f, 0.0f);
+			break;
+		case Format::U8:
+			ConvertScalar<uint8_t>(dst, src, samples, 1.0f / 128.0f, 1.0f);
+			break;
+		case Format::S16: {
+			int i = 0;
+			if (reinterpret_cast<uintptr_t>(src) % alignof(int16_t) == 0) {
+				i = ConvertS16Vector(dst, static_cast<const int16_t*>(src), samples);
+			}
+			ConvertScalar<int16_t>(dst + i, static_cast<const int16_t*>(src) + i, samples - i, 1.0f / 32768.0f, 0.0f);
+			break;
+		}
+		case Format::U16:
+			ConvertScalar<uint16_t>(dst, src, samples, 1.0f / 32768.0f, 1.0f);
+			break;
+		case Format::S32:
+			ConvertScalar<int32_t>(dst, src, samples, 1.0f / 2147483648.0f, 0.0f);
+			break;
+		case Format::U32:
+			ConvertScalar<uint32_t>(dst, src, samples, 1.0f / 2147483648.0f, 1.0f);
+			break;
+		case Format::F32:
+			std::memcpy(dst, src, samples * sizeof(float));
+			break;
+	}
+}
+
+void AudioMix::Accumulate(float* mix, const float* src, int frames, int channels, float left, float right) {
+	if (channels == 1) {
+		int i = AccumulateMonoVector(mix, src, frames, left, right);
+		for (; i < frames; ++i) {
+			mix[i * 2] += src[i] * left;
+			mix[i * 2 + 1] += src[i] * right;
+		}
+	} else if (channels == 2) {
+		int i = AccumulateStereoVector(mix, src, frames, left, right);
+		for (; i < frames; ++i) {
+			mix[i * 2] += src[i * 2] * left;
+			mix[i * 2 + 1] += src[i * 2 + 1] * right;
+		}
+	} else if (channels > 2) {
+		for (int i = 0; i < frames; ++i) {
+			mix[i * 2] += src[i * channels] * left;
+			mix[i * 2 + 1] += src[i * channels + 1] * right;
+		}
+	}
+}
+
+void AudioMix::ToS16(int16_t* dst, const float* mix, int samples, float total_volume) {
+	// Above the threshold the level is scaled linearly, so that the total
+	// volume maps to full scale: min(a, a * k + c) is the compressed level
+	float k = 1.0f;
+	float c = 0.0f;
+	if (total_volume > 1.0f) {
+		k = (1.0f - compression_threshold) / (total_volume - compression_threshold);
+		c = compression_threshold - compression_threshold * k;
+	}
+
+	int i = ToS16Vector(dst, mix, samples, k, c);
+	for (; i < samples; ++i) {
+		float a = std::abs(mix[i]);
+		a = std::min(a, a * k + c);
+		float v = std::copysign(a, mix[i]) * 32768.0f;
+		dst[i] = static_cast<int16_t>(std::min(std::max(v, -32768.0f), 32767.0f));
+	}
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_AUDIO_MIX_H
+#define EP_AUDIO_MIX_H
+
+// Headers
+#include <cstdint>
+#include "audio_decoder_base.h"
+
+/**
+ * Sample kernels used by GenericAudio to mix the channels.
+ *
+ * The mix is interleaved stereo float32. Every channel is converted to
+ * float32 once, accumulated with its gain and the whole mix is converted
+ * to the output format in a single pass at the end.
+ *
+ * Vectorized implementations (SSE2, NEON) are selected at compile time.
+ */
+namespace AudioMix {
+	/**
+	 * Converts samples to float32 in the range [-1, 1].
+	 *
+	 * @param dst output, must hold samples floats
+	 * @param src samples in the format
+	 * @param format format of the samples
+	 * @param samples number of samples (frames * channels)
+	 */
+	void ToFloat(float* dst, const void* src, AudioDecoder::Format format, int samples);
+
+	/**
+	 * Adds the samples of a channel multiplied with its gain to the mix.
+	 * Mono channels are panned to both sides, of channels with more than
+	 * two channels only the first two are mixed.
+	 *
+	 * @param mix stereo mix, must hold 2 * frames floats
+	 * @param src float32 samples, interleaved
+	 * @param frames number of frames
+	 * @param channels number of channels of src
+	 * @param left gain of the left side
+	 * @param right gain of the right side
+	 */
+	void Accumulate(float* mix, const float* src, int frames, int channels, float left, float right);
+
+	/**
+	 * Converts the mix to signed 16 bit samples and saturates them.
+	 * When the volumes of all mixed channels add up to more than 1 the
+	 * samples above a threshold are compressed into the remaining range.
+	 *
+	 * @param dst output, must hold samples values
+	 * @param mix mixed samples
+	 * @param samples number of samples
+	 * @param total_volume sum of the channel volumes
+	 */
+	void ToS16(int16_t* dst, const float* mix, int samples, float total_volume);
+}
+
+#endif
@@ -194,6 +194,7 @@ AudioResampler::AudioResampler(std::unique_ptr<AudioDecoderBase> wrapped, AudioR
 
 	#if defined(HAVE_LIBSPEEXDSP)
 		switch (quality) {
+			case Quality::Linear:
 			case Quality::Low:
 				sampling_quality = 0;
 				break;
@@ -206,6 +207,9 @@ AudioResampler::AudioResampler(std::unique_ptr<AudioDecoderBase> wrapped, AudioR
 		}
 	#elif defined(HAVE_LIBSAMPLERATE)
 		switch (quality) {
+			case Quality::Linear:
+				sampling_quality = SRC_LINEAR;
+				break;
 			case Quality::Low:
 				sampling_quality = SRC_SINC_FASTEST;
 				break;
@@ -216,19 +220,36 @@ AudioResampler::AudioResampler(std::unique_ptr<AudioDecoderBase> wrapped, AudioR
 				sampling_quality = SRC_SINC_BEST_QUALITY;
 				break;
 		}
+	#else
+		switch (quality) {
+			case Quality::Linear:
+				sampling_quality = static_cast<int>(AudioSincResampler::Quality::Linear);
+				break;
+			case Quality::Low:
+				sampling_quality = static_cast<int>(AudioSincResampler::Quality::Low);
+				break;
+			case Quality::Medium:
+				sampling_quality = static_cast<int>(AudioSincResampler::Quality::Medium);
+				break;
+			case Quality::High:
+				sampling_quality = static_cast<int>(AudioSincResampler::Quality::High);
+				break;
+		}
 	#endif
 
 	finished = false;
 }
 
 AudioResampler::~AudioResampler() {
-	if (conversion_state) {
 	#if defined(HAVE_LIBSPEEXDSP)
+		if (conversion_state) {
 			speex_resampler_destroy(conversion_state);
+		}
 	#elif defined(HAVE_LIBSAMPLERATE)
+		if (conversion_state) {
 			src_delete(conversion_state);
+		}
 	#endif
-	}
 }
 
 bool AudioResampler::WasInited() const {
@@ -261,6 +282,8 @@ bool AudioResampler::Open(Filesystem_Stream::InputStream stream) {
 			speex_resampler_skip_zeros(conversion_state);
 		#elif defined(HAVE_LIBSAMPLERATE)
 			conversion_state = src_new(sampling_quality, nr_of_channels, &lasterror);
+		#else
+			conversion_state = std::make_unique<AudioSincResampler>(nr_of_channels, static_cast<AudioSincResampler::Quality>(sampling_quality));
 		#endif
 
 		//Init the conversion data structure
@@ -306,6 +329,8 @@ bool AudioResampler::Seek(std::streamoff offset, std::ios_base::seekdir origin)
 			speex_resampler_reset_mem(conversion_state);
 		#elif defined(HAVE_LIBSAMPLERATE)
 			src_reset(conversion_state);
+		#else
+			conversion_state->Reset();
 		#endif
 		return true;
 	}
@@ -613,12 +638,23 @@ int AudioResampler::FillBufferDifferentRate(uint8_t* buffer, int length) {
 				error_message = src_strerror(error);
 				return ERROR;
 			}
+		#else
+			if (pitch_handled_by_decoder) {
+				conversion_state->SetRatio((input_rate * 1.0) / output_rate);
+			} else {
+				conversion_state->SetRatio((input_rate * pitch * 1.0) / (output_rate * STANDARD_PITCH));
+			}
+			conversion_data.input_frames_used = conversion_data.input_frames;
+			conversion_data.output_frames_gen = conversion_data.output_frames;
+
+			conversion_state->Process((float*)internal_buffer, conversion_data.input_frames_used, (float*)buffer, conversion_data.output_frames_gen);
+			(void)error;
 		#endif
 
 		total_output_frames -= conversion_data.output_frames_gen;
 		buffer += conversion_data.output_frames_gen*nr_of_channels*output_samplesize;
 
-		if ((conversion_data.input_frames == 0 && conversion_data.output_frames_gen <= conversion_data.output_frames) || conversion_data.output_frames_gen == 0) {
+		if ((conversion_data.input_frames == 0 && conversion_data.output_frames_gen < conversion_data.output_frames) || conversion_data.output_frames_gen == 0) {
 			finished = true;
 			//There is nothing left to convert - return how much samples (in bytes) are converted!
 			return length - total_output_frames*(output_samplesize*nr_of_channels);
@@ -30,10 +30,13 @@
 #include <speex/speex_resampler.h>
 #elif defined(HAVE_LIBSAMPLERATE)
 #include <samplerate.h>
+#else
+#include "audio_sinc_resampler.h"
 #endif
 
 /**
- * Audio resampler powered by Libspeexdsp or Libsamplerate
+ * Audio resampler powered by Libspeexdsp or Libsamplerate, falls back to
+ * the built-in AudioSincResampler when neither is available.
  * Wraps another decoder and provides resampling.
  */
 class AudioResampler : public AudioDecoderBase {
@@ -42,7 +45,9 @@ public:
 	enum class Quality {
 		High,
 		Medium,
-		Low
+		Low,
+		/** Linear interpolation, for short sounds where speed matters more than quality */
+		Linear
 	};
 
 	/**
@@ -196,7 +201,7 @@ public:
 	 * Requests a certain frame format from the resampler.
 	 * Supported formats are:
 	 *  * float,int16_t for libspeexdsp
-	 *  * float for libsamplerate
+	 *  * float for libsamplerate and the built-in resampler
 	 * The channel setting is redirected to the wrapped decoder.
 	 * The frequency setting controls the resampler.
 	 *
@@ -268,6 +273,12 @@ private:
 	#elif defined(HAVE_LIBSAMPLERATE)
 		SRC_DATA conversion_data;
 		SRC_STATE * conversion_state = nullptr;
+	#else
+		struct {
+			int input_frames, output_frames;
+			int input_frames_used, output_frames_gen;
+		} conversion_data;
+		std::unique_ptr<AudioSincResampler> conversion_state;
 	#endif
 
 	/**
@@ -18,53 +18,88 @@
 // Headers
 #include <cassert>
 #include <cstring>
-#include <map>
+#include <deque>
 #include <memory>
-#include <set>
+#include "async_decoder.h"
+#include "audio.h"
 #include "audio_resampler.h"
 #include "audio_secache.h"
-#include "game_clock.h"
 #include "filefinder.h"
+#include "lru_cache.h"
 #include "output.h"
 
-using namespace std::chrono_literals;
-
 namespace {
-	typedef std::map<std::string, AudioSeRef> cache_type;
+	using cache_type = LruCache<std::string, AudioSeRef>;
 
 	cache_type cache;
 
-	constexpr int cache_limit = 3 * 1024 * 1024;
-	int cache_size = 0;
+	/** Frequency the samples are resampled to before caching, 0 when unknown */
+	int output_frequency = 0;
+
+	/** Incremented on Clear, preloads started earlier are discarded */
+	int cache_generation = 0;
+
+	std::deque<std::string> preload_queue;
+	bool preload_running = false;
+
+	size_t GetCacheBudget() {
+		return static_cast<size_t>(Audio().SE_GetCacheSize()) * 1024 * 1024;
+	}
 
 	void FreeCacheMemory() {
-		auto cur_time = Game_Clock::GetFrameTime();
+		cache.SetBudget(GetCacheBudget());
 
-		for (auto it = cache.begin(); it != cache.end(); ) {
-			if (it->second.use_count() > 1) {
-				// SE is currently playing
-				++it;
-				continue;
-			}
+		auto can_evict = [](const AudioSeRef& se) {
+			// SE is currently playing when referenced elsewhere
+			return se.use_count() == 1;
+		};
 
-			if (cache_size <= cache_limit && cur_time - it->second->last_access < 3s) {
-				// Below memory limit and last access < 3s
-				++it;
-				continue;
-			}
+		// Only few SE play at once, rechecking the pinned ones is cheap
+		cache.Unpin(can_evict);
+		auto evicted = cache.Evict(can_evict);
+		(void)evicted;
 
 #ifdef CACHE_DEBUG
-			Output::Debug("SE: Freeing memory of {}", it->first);
+		Output::Debug("SE cache size: {} ({} freed)", cache.GetSize() / 1024.0 / 1024, evicted);
 #endif
+	}
 
-			cache_size -= it->second->buffer.size();
+	/**
+	 * Decodes the whole sample. Touches no global state, safe to call on a
+	 * worker thread.
+	 */
+	AudioSeRef DecodeSe(AudioDecoderBase& decoder, int frequency) {
+		auto se = std::make_shared<AudioSeData>();
+		decoder.GetFormat(se->frequency, se->format, se->channels);
+		se->buffer = decoder.DecodeAll();
 
-			it = cache.erase(it);
+#ifdef USE_AUDIO_RESAMPLER
+		if (frequency > 0 && frequency != se->frequency) {
+			// Resample once here instead of on every play, so a better quality is affordable
+			std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
+			dec = std::make_unique<AudioResampler>(std::move(dec), AudioResampler::Quality::Medium);
+			dec->Open(Filesystem_Stream::InputStream());
+			dec->SetFormat(frequency, AudioDecoder::Format::F32, se->channels);
+
+			auto resampled = std::make_shared<AudioSeData>();
+			dec->GetFormat(resampled->frequency, resampled->format, resampled->channels);
+			resampled->buffer = dec->DecodeAll();
+			se = std::move(resampled);
 		}
-
-#ifdef CACHE_DEBUG
-		Output::Debug("SE cache size: {}", cache_size / 1024.0 / 1024);
+#else
+		(void)frequency;
 #endif
+
+		se->buffer.shrink_to_fit();
+		return se;
+	}
+
+	std::unique_ptr<AudioDecoderBase> OpenDecoder(Filesystem_Stream::InputStream stream) {
+		auto decoder = AudioDecoder::Create(stream, false);
+		if (decoder && !decoder->Open(std::move(stream))) {
+			decoder.reset();
+		}
+		return decoder;
 	}
 }
 
@@ -72,20 +107,13 @@ std::unique_ptr<AudioSeCache> AudioSeCache::Create(Filesystem_Stream::InputStrea
 	auto se = std::make_unique<AudioSeCache>();
 	se->name = ToString(name);
 
-	auto const it = cache.find(ToString(name));
-	if (it == cache.end()) {
+	if (!cache.Contains(se->name)) {
 		// Not in cache
 		if (!stream) {
 			return {};
 		}
 
-		se->audio_decoder = AudioDecoder::Create(stream, false);
-
-		if (se->audio_decoder) {
-			if (!se->audio_decoder->Open(std::move(stream))) {
-				se->audio_decoder.reset();
-			}
-		}
+		se->audio_decoder = OpenDecoder(std::move(stream));
 
 		if (!se->audio_decoder) {
 			return {};
@@ -111,8 +139,7 @@ std::unique_ptr<AudioSeCache> AudioSeCache::GetCachedSe(std::string_view name) {
 	auto se = std::make_unique<AudioSeCache>();
 	se->name = ToString(name);
 
-	auto const it = cache.find(se->name);
-	if (it == cache.end()) {
+	if (!cache.Contains(se->name)) {
 		return {};
 	}
 
@@ -120,12 +147,12 @@ std::unique_ptr<AudioSeCache> AudioSeCache::GetCachedSe(std::string_view name) {
 }
 
 bool AudioSeCache::GetCachedFormat(int& frequency, AudioDecoder::Format& format, int& channels) const {
-	cache_type::const_iterator it = cache.find(name);
+	auto* se = cache.Find(name);
 
-	if (it != cache.end()) {
-		frequency = (*it).second->frequency;
-		format = (*it).second->format;
-		channels = (*it).second->channels;
+	if (se) {
+		frequency = (*se)->frequency;
+		format = (*se)->format;
+		channels = (*se)->channels;
 
 		return true;
 	}
@@ -133,63 +160,111 @@ bool AudioSeCache::GetCachedFormat(int& frequency, AudioDecoder::Format& format,
 	return false;
 }
 
-std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
+std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder(int pitch) {
 	AudioSeRef se;
 
-	auto it = cache.find(name);
-	if (it != cache.end()) {
-		se = it->second;
-		se->last_access = Game_Clock::GetFrameTime();
-
-		std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
-#ifdef USE_AUDIO_RESAMPLER
-		dec = std::make_unique<AudioResampler>(std::move(dec));
-#endif
-		Filesystem_Stream::InputStream is;
-		dec->Open(std::move(is));
-		return dec;
-	}
-
-	// Not cached yet: Decode the sample without any resampling
+	if (auto* cached = cache.Find(name)) {
+		se = *cached;
+	} else {
+		// Not cached yet: Decode the sample
+		assert(audio_decoder);
 
-	if (!se) {
-		se.reset(new AudioSeData());
-	}
+		se = DecodeSe(*audio_decoder, output_frequency);
 
-	assert(audio_decoder);
-
-	audio_decoder->GetFormat(se->frequency, se->format, se->channels);
-	se->buffer = audio_decoder->DecodeAll();
-
-	cache.insert(std::make_pair(name, se));
-
-	cache_size += se->buffer.size();
+		cache.Insert(name, se, se->buffer.size());
 
 #ifdef CACHE_DEBUG
-	Output::Debug("SE cache size (Add): {}", cache_size / 1024.0 / 1024.0);
+		Output::Debug("SE cache size (Add): {}", cache.GetSize() / 1024.0 / 1024.0);
 #endif
 
-	FreeCacheMemory();
+		FreeCacheMemory();
+	}
 
-	std::unique_ptr<AudioDecoderBase> dec = std::unique_ptr<AudioDecoderBase>(new AudioSeDecoder(se));
+	std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
 #ifdef USE_AUDIO_RESAMPLER
-	dec = std::unique_ptr<AudioDecoderBase>(new AudioResampler(std::move(dec)));
+	if (pitch != 100) {
+		// Pitched sound effects are short, linear interpolation is good enough
+		dec = std::make_unique<AudioResampler>(std::move(dec), AudioResampler::Quality::Linear);
+	} else if (output_frequency == 0 || se->frequency != output_frequency) {
+		dec = std::make_unique<AudioResampler>(std::move(dec));
+	}
 #endif
 	Filesystem_Stream::InputStream is;
 	dec->Open(std::move(is));
+	dec->SetPitch(pitch);
 	return dec;
 }
 
 AudioSeRef AudioSeCache::GetSeData() const {
-	auto it = cache.find(name);
-	assert(it != cache.end());
+	auto* se = cache.Find(name);
+	assert(se);
 
-	return it->second;
+	return *se;
 };
 
+void AudioSeCache::SetOutputFrequency(int frequency) {
+	if (frequency != output_frequency) {
+		output_frequency = frequency;
+		// Samples resampled to the old frequency would play too fast or slow
+		Clear();
+	}
+}
+
+void AudioSeCache::Preload(std::string_view name) {
+	if (!AsyncDecoder::IsSupported() || name.empty()) {
+		return;
+	}
+
+	preload_queue.emplace_back(name);
+}
+
+void AudioSeCache::Update() {
+	while (!preload_running && !preload_queue.empty()) {
+		std::string name = std::move(preload_queue.front());
+		preload_queue.pop_front();
+
+		if (cache.Contains(name) || cache.GetSize() >= GetCacheBudget()) {
+			continue;
+		}
+
+		// The filesystem is not thread-safe, only decoding happens on the worker
+		auto decoder = OpenDecoder(FileFinder::OpenSound(name));
+		if (!decoder) {
+			continue;
+		}
+
+		struct Job {
+			std::unique_ptr<AudioDecoderBase> decoder;
+			AudioSeRef se;
+		};
+		auto job = std::make_shared<Job>();
+		job->decoder = std::move(decoder);
+
+		auto work = [job, frequency = output_frequency]() {
+			job->se = DecodeSe(*job->decoder, frequency);
+			job->decoder.reset();
+		};
+
+		auto done = [job, name = std::move(name), generation = cache_generation]() {
+			preload_running = false;
+
+			// Preloading never evicts samples that were played
+			const size_t size = job->se->buffer.size();
+			if (generation == cache_generation && !cache.Contains(name) && cache.GetSize() + size <= GetCacheBudget()) {
+				cache.Insert(name, std::move(job->se), size);
+			}
+			job->se.reset();
+		};
+
+		preload_running = true;
+		AsyncDecoder::Submit(std::move(work), std::move(done));
+	}
+}
+
 void AudioSeCache::Clear() {
-	cache_size = 0;
-	cache.clear();
+	cache.Clear();
+	preload_queue.clear();
+	++cache_generation;
 }
 
 std::string_view AudioSeCache::GetName() const {
@@ -198,7 +273,6 @@ std::string_view AudioSeCache::GetName() const {
 
 AudioSeDecoder::AudioSeDecoder(const AudioSeRef& se) :
 	se(se) {
-	se->last_access = Game_Clock::GetFrameTime();
 }
 
 bool AudioSeDecoder::IsFinished() const {
@@ -23,10 +23,8 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <map>
 
 #include "audio_decoder.h"
-#include "game_clock.h"
 
 class AudioSeCache;
 
@@ -36,7 +34,6 @@ class AudioSeCache;
 class AudioSeData {
 public:
 	std::vector<uint8_t> buffer;
-	Game_Clock::time_point last_access;
 	int frequency;
 	AudioDecoder::Format format;
 	int channels;
@@ -70,8 +67,10 @@ private:
  * AudioSeCache provides an interface for accessing sound effects.
  * It also provides an automatic cache management, any SE is only decoded
  * once, otherwise returned from the cache.
- * The cache is flushed from recently (>10 seconds by default) unused
- * samples when it reaches the memory limit (5 MB by default).
+ * When the cache grows beyond the configured size (3 MB by default) the
+ * least recently used samples that are not playing are freed.
+ * When the output frequency is known the samples are cached already
+ * resampled to it, then playing them at normal pitch is a plain copy.
  * Uses an internal AudioDecoder for handling the decoding.
  */
 class AudioSeCache {
@@ -117,13 +116,17 @@ public:
 	bool GetCachedFormat(int& frequency, AudioDecoder::Format& format, int& channels) const;
 
 	/**
-	 * Decodes the whole sample without doing any resampling and caches it.
+	 * Decodes the whole sample and caches it, resampled to the output
+	 * frequency when one was set.
 	 * When cached the decoding step is skipped.
-	 * The returned AudioDecoder contains the SE sample.
+	 * The returned AudioDecoder contains the SE sample. When the sample is
+	 * already in the output frequency and the pitch is 100 it copies the
+	 * samples directly, otherwise it is wrapped in a resampler.
 	 *
+	 * @param pitch pitch of the sound effect
 	 * @return Decoded sound effect
 	 */
-	std::unique_ptr<AudioDecoderBase> CreateSeDecoder();
+	std::unique_ptr<AudioDecoderBase> CreateSeDecoder(int pitch);
 
 	/**
 	 * Returns the SE sample data handled by this SeCache.
@@ -137,6 +140,33 @@ public:
 	 */
 	std::string_view GetName() const;
 
+	/**
+	 * Sets the frequency samples are resampled to before they are cached.
+	 * Changing it clears the cache.
+	 *
+	 * @param frequency output frequency of the audio backend, 0 to cache
+	 *                  the samples in their original frequency
+	 */
+	static void SetOutputFrequency(int frequency);
+
+	/**
+	 * Queues a sound effect for decoding on a worker thread, then the first
+	 * play of it does not decode on the main thread.
+	 * Does nothing when worker threads are not supported. Samples that do
+	 * not fit into the cache anymore are not preloaded.
+	 *
+	 * @param name Cache entry name, the file is searched in the Sound folder
+	 */
+	static void Preload(std::string_view name);
+
+	/**
+	 * Starts decoding the next queued preload.
+	 * Only one is in flight at a time, this keeps waits for other assets
+	 * short. Called once per frame.
+	 */
+	static void Update();
+
+	/** Frees all cached samples and discards queued preloads */
 	static void Clear();
 private:
 	std::unique_ptr<AudioDecoderBase> audio_decoder;
@@ -0,0 +1,285 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "audio_sinc_resampler.h"
+#include "compiler.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#ifdef EP_HAVE_SSE2
+#  include <emmintrin.h>
+#endif
+
+#ifdef EP_HAVE_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace {
+
+struct Preset {
+	int taps;
+	int phases;
+	/** Kaiser window shape, higher values attenuate the stopband more */
+	double beta;
+	/** Cutoff relative to the nyquist frequency */
+	double rolloff;
+};
+
+constexpr Preset presets[] = {
+	{ 2, 1, 0.0, 1.0 },
+	{ 16, 32, 6.0, 0.90 },
+	{ 32, 64, 8.0, 0.94 },
+	{ 64, 128, 10.0, 0.96 }
+};
+
+// Input frames buffered per call in addition to the filter length
+constexpr int block_frames = 512;
+
+constexpr double pi = 3.14159265358979323846;
+
+/** Zeroth order modified Bessel function of the first kind */
+double BesselI0(double x) {
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 64; ++k) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1e-12) {
+			break;
+		}
+	}
+	return sum;
+}
+
+#if defined(EP_HAVE_SSE2)
+/** @return amount of processed taps, the remainder is left for the scalar code */
+int ConvolveVector(const float* x, const float* a, const float* b, int taps, float& sum_a, float& sum_b) {
+	__m128 acc_a = _mm_setzero_ps();
+	__m128 acc_b = _mm_setzero_ps();
+
+	int i = 0;
+	for (; i + 4 <= taps; i += 4) {
+		__m128 s = _mm_loadu_ps(x + i);
+		acc_a = _mm_add_ps(acc_a, _mm_mul_ps(s, _mm_loadu_ps(a + i)));
+		acc_b = _mm_add_ps(acc_b, _mm_mul_ps(s, _mm_loadu_ps(b + i)));
+	}
+
+	float lanes_a[4];
+	float lanes_b[4];
+	_mm_storeu_ps(lanes_a, acc_a);
+	_mm_storeu_ps(lanes_b, acc_b);
+	sum_a = (lanes_a[0] + lanes_a[1]) + (lanes_a[2] + lanes_a[3]);
+	sum_b = (lanes_b[0] + lanes_b[1]) + (lanes_b[2] + lanes_b[3]);
+	return i;
+}
+#elif defined(EP_HAVE_NEON)
+int ConvolveVector(const float* x, const float* a, const float* b, int taps, float& sum_a, float& sum_b) {
+	float32x4_t acc_a = vdupq_n_f32(0.0f);
+	float32x4_t acc_b = vdupq_n_f32(0.0f);
+
+	int i = 0;
+	for (; i + 4 <= taps; i += 4) {
+		float32x4_t s = vld1q_f32(x + i);
+		acc_a = vmlaq_f32(acc_a, s, vld1q_f32(a + i));
+		acc_b = vmlaq_f32(acc_b, s, vld1q_f32(b + i));
+	}
+
+	float32x2_t pair_a = vadd_f32(vget_low_f32(acc_a), vget_high_f32(acc_a));
+	float32x2_t pair_b = vadd_f32(vget_low_f32(acc_b), vget_high_f32(acc_b));
+	sum_a = vget_lane_f32(pair_a, 0) + vget_lane_f32(pair_a, 1);
+	sum_b = vget_lane_f32(pair_b, 0) + vget_lane_f32(pair_b, 1);
+	return i;
+}
+#endif
+
+/**
+ * Applies the filter interpolated between two phases.
+ *
+ * @param x input samples of one channel
+ * @param a coefficients of the phase before the position
+ * @param b coefficients of the phase after the position
+ * @param taps filter length
+ * @param weight position between the phases (0 - 1)
+ * @return filtered sample
+ */
+float Convolve(const float* x, const float* a, const float* b, int taps, float weight) {
+	float sum_a = 0.0f;
+	float sum_b = 0.0f;
+	int i = 0;
+
+#if defined(EP_HAVE_SSE2) || defined(EP_HAVE_NEON)
+	i = ConvolveVector(x, a, b, taps, sum_a, sum_b);
+#endif
+
+	for (; i < taps; ++i) {
+		sum_a += x[i] * a[i];
+		sum_b += x[i] * b[i];
+	}
+
+	return sum_a + (sum_b - sum_a) * weight;
+}
+
+} // namespace
+
+AudioSincResampler::AudioSincResampler(int channels, Quality quality) :
+	channels(channels)
+{
+	assert(channels > 0);
+
+	const Preset& preset = presets[static_cast<int>(quality)];
+	taps = preset.taps;
+	phases = preset.phases;
+	beta = preset.beta;
+	rolloff = preset.rolloff;
+
+	history.resize(channels);
+	for (auto& plane : history) {
+		plane.resize(taps + block_frames);
+	}
+
+	SetRatio(1.0);
+	Reset();
+}
+
+void AudioSincResampler::SetRatio(double new_ratio) {
+	assert(new_ratio > 0.0);
+	ratio = new_ratio;
+
+	if (taps == 2) {
+		// Linear interpolation has no filter
+		return;
+	}
+
+	// Remove the frequencies above the output nyquist frequency when downsampling
+	const double new_cutoff = rolloff / std::max(ratio, 1.0);
+	if (std::abs(new_cutoff - cutoff) > 1e-9) {
+		BuildFilter(new_cutoff);
+	}
+}
+
+double AudioSincResampler::GetRatio() const {
+	return ratio;
+}
+
+int AudioSincResampler::GetTaps() const {
+	return taps;
+}
+
+void AudioSincResampler::Reset() {
+	// Zeros before the first frame, then the filter is centered on it
+	history_frames = taps / 2 - 1;
+	for (auto& plane : history) {
+		std::fill(plane.begin(), plane.begin() + history_frames, 0.0f);
+	}
+	position = 0;
+	fraction = 0.0;
+}
+
+void AudioSincResampler::BuildFilter(double new_cutoff) {
+	cutoff = new_cutoff;
+	filter.resize((phases + 1) * taps);
+
+	const int half = taps / 2;
+	const double window_scale = 1.0 / BesselI0(beta);
+
+	for (int p = 0; p <= phases; ++p) {
+		const double offset = static_cast<double>(p) / phases;
+		float* row = filter.data() + p * taps;
+
+		double sum = 0.0;
+		for (int i = 0; i < taps; ++i) {
+			// Distance of the tap from the output position in input frames
+			const double x = i - half + 1 - offset;
+			const double r = x / half;
+			const double window = (r * r < 1.0) ? BesselI0(beta * std::sqrt(1.0 - r * r)) * window_scale : 0.0;
+			const double arg = pi * cutoff * x;
+			const double sinc = (std::abs(arg) < 1e-9) ? 1.0 : std::sin(arg) / arg;
+			const double value = cutoff * sinc * window;
+			row[i] = static_cast<float>(value);
+			sum += value;
+		}
+
+		// Unity gain for every phase, avoids ripple of constant signals
+		for (int i = 0; i < taps; ++i) {
+			row[i] = static_cast<float>(row[i] / sum);
+		}
+	}
+}
+
+void AudioSincResampler::Process(const float* in, int& in_frames, float* out, int& out_frames) {
+	const int capacity = static_cast<int>(history[0].size());
+	const int consumed = std::min(in_frames, capacity - history_frames);
+
+	// Deinterleave, the convolution reads consecutive samples of a channel
+	for (int c = 0; c < channels; ++c) {
+		float* plane = history[c].data() + history_frames;
+		for (int i = 0; i < consumed; ++i) {
+			plane[i] = in[i * channels + c];
+		}
+	}
+	history_frames += consumed;
+
+	int produced = 0;
+	if (taps == 2) {
+		while (produced < out_frames && position + 2 <= history_frames) {
+			const float weight = static_cast<float>(fraction);
+			for (int c = 0; c < channels; ++c) {
+				const float* x = history[c].data() + position;
+				out[produced * channels + c] = x[0] + (x[1] - x[0]) * weight;
+			}
+			++produced;
+
+			fraction += ratio;
+			const int step = static_cast<int>(fraction);
+			position += step;
+			fraction -= step;
+		}
+	} else {
+		while (produced < out_frames && position + taps <= history_frames) {
+			const double phase = fraction * phases;
+			const int row = std::min(static_cast<int>(phase), phases - 1);
+			const float weight = static_cast<float>(phase - row);
+			const float* a = filter.data() + row * taps;
+			const float* b = a + taps;
+
+			for (int c = 0; c < channels; ++c) {
+				out[produced * channels + c] = Convolve(history[c].data() + position, a, b, taps, weight);
+			}
+			++produced;
+
+			fraction += ratio;
+			const int step = static_cast<int>(fraction);
+			position += step;
+			fraction -= step;
+		}
+	}
+
+	// Drop the frames that are not needed for the next output anymore
+	const int drop = std::min(position, history_frames);
+	if (drop > 0) {
+		for (auto& plane : history) {
+			std::copy(plane.begin() + drop, plane.begin() + history_frames, plane.begin());
+		}
+		history_frames -= drop;
+		position -= drop;
+	}
+
+	in_frames = consumed;
+	out_frames = produced;
+}
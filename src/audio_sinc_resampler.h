@@ -0,0 +1,105 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_AUDIO_SINC_RESAMPLER_H
+#define EP_AUDIO_SINC_RESAMPLER_H
+
+// Headers
+#include <vector>
+
+/**
+ * Built-in sample rate converter for interleaved float32 samples.
+ * Used by AudioResampler when neither libspeexdsp nor libsamplerate is
+ * available.
+ *
+ * Filters with a Kaiser windowed sinc. The filter is precomputed for a
+ * fixed number of phases between two input samples, the coefficients of
+ * the phases in between are interpolated linearly. The convolution uses
+ * SSE2 or NEON when available. The linear quality skips the filter and
+ * only interpolates between two samples, this is cheap but aliases.
+ *
+ * The output is aligned to the input, the first output frame is the
+ * first input frame. The last frames of the input that are within half
+ * the filter length are never output.
+ */
+class AudioSincResampler {
+public:
+	/** Filter quality, higher quality uses a longer filter */
+	enum class Quality {
+		Linear,
+		Low,
+		Medium,
+		High
+	};
+
+	/**
+	 * @param channels number of interleaved channels
+	 * @param quality filter quality
+	 */
+	AudioSincResampler(int channels, Quality quality);
+
+	/**
+	 * Sets the conversion ratio. The filter is rebuilt when the cutoff
+	 * frequency changes, this happens when downsampling.
+	 *
+	 * @param ratio input rate divided by output rate, pitch included
+	 */
+	void SetRatio(double ratio);
+
+	/** @return input rate divided by output rate */
+	double GetRatio() const;
+
+	/**
+	 * Converts interleaved samples. Stops when the input is used up or the
+	 * output is full.
+	 *
+	 * @param in input samples
+	 * @param in_frames number of input frames, set to the number consumed
+	 * @param out output buffer
+	 * @param out_frames capacity of the output in frames, set to the number written
+	 */
+	void Process(const float* in, int& in_frames, float* out, int& out_frames);
+
+	/** Discards buffered input, e.g. after seeking */
+	void Reset();
+
+	/** @return number of taps of the filter */
+	int GetTaps() const;
+
+private:
+	void BuildFilter(double cutoff);
+
+	int channels;
+	int taps;
+	int phases;
+	double beta;
+	double rolloff;
+	double ratio = 1.0;
+	double cutoff = 0.0;
+
+	/** (phases + 1) rows of taps coefficients */
+	std::vector<float> filter;
+
+	/** Buffered input, one plane per channel */
+	std::vector<std::vector<float>> history;
+	int history_frames = 0;
+	/** Position of the next output frame in the history */
+	int position = 0;
+	double fraction = 0.0;
+};
+
+#endif
@@ -28,6 +28,7 @@
 #include "drawable_mgr.h"
 #include "game_screen.h"
 #include "player.h"
+#include "damage_region.h"
 
 Background::Background(const std::string& name) : Drawable(Priority_Background)
 {
@@ -115,6 +116,23 @@ int Background::Scale(int x) {
 	return x > 0 ? x / 64 : -(-x / 64);
 }
 
+std::optional<uint64_t> Background::GetDamageState(Rect& bounds) {
+	bounds = Rect(0, 0, Player::screen_width, Player::screen_height);
+
+	DamageHash hash;
+	hash.Add(bg_bitmap.get()).Add(bg_x).Add(bg_y)
+		.Add(fg_bitmap.get()).Add(fg_x).Add(fg_y)
+		.Add(tone_effect)
+		.Add(Main_Data::game_screen->GetShakeOffsetX()).Add(Main_Data::game_screen->GetShakeOffsetY());
+	if (bg_bitmap) {
+		hash.Add(bg_bitmap->GetRevision());
+	}
+	if (fg_bitmap) {
+		hash.Add(fg_bitmap->GetRevision());
+	}
+	return hash.Get();
+}
+
 void Background::Draw(Bitmap& dst) {
 	Rect dst_rect = dst.GetRect();
 
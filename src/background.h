@@ -31,6 +31,8 @@ public:
 	Background(int terrain_id);
 
 	void Draw(Bitmap& dst) override;
+
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
 	void Update();
 	Tone GetTone() const;
 	void SetTone(Tone tone);
@@ -111,6 +111,12 @@ Game_ConfigVideo BaseUi::GetConfig() const {
 	return cfg;
 }
 
+Rect BaseUi::ConsumeDisplayDamage() {
+	Rect rect = display_damage.value_or(main_surface->GetRect());
+	display_damage.reset();
+	return rect;
+}
+
 bool BaseUi::ChangeDisplaySurfaceResolution(int new_width, int new_height) {
 	if (new_width == current_display_mode.width && new_height == current_display_mode.height) {
 		return true;
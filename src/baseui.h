@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <string>
 #include <bitset>
+#include <optional>
 
 #include "system.h"
 #include "color.h"
@@ -210,6 +211,23 @@ public:
 	 */
 	void SetPauseWhenFocusLost(bool value);
 
+	/** @return true if only the changed parts of the screen are redrawn */
+	bool IsDamageTracking() const;
+
+	/**
+	 * Set whether only the changed parts of the screen are redrawn.
+	 * @param value
+	 */
+	void SetDamageTracking(bool value);
+
+	/**
+	 * Sets the area of the display surface that changed since the last
+	 * UpdateDisplay call. UIs can use this to upload less data.
+	 *
+	 * @param rect changed area
+	 */
+	void SetDisplayDamage(Rect rect);
+
 	/**
 	 * @return the minimum amount of time each physical frame should take.
 	 * If the UI manages time (i.e.) vsync, will return a 0 duration.
@@ -279,6 +297,14 @@ protected:
 	virtual void vGetConfig(Game_ConfigVideo& cfg) const = 0;
 	virtual bool vChangeDisplaySurfaceResolution(int new_width, int new_height);
 
+	/**
+	 * Returns the area passed to SetDisplayDamage and resets it to the
+	 * whole display surface.
+	 *
+	 * @return changed area of the display surface
+	 */
+	Rect ConsumeDisplayDamage();
+
 	Game_ConfigVideo vcfg;
 
 	/**
@@ -302,6 +328,9 @@ protected:
 	/** Surface used for zoom. */
 	BitmapRef main_surface;
 
+	/** Changed area of main_surface, see SetDisplayDamage */
+	std::optional<Rect> display_damage;
+
 	/** Mouse position on screen relative to the window. */
 	Point mouse_pos;
 
@@ -428,6 +457,18 @@ inline void BaseUi::SetPauseWhenFocusLost(bool value) {
 	vcfg.pause_when_focus_lost.Set(value);
 }
 
+inline bool BaseUi::IsDamageTracking() const {
+	return vcfg.damage_tracking.Get();
+}
+
+inline void BaseUi::SetDamageTracking(bool value) {
+	vcfg.damage_tracking.Set(value);
+}
+
+inline void BaseUi::SetDisplayDamage(Rect rect) {
+	display_damage = rect;
+}
+
 inline Game_Clock::duration BaseUi::GetFrameLimit() const {
 	return IsFrameRateSynchronized() ? Game_Clock::duration(0) : frame_limit;
 }
@@ -34,6 +34,9 @@ struct FileRequestResult;
 
 class BattleAnimation : public Sprite {
 public:
+	/** Animations are not damage tracked */
+	std::optional<uint64_t> GetDamageState(Rect&) override { return std::nullopt; }
+
 	/** Update the animation to the next animation **/
 	void Update();
 
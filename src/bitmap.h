@@ -610,6 +610,25 @@ public:
 	FontRef GetFont() const;
 	void SetFont(FontRef font);
 
+	/**
+	 * Returns a value that changes every time the bitmap is drawn to.
+	 * Revisions are unique across all bitmaps and never reused.
+	 * Writes through pixels() are not tracked.
+	 *
+	 * @return revision of the pixel data
+	 */
+	uint64_t GetRevision() const;
+
+	/**
+	 * Restricts all following drawing operations on this bitmap to a rectangle.
+	 *
+	 * @param clip_rect area that can be drawn to
+	 */
+	void SetClipRect(Rect const& clip_rect);
+
+	/** Removes the clip rectangle set by SetClipRect */
+	void ClearClipRect();
+
 	ImageOpacity ComputeImageOpacity() const;
 	ImageOpacity ComputeImageOpacity(Rect rect) const;
 
@@ -626,6 +645,15 @@ protected:
 	/** Bpp of the source image */
 	int original_bpp;
 
+	/** Revision of the pixel data, see GetRevision */
+	uint64_t revision = 0;
+
+	/** Active clip rectangle, only valid when has_clip_rect is set */
+	Rect clip_rect;
+	bool has_clip_rect = false;
+
+	void BumpRevision();
+
 	/** Bitmap data. */
 	PixmanImagePtr bitmap;
 	pixman_format_code_t pixman_format;
@@ -723,4 +751,8 @@ inline int Bitmap::GetOriginalBpp() const {
 	return original_bpp;
 }
 
+inline uint64_t Bitmap::GetRevision() const {
+	return revision;
+}
+
 #endif
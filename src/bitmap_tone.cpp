@@ -0,0 +1,551 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "bitmap_tone.h"
+#include "compiler.h"
+
+#ifdef EP_HAVE_SSE2
+#  include <emmintrin.h>
+#  if defined(__clang__) || defined(__GNUC__)
+#    define EP_TONE_AVX2
+#    define EP_TARGET_AVX2 __attribute__((target("avx2")))
+#    include <immintrin.h>
+#  elif defined(_MSC_VER)
+#    define EP_TONE_AVX2
+#    define EP_TARGET_AVX2
+#    include <intrin.h>
+#    include <immintrin.h>
+#  endif
+#endif
+
+#ifdef EP_HAVE_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace {
+
+// Hard light lookup table mapping source color to destination color
+struct HardLightTable {
+	uint8_t table[256][256] = {};
+};
+
+constexpr HardLightTable make_hard_light_lookup() {
+	HardLightTable hl;
+	for (int i = 0; i < 256; ++i) {
+		for (int j = 0; j < 256; ++j) {
+			int res = 0;
+			if (i <= 128)
+				res = (2 * i * j) / 255;
+			else
+				res = 255 - 2 * (255 - i) * (255 - j) / 255;
+			hl.table[i][j] = res > 255 ? 255 : res < 0 ? 0 : res;
+		}
+	}
+	return hl;
+}
+
+constexpr auto hard_light = make_hard_light_lookup();
+
+// Saturation Tone Inline: Changes a pixel saturation
+inline void saturation_tone(uint32_t &src_pixel, const int saturation, const int rs, const int gs, const int bs, const int as) {
+	// Algorithm from OpenPDN (MIT license)
+	// Transformation in Y'CbCr color space
+	uint8_t r = (src_pixel >> rs) & 0xFF;
+	uint8_t g = (src_pixel >> gs) & 0xFF;
+	uint8_t b = (src_pixel >> bs) & 0xFF;
+	uint8_t a = (src_pixel >> as) & 0xFF;
+
+	// Y' = 0.299 R' + 0.587 G' + 0.114 B'
+	uint8_t lum = (7471 * b + 38470 * g + 19595 * r) >> 16;
+
+	// Scale Cb/Cr by scale factor "sat"
+	int red = ((lum * 1024 + (r - lum) * saturation) >> 10);
+	red = red > 255 ? 255 : red < 0 ? 0 : red;
+	int green = ((lum * 1024 + (g - lum) * saturation) >> 10);
+	green = green > 255 ? 255 : green < 0 ? 0 : green;
+	int blue = ((lum * 1024 + (b - lum) * saturation) >> 10);
+	blue = blue > 255 ? 255 : blue < 0 ? 0 : blue;
+
+	src_pixel = ((uint32_t)red << rs) | ((uint32_t)green << gs) | ((uint32_t)blue << bs) | ((uint32_t)a << as);
+}
+
+// Color Tone Inline: Changes color of a pixel by hard light table
+inline void color_tone(uint32_t &src_pixel, const Tone& tone, const int rs, const int gs, const int bs, const int as) {
+	src_pixel = ((uint32_t)hard_light.table[tone.red][(src_pixel >> rs) & 0xFF] << rs)
+		| ((uint32_t)hard_light.table[tone.green][(src_pixel >> gs) & 0xFF] << gs)
+		| ((uint32_t)hard_light.table[tone.blue][(src_pixel >> bs) & 0xFF] << bs)
+		| ((uint32_t)((src_pixel >> as) & 0xFF) << as);
+}
+
+inline void color_tone_alpha(uint32_t &src_pixel, const Tone& tone, const int rs, const int gs, const int bs, const int as) {
+	uint8_t a = (src_pixel >> as) & 0xFF;
+	uint8_t r = ((uint32_t)hard_light.table[tone.red][(src_pixel >> rs) & 0xFF]) * a / 255;
+	uint8_t g = ((uint32_t)hard_light.table[tone.green][(src_pixel >> gs) & 0xFF]) * a / 255;
+	uint8_t b = ((uint32_t)hard_light.table[tone.blue][(src_pixel >> bs) & 0xFF]) * a / 255;
+	src_pixel = ((uint32_t)r << rs) | ((uint32_t)g << gs) | ((uint32_t)b << bs) | ((uint32_t)a << as);
+}
+
+void ApplyScalar(uint32_t* pixels, int count, const BitmapTone::Params& p) {
+	for (int i = 0; i < count; ++i) {
+		if (p.skip_transparent && ((pixels[i] >> p.as) & 0xFF) == 0) {
+			continue;
+		}
+
+		if (p.apply_sat) {
+			saturation_tone(pixels[i], p.sat, p.rs, p.gs, p.bs, p.as);
+		}
+
+		if (p.apply_tone) {
+			if (p.premultiply) {
+				color_tone_alpha(pixels[i], p.tone, p.rs, p.gs, p.bs, p.as);
+			} else {
+				color_tone(pixels[i], p.tone, p.rs, p.gs, p.bs, p.as);
+			}
+		}
+	}
+}
+
+/*
+ * The vector kernels work on 16 bit lanes. The hard light table is computed
+ * instead of looked up:
+ *   i <= 128: 2 * i * j / 255
+ *   i > 128:  255 - 2 * (255 - i) * (255 - j) / 255
+ * Both are floor(k * m / 255) with an optional inversion (x ^ 0xFF == 255 - x)
+ * of input and output. floor(x / 255) == (x * 0x8081) >> 23 for all 16 bit x.
+ */
+
+/** Per lane constants for 16 bit lanes, ordered by the byte position of the channel */
+struct LaneConstants {
+	int16_t lum_coef1[16];
+	int16_t lum_coef2[16];
+	int16_t sat_coef[16];
+	int16_t tone_k[16];
+	int16_t tone_inv[16];
+	int16_t alpha_lane[16];
+	uint32_t alpha_mask;
+};
+
+LaneConstants MakeLaneConstants(const BitmapTone::Params& p) {
+	LaneConstants c = {};
+
+	const int pr = p.rs / 8;
+	const int pg = p.gs / 8;
+	const int pb = p.bs / 8;
+	const int pa = p.as / 8;
+
+	auto tone_k = [](int i) { return static_cast<int16_t>(i <= 128 ? 2 * i : 2 * (255 - i)); };
+	auto tone_inv = [](int i) { return static_cast<int16_t>(i <= 128 ? 0 : 0xFF); };
+
+	for (int i = 0; i < 16; i += 4) {
+		// 38470 does not fit into a signed 16 bit lane, it is split across two multiply-adds
+		c.lum_coef1[i + pr] = 19595;
+		c.lum_coef1[i + pg] = 19235;
+		c.lum_coef1[i + pb] = 7471;
+		c.lum_coef2[i + pg] = 38470 - 19235;
+
+		c.tone_k[i + pr] = tone_k(p.tone.red);
+		c.tone_k[i + pg] = tone_k(p.tone.green);
+		c.tone_k[i + pb] = tone_k(p.tone.blue);
+		c.tone_inv[i + pr] = tone_inv(p.tone.red);
+		c.tone_inv[i + pg] = tone_inv(p.tone.green);
+		c.tone_inv[i + pb] = tone_inv(p.tone.blue);
+
+		c.alpha_lane[i + pa] = -1;
+	}
+
+	for (int i = 0; i < 16; i += 2) {
+		c.sat_coef[i] = 1024;
+		c.sat_coef[i + 1] = static_cast<int16_t>(p.sat);
+	}
+
+	c.alpha_mask = 0xFFu << p.as;
+
+	return c;
+}
+
+#ifdef EP_HAVE_SSE2
+void ApplySse2(uint32_t* pixels, int count, const BitmapTone::Params& p) {
+	const auto c = MakeLaneConstants(p);
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c255 = _mm_set1_epi16(255);
+	const __m128i c8081 = _mm_set1_epi16(static_cast<int16_t>(0x8081));
+	const __m128i ones = _mm_set1_epi16(1);
+	const __m128i lum_coef1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.lum_coef1));
+	const __m128i lum_coef2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.lum_coef2));
+	const __m128i sat_coef = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.sat_coef));
+	const __m128i tone_k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.tone_k));
+	const __m128i tone_inv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.tone_inv));
+	const __m128i alpha_lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.alpha_lane));
+	const __m128i alpha_mask = _mm_set1_epi32(static_cast<int32_t>(c.alpha_mask));
+
+	// Adds the two 32 bit sums of each pixel and broadcasts the result >> shift to all 4 lanes
+	auto broadcast = [](__m128i sum, int shift) {
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		sum = _mm_srl_epi32(sum, _mm_cvtsi32_si128(shift));
+		return _mm_or_si128(sum, _mm_slli_epi32(sum, 16));
+	};
+
+	auto div255 = [&](__m128i x) {
+		return _mm_srli_epi16(_mm_mulhi_epu16(x, c8081), 7);
+	};
+
+	auto process = [&](__m128i x) {
+		__m128i alpha = zero;
+		if (p.premultiply) {
+			alpha = broadcast(_mm_madd_epi16(_mm_and_si128(x, alpha_lane), ones), 0);
+		}
+
+		if (p.apply_sat) {
+			__m128i lum = broadcast(_mm_add_epi32(_mm_madd_epi16(x, lum_coef1), _mm_madd_epi16(x, lum_coef2)), 16);
+			__m128i diff = _mm_sub_epi16(x, lum);
+			__m128i lo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(lum, diff), sat_coef), 10);
+			__m128i hi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(lum, diff), sat_coef), 10);
+			x = _mm_packs_epi32(lo, hi);
+			x = _mm_max_epi16(_mm_min_epi16(x, c255), zero);
+		}
+
+		if (p.apply_tone) {
+			x = _mm_xor_si128(x, tone_inv);
+			x = div255(_mm_mullo_epi16(x, tone_k));
+			x = _mm_xor_si128(x, tone_inv);
+			x = _mm_min_epi16(x, c255);
+
+			if (p.premultiply) {
+				x = div255(_mm_mullo_epi16(x, alpha));
+			}
+		}
+
+		return x;
+	};
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i* ptr = reinterpret_cast<__m128i*>(pixels + i);
+		const __m128i v = _mm_loadu_si128(ptr);
+
+		__m128i keep = alpha_mask;
+		if (p.skip_transparent) {
+			__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(v, alpha_mask), zero);
+			if (_mm_movemask_epi8(transparent) == 0xFFFF) {
+				continue;
+			}
+			keep = _mm_or_si128(keep, transparent);
+		}
+
+		__m128i lo = process(_mm_unpacklo_epi8(v, zero));
+		__m128i hi = process(_mm_unpackhi_epi8(v, zero));
+		__m128i res = _mm_packus_epi16(lo, hi);
+
+		res = _mm_or_si128(_mm_andnot_si128(keep, res), _mm_and_si128(keep, v));
+		_mm_storeu_si128(ptr, res);
+	}
+
+	ApplyScalar(pixels + i, count - i, p);
+}
+#endif
+
+#ifdef EP_TONE_AVX2
+// Same algorithm as ApplySse2. Lambdas do not inherit the target attribute,
+// therefore everything is written out in the function body.
+EP_TARGET_AVX2
+void ApplyAvx2(uint32_t* pixels, int count, const BitmapTone::Params& p) {
+	const auto c = MakeLaneConstants(p);
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i c255 = _mm256_set1_epi16(255);
+	const __m256i c8081 = _mm256_set1_epi16(static_cast<int16_t>(0x8081));
+	const __m256i ones = _mm256_set1_epi16(1);
+	const __m256i lum_coef1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.lum_coef1));
+	const __m256i lum_coef2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.lum_coef2));
+	const __m256i sat_coef = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.sat_coef));
+	const __m256i tone_k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.tone_k));
+	const __m256i tone_inv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.tone_inv));
+	const __m256i alpha_lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.alpha_lane));
+	const __m256i alpha_mask = _mm256_set1_epi32(static_cast<int32_t>(c.alpha_mask));
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i* ptr = reinterpret_cast<__m256i*>(pixels + i);
+		const __m256i v = _mm256_loadu_si256(ptr);
+
+		__m256i keep = alpha_mask;
+		if (p.skip_transparent) {
+			__m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(v, alpha_mask), zero);
+			if (_mm256_movemask_epi8(transparent) == -1) {
+				continue;
+			}
+			keep = _mm256_or_si256(keep, transparent);
+		}
+
+		__m256i halves[2] = { _mm256_unpacklo_epi8(v, zero), _mm256_unpackhi_epi8(v, zero) };
+
+		for (auto& x: halves) {
+			__m256i alpha = zero;
+			if (p.premultiply) {
+				alpha = _mm256_madd_epi16(_mm256_and_si256(x, alpha_lane), ones);
+				alpha = _mm256_add_epi32(alpha, _mm256_shuffle_epi32(alpha, _MM_SHUFFLE(2, 3, 0, 1)));
+				alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 16));
+			}
+
+			if (p.apply_sat) {
+				__m256i lum = _mm256_add_epi32(_mm256_madd_epi16(x, lum_coef1), _mm256_madd_epi16(x, lum_coef2));
+				lum = _mm256_add_epi32(lum, _mm256_shuffle_epi32(lum, _MM_SHUFFLE(2, 3, 0, 1)));
+				lum = _mm256_srli_epi32(lum, 16);
+				lum = _mm256_or_si256(lum, _mm256_slli_epi32(lum, 16));
+
+				__m256i diff = _mm256_sub_epi16(x, lum);
+				__m256i lo = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(lum, diff), sat_coef), 10);
+				__m256i hi = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(lum, diff), sat_coef), 10);
+				x = _mm256_packs_epi32(lo, hi);
+				x = _mm256_max_epi16(_mm256_min_epi16(x, c255), zero);
+			}
+
+			if (p.apply_tone) {
+				x = _mm256_xor_si256(x, tone_inv);
+				x = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_mullo_epi16(x, tone_k), c8081), 7);
+				x = _mm256_xor_si256(x, tone_inv);
+				x = _mm256_min_epi16(x, c255);
+
+				if (p.premultiply) {
+					x = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_mullo_epi16(x, alpha), c8081), 7);
+				}
+			}
+		}
+
+		__m256i res = _mm256_packus_epi16(halves[0], halves[1]);
+
+		res = _mm256_or_si256(_mm256_andnot_si256(keep, res), _mm256_and_si256(keep, v));
+		_mm256_storeu_si256(ptr, res);
+	}
+
+	ApplyScalar(pixels + i, count - i, p);
+}
+
+bool CpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	// OSXSAVE and AVX, the OS must save the YMM registers
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) {
+		return false;
+	}
+	if ((_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef EP_HAVE_NEON
+inline uint16x8_t NeonDiv255(uint16x8_t x) {
+	uint32x4_t lo = vshrq_n_u32(vmull_n_u16(vget_low_u16(x), 0x8081), 23);
+	uint32x4_t hi = vshrq_n_u32(vmull_n_u16(vget_high_u16(x), 0x8081), 23);
+	return vcombine_u16(vmovn_u32(lo), vmovn_u32(hi));
+}
+
+inline uint16x8_t NeonSaturation(uint16x8_t c, int16x8_t lum, int16_t sat) {
+	int16x8_t diff = vsubq_s16(vreinterpretq_s16_u16(c), lum);
+	int32x4_t lo = vmull_n_s16(vget_low_s16(lum), 1024);
+	lo = vmlal_n_s16(lo, vget_low_s16(diff), sat);
+	int32x4_t hi = vmull_n_s16(vget_high_s16(lum), 1024);
+	hi = vmlal_n_s16(hi, vget_high_s16(diff), sat);
+	int16x8_t res = vcombine_s16(vqmovn_s32(vshrq_n_s32(lo, 10)), vqmovn_s32(vshrq_n_s32(hi, 10)));
+	res = vmaxq_s16(vminq_s16(res, vdupq_n_s16(255)), vdupq_n_s16(0));
+	return vreinterpretq_u16_s16(res);
+}
+
+inline uint16x8_t NeonHardLight(uint16x8_t c, int tone) {
+	const uint16x8_t inv = vdupq_n_u16(tone <= 128 ? 0 : 0xFF);
+	const uint16_t k = static_cast<uint16_t>(tone <= 128 ? 2 * tone : 2 * (255 - tone));
+	uint16x8_t res = NeonDiv255(vmulq_n_u16(veorq_u16(c, inv), k));
+	return vminq_u16(veorq_u16(res, inv), vdupq_n_u16(255));
+}
+
+void ApplyNeon(uint32_t* pixels, int count, const BitmapTone::Params& p) {
+	const int pr = p.rs / 8;
+	const int pg = p.gs / 8;
+	const int pb = p.bs / 8;
+	const int pa = p.as / 8;
+	const auto sat = static_cast<int16_t>(p.sat);
+
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8_t* ptr = reinterpret_cast<uint8_t*>(pixels + i);
+		const uint8x16x4_t v = vld4q_u8(ptr);
+
+		uint8x16_t channels[3] = { v.val[pr], v.val[pg], v.val[pb] };
+		const uint8x16_t a8 = v.val[pa];
+
+		uint8x8_t out[3][2];
+		for (int h = 0; h < 2; ++h) {
+			uint16x8_t c[3];
+			for (int ch = 0; ch < 3; ++ch) {
+				c[ch] = vmovl_u8(h == 0 ? vget_low_u8(channels[ch]) : vget_high_u8(channels[ch]));
+			}
+			const uint16x8_t a = vmovl_u8(h == 0 ? vget_low_u8(a8) : vget_high_u8(a8));
+
+			if (p.apply_sat) {
+				const uint16x4_t r_lo = vget_low_u16(c[0]), r_hi = vget_high_u16(c[0]);
+				const uint16x4_t g_lo = vget_low_u16(c[1]), g_hi = vget_high_u16(c[1]);
+				const uint16x4_t b_lo = vget_low_u16(c[2]), b_hi = vget_high_u16(c[2]);
+
+				uint32x4_t lum_lo = vmull_n_u16(b_lo, 7471);
+				lum_lo = vmlal_n_u16(lum_lo, g_lo, 38470);
+				lum_lo = vmlal_n_u16(lum_lo, r_lo, 19595);
+				uint32x4_t lum_hi = vmull_n_u16(b_hi, 7471);
+				lum_hi = vmlal_n_u16(lum_hi, g_hi, 38470);
+				lum_hi = vmlal_n_u16(lum_hi, r_hi, 19595);
+				const int16x8_t lum = vreinterpretq_s16_u16(vcombine_u16(vshrn_n_u32(lum_lo, 16), vshrn_n_u32(lum_hi, 16)));
+
+				for (auto& ch: c) {
+					ch = NeonSaturation(ch, lum, sat);
+				}
+			}
+
+			if (p.apply_tone) {
+				c[0] = NeonHardLight(c[0], p.tone.red);
+				c[1] = NeonHardLight(c[1], p.tone.green);
+				c[2] = NeonHardLight(c[2], p.tone.blue);
+
+				if (p.premultiply) {
+					for (auto& ch: c) {
+						ch = NeonDiv255(vmulq_u16(ch, a));
+					}
+				}
+			}
+
+			for (int ch = 0; ch < 3; ++ch) {
+				out[ch][h] = vmovn_u16(c[ch]);
+			}
+		}
+
+		uint8x16x4_t res = v;
+		res.val[pr] = vcombine_u8(out[0][0], out[0][1]);
+		res.val[pg] = vcombine_u8(out[1][0], out[1][1]);
+		res.val[pb] = vcombine_u8(out[2][0], out[2][1]);
+
+		if (p.skip_transparent) {
+			const uint8x16_t transparent = vceqq_u8(a8, vdupq_n_u8(0));
+			res.val[pr] = vbslq_u8(transparent, v.val[pr], res.val[pr]);
+			res.val[pg] = vbslq_u8(transparent, v.val[pg], res.val[pg]);
+			res.val[pb] = vbslq_u8(transparent, v.val[pb], res.val[pb]);
+		}
+
+		vst4q_u8(ptr, res);
+	}
+
+	ApplyScalar(pixels + i, count - i, p);
+}
+#endif
+
+using KernelFn = void (*)(uint32_t*, int, const BitmapTone::Params&);
+
+KernelFn GetKernel(BitmapTone::Isa isa) {
+	switch (isa) {
+		case BitmapTone::Isa::Scalar:
+			return ApplyScalar;
+#ifdef EP_HAVE_SSE2
+		case BitmapTone::Isa::SSE2:
+			return ApplySse2;
+#endif
+#ifdef EP_TONE_AVX2
+		case BitmapTone::Isa::AVX2:
+			return CpuHasAvx2() ? ApplyAvx2 : nullptr;
+#endif
+#ifdef EP_HAVE_NEON
+		case BitmapTone::Isa::NEON:
+			return ApplyNeon;
+#endif
+		default:
+			return nullptr;
+	}
+}
+
+BitmapTone::Isa DetectIsa() {
+	for (auto isa: { BitmapTone::Isa::AVX2, BitmapTone::Isa::NEON, BitmapTone::Isa::SSE2 }) {
+		if (GetKernel(isa)) {
+			return isa;
+		}
+	}
+	return BitmapTone::Isa::Scalar;
+}
+
+bool IsVectorizable(const BitmapTone::Params& p) {
+	// The vector kernels address channels by byte position
+	const int shifts[] = { p.rs, p.gs, p.bs, p.as };
+	int used = 0;
+	for (int s: shifts) {
+		if (s < 0 || s > 24 || s % 8 != 0) {
+			return false;
+		}
+		used |= 1 << (s / 8);
+	}
+	return used == 0xF;
+}
+
+} // anonymous namespace
+
+BitmapTone::Params BitmapTone::MakeParams(const Tone& tone, int rs, int gs, int bs, int as) {
+	Params p;
+	p.rs = rs;
+	p.gs = gs;
+	p.bs = bs;
+	p.as = as;
+	p.tone = tone;
+	p.apply_sat = tone.gray != 128;
+	p.apply_tone = (tone.red != 128 || tone.green != 128 || tone.blue != 128);
+	p.sat = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
+	return p;
+}
+
+void BitmapTone::Apply(uint32_t* pixels, int count, const Params& params) {
+	static const Isa isa = DetectIsa();
+
+	Apply(pixels, count, params, isa);
+}
+
+void BitmapTone::Apply(uint32_t* pixels, int count, const Params& params, Isa isa) {
+	if (count <= 0 || (!params.apply_sat && !params.apply_tone)) {
+		return;
+	}
+
+	KernelFn fn = IsVectorizable(params) ? GetKernel(isa) : nullptr;
+	if (!fn) {
+		fn = ApplyScalar;
+	}
+
+	fn(pixels, count, params);
+}
+
+bool BitmapTone::IsSupported(Isa isa) {
+	return GetKernel(isa) != nullptr;
+}
+
+BitmapTone::Isa BitmapTone::GetIsa() {
+	return DetectIsa();
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_BITMAP_TONE_H
+#define EP_BITMAP_TONE_H
+
+// Headers
+#include <cstdint>
+#include "tone.h"
+
+/**
+ * Pixel kernels used by Bitmap::ToneBlit.
+ *
+ * Vectorized implementations (SSE2, AVX2, NEON) are selected at runtime.
+ * All of them produce exactly the same output as the scalar implementation.
+ */
+namespace BitmapTone {
+	/** Instruction set used by a kernel */
+	enum class Isa {
+		Scalar,
+		SSE2,
+		AVX2,
+		NEON
+	};
+
+	struct Params {
+		/** Channel shifts of the 32 bit pixel format, must be multiples of 8 */
+		int rs = 0;
+		int gs = 8;
+		int bs = 16;
+		int as = 24;
+		/** Saturation factor, 1024 keeps the saturation */
+		int sat = 1024;
+		/** Apply the gray (saturation) component of the tone */
+		bool apply_sat = false;
+		/** Apply the color components of the tone */
+		bool apply_tone = false;
+		/** Leave pixels with an alpha of 0 untouched */
+		bool skip_transparent = false;
+		/** Multiply the toned color channels with the alpha */
+		bool premultiply = false;
+		Tone tone;
+	};
+
+	/**
+	 * Creates kernel parameters for a tone.
+	 *
+	 * @param tone tone to apply
+	 * @param rs red shift
+	 * @param gs green shift
+	 * @param bs blue shift
+	 * @param as alpha shift
+	 * @return parameters, the opacity related flags are not set
+	 */
+	Params MakeParams(const Tone& tone, int rs, int gs, int bs, int as);
+
+	/**
+	 * Applies the tone to a row of pixels in place using the fastest
+	 * supported instruction set.
+	 *
+	 * @param pixels pixels to modify
+	 * @param count number of pixels
+	 * @param params kernel parameters
+	 */
+	void Apply(uint32_t* pixels, int count, const Params& params);
+
+	/**
+	 * Applies the tone to a row of pixels in place using a specific
+	 * instruction set. Used for testing.
+	 *
+	 * @param pixels pixels to modify
+	 * @param count number of pixels
+	 * @param params kernel parameters
+	 * @param isa instruction set, must be supported
+	 */
+	void Apply(uint32_t* pixels, int count, const Params& params, Isa isa);
+
+	/**
+	 * @param isa instruction set
+	 * @return whether the kernel was compiled in and the CPU supports it
+	 */
+	bool IsSupported(Isa isa);
+
+	/** @return instruction set used by Apply */
+	Isa GetIsa();
+}
+
+#endif
@@ -20,12 +20,12 @@
 #  pragma warning(disable: 4003)
 #endif
 
-#include <map>
-#include <tuple>
 #include <chrono>
 #include <cassert>
 
+#include "async_decoder.h"
 #include "async_handler.h"
+#include "lru_cache.h"
 #include "cache.h"
 #include "filefinder.h"
 #include "exfont.h"
@@ -35,35 +35,70 @@
 #include "player.h"
 #include <lcf/data.h>
 #include "game_clock.h"
+#include "instrumentation.h"
 #include "translation.h"
 
 using namespace std::chrono_literals;
 
 namespace {
+	// Tile and effect keys start with a control character to avoid clashes
+	constexpr char tile_key_prefix = '\x02';
+	constexpr char effect_key_prefix = '\x03';
+
 	std::string MakeHashKey(std::string_view folder_name, std::string_view filename, bool transparent, uint32_t extra_flags = 0) {
 		return fmt::format("{}:{}:{}:{}", folder_name, filename, transparent, extra_flags);
 	}
 
+	template <typename T>
+	void AppendKeyBytes(std::string& key, const T& value) {
+		key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
 	std::string MakeTileHashKey(std::string_view chipset_name, int id) {
 		std::string key;
-		key.reserve(chipset_name.size() + sizeof(int) + 2);
-		key.append(reinterpret_cast<char*>(&id), sizeof(id));
+		key.reserve(chipset_name.size() + sizeof(int) + 3);
+		key.append(1, tile_key_prefix);
+		AppendKeyBytes(key, id);
 		key.append(1, ':');
 		key.append(chipset_name.begin(), chipset_name.end());
 
 		return key;
 	}
 
+	std::string MakeEffectHashKey(std::string_view id, bool transparent, const Rect& rect, bool flip_x, bool flip_y, const Tone& tone, const Color& blend) {
+		std::string key;
+		key.reserve(id.size() + 48);
+		key.append(1, effect_key_prefix);
+		AppendKeyBytes(key, transparent);
+		AppendKeyBytes(key, flip_x);
+		AppendKeyBytes(key, flip_y);
+		AppendKeyBytes(key, rect.x);
+		AppendKeyBytes(key, rect.y);
+		AppendKeyBytes(key, rect.width);
+		AppendKeyBytes(key, rect.height);
+		AppendKeyBytes(key, tone.red);
+		AppendKeyBytes(key, tone.green);
+		AppendKeyBytes(key, tone.blue);
+		AppendKeyBytes(key, tone.gray);
+		AppendKeyBytes(key, blend.red);
+		AppendKeyBytes(key, blend.green);
+		AppendKeyBytes(key, blend.blue);
+		AppendKeyBytes(key, blend.alpha);
+		key.append(id.begin(), id.end());
+
+		return key;
+	}
+
 	int IdFromTileHash(std::string_view key) {
 		int id = 0;
-		if (key.size() > sizeof(id)) {
-			std::memcpy(&id, key.data(), sizeof(id));
+		if (key.size() > sizeof(id) + 1) {
+			std::memcpy(&id, key.data() + 1, sizeof(id));
 		}
 		return id;
 	}
 
 	const char* NameFromTileHash(std::string_view key) {
-		int offset = sizeof(int) + 1;
+		int offset = sizeof(int) + 2;
 		if (static_cast<int>(key.size()) < offset) {
 			return "";
 		}
@@ -75,69 +110,74 @@ namespace {
 		Game_Clock::time_point last_access;
 	};
 
+	// Images, tiles and sprite effects share one byte budget
 	using key_type = std::string;
-	std::unordered_map<key_type, CacheItem> cache;
+	LruCache<key_type, CacheItem> cache;
 
-	using tile_key_type = std::string;
-	std::unordered_map<tile_key_type, std::weak_ptr<Bitmap>> cache_tiles;
+	// Frame in which the pinned cache entries were last rechecked
+	Game_Clock::time_point last_unpin;
 
-	// rect, flip_x, flip_y, tone, blend
-	using effect_key_type = std::tuple<std::string, bool, Rect, bool, bool, Tone, Color>;
-	std::map<effect_key_type, std::weak_ptr<Bitmap>> cache_effects;
+	// Incremented by Cache::Clear, background decodes of older generations are discarded
+	int cache_generation = 0;
 
 	std::string system_name;
 
 	std::string system2_name;
 
-	constexpr int cache_limit = 10 * 1024 * 1024;
-	size_t cache_size = 0;
+	size_t GetCacheBudget() {
+		return static_cast<size_t>(Player::player_config.image_cache_size.Get()) * 1024 * 1024;
+	}
 
 	void FreeBitmapMemory() {
+		cache.SetBudget(GetCacheBudget());
+		if (cache.GetSize() <= cache.GetBudget()) {
+			return;
+		}
+
 		auto cur_ticks = Game_Clock::GetFrameTime();
 
-		for (auto it = cache.begin(); it != cache.end();) {
-			if (it->second.bitmap.use_count() != 1) {
+		auto can_evict = [&](const CacheItem& item) {
+			if (item.bitmap.use_count() != 1) {
 				// Bitmap is referenced
-				++it;
-				continue;
-			}
-
-			auto last_access = cur_ticks - it->second.last_access;
-			bool cache_exhausted = cache_size > cache_limit;
-			if (cache_exhausted) {
-				if (last_access <= 50ms) {
-					// Used during the last 3 frames, must be important, keep it.
-					++it;
-					continue;
-				}
-			} else if (last_access <= 3s) {
-				++it;
-				continue;
+				return false;
 			}
 
-#ifdef CACHE_DEBUG
-			Output::Debug("Freeing memory of {}/{}", std::get<0>(i.first), std::get<1>(i.first));
-#endif
-
-			cache_size -= it->second.bitmap->GetSize();
+			// Used during the last 3 frames, must be important, keep it.
+			return cur_ticks - item.last_access > 50ms;
+		};
 
-			it = cache.erase(it);
+		// Entries kept by earlier evictions are rechecked once per frame
+		if (cur_ticks != last_unpin) {
+			last_unpin = cur_ticks;
+			cache.Unpin(can_evict);
 		}
 
+		auto evicted = cache.Evict(can_evict);
+		(void)evicted;
+
 #ifdef CACHE_DEBUG
-		Output::Debug("Bitmap cache size: {}", cache_size / 1024.0 / 1024);
+		Output::Debug("Bitmap cache size: {} ({} evicted)", cache.GetSize() / 1024.0 / 1024, evicted);
 #endif
 	}
 
 	BitmapRef AddToCache(const std::string& key, BitmapRef bmp) {
-		if (bmp) {
-			cache_size += bmp->GetSize();
+		auto& item = cache.Insert(key, {bmp, Game_Clock::GetFrameTime()}, bmp ? bmp->GetSize() : 0);
 #ifdef CACHE_DEBUG
-			Output::Debug("Bitmap cache size (Add): {}", cache_size / 1024.0 / 1024.0);
+		Output::Debug("Bitmap cache size (Add): {}", cache.GetSize() / 1024.0 / 1024.0);
 #endif
-		}
+		// Keep a reference, otherwise the new bitmap could be evicted right away
+		bmp = item.bitmap;
+		FreeBitmapMemory();
+		return bmp;
+	}
 
-		return (cache[key] = {bmp, Game_Clock::GetFrameTime()}).bitmap;
+	BitmapRef FindInCache(const std::string& key) {
+		auto* item = cache.Find(key);
+		if (!item) {
+			return nullptr;
+		}
+		item->last_access = Game_Clock::GetFrameTime();
+		return item->bitmap;
 	}
 
 	struct Material {
@@ -235,6 +275,19 @@ namespace {
 		return s.dummy_renderer();
 	}
 
+	uint32_t GetBitmapFlags(Material::Type type, uint32_t extra_flags) {
+		uint32_t flags = Bitmap::Flag_ReadOnly | (
+				type == Material::Chipset ? Bitmap::Flag_Chipset :
+				type == Material::System ? Bitmap::Flag_System : 0);
+		return flags | extra_flags;
+	}
+
+	bool IsBitDepthSupported(const Bitmap& bmp) {
+		// FIXME: This HasActiveTranslation check will also load 32 bit images in the game directory when
+		// a translation is active and our API does not expose whether the asset was redirected or not.
+		return bmp.GetOriginalBpp() <= 8 || Player::HasEasyRpgExtensions() || Player::IsPatchManiac() || Tr::HasActiveTranslation();
+	}
+
 	template<Material::Type T>
 	BitmapRef LoadBitmap(std::string_view filename, bool transparent, uint32_t extra_flags = 0) {
 		static_assert(Material::REND < T && T < Material::END, "Invalid material.");
@@ -248,17 +301,16 @@ namespace {
 		BitmapRef bmp;
 
 		const auto key = MakeHashKey(s.directory, filename, transparent, extra_flags);
-		auto it = cache.find(key);
-		if (it == cache.end()) {
+		bmp = FindInCache(key);
+		if (!bmp) {
 			if (filename == CACHE_DEFAULT_BITMAP) {
 				bmp = LoadDummyBitmap<T>(s.directory, filename, true);
 			}
 
 			if (!bmp) {
+				Instrumentation::ZoneScope zone(Instrumentation::Zone::CacheLoad);
 				auto is = FileFinder::OpenImage(s.directory, filename);
 
-				FreeBitmapMemory();
-
 				if (!is) {
 					if (s.warn_missing) {
 						Output::Warning("Image not found: {}/{}", s.directory, filename);
@@ -267,23 +319,12 @@ namespace {
 						bmp = CreateEmpty<T>();
 					}
 				} else {
-					auto flags = Bitmap::Flag_ReadOnly | (
-							T == Material::Chipset ? Bitmap::Flag_Chipset :
-							T == Material::System ? Bitmap::Flag_System : 0);
-					flags |= extra_flags;
-
-					bmp = Bitmap::Create(std::move(is), transparent, flags);
+					bmp = Bitmap::Create(std::move(is), transparent, GetBitmapFlags(T, extra_flags));
 					if (!bmp) {
 						Output::Warning("Invalid image: {}/{}", s.directory, filename);
-					} else {
-						if (bmp->GetOriginalBpp() > 8) {
-							// FIXME: This HasActiveTranslation check will also load 32 bit images in the game directory when
-							// a translation is active and our API does not expose whether the asset was redirected or not.
-							if (!Player::HasEasyRpgExtensions() && !Player::IsPatchManiac() && !Tr::HasActiveTranslation()) {
-								Output::Warning("Image {}/{} has a bit depth of {} that is not supported by RPG_RT. Enable EasyRPG Extensions or Maniac Patch to load such images.", s.directory, filename, bmp->GetOriginalBpp());
-								bmp.reset();
-							}
-						}
+					} else if (!IsBitDepthSupported(*bmp)) {
+						Output::Warning("Image {}/{} has a bit depth of {} that is not supported by RPG_RT. Enable EasyRPG Extensions or Maniac Patch to load such images.", s.directory, filename, bmp->GetOriginalBpp());
+						bmp.reset();
 					}
 				}
 			}
@@ -294,9 +335,6 @@ namespace {
 			}
 
 			bmp = AddToCache(key, bmp);
-		} else {
-			it->second.last_access = Game_Clock::GetFrameTime();
-			bmp = it->second.bitmap;
 		}
 
 		assert(bmp);
@@ -341,6 +379,46 @@ namespace {
 		const Spec& s = spec[T];
 		return LoadBitmap<T>(f, s.transparent, extra_flags);
 	}
+
+	bool DecodeBitmapAsync(Material::Type type, std::string_view filename, std::function<void()> on_ready) {
+		const Spec& s = spec[type];
+
+		// Uses the default transparency, other variants are decoded on demand by LoadBitmap
+		auto key = MakeHashKey(s.directory, filename, s.transparent);
+		if (cache.Contains(key)) {
+			return false;
+		}
+
+		// The filesystem is not thread-safe, only decoding happens on the worker
+		auto is = FileFinder::OpenImage(s.directory, filename);
+		if (!is) {
+			return false;
+		}
+
+		struct Job {
+			Filesystem_Stream::InputStream stream;
+			BitmapRef bmp;
+		};
+		auto job = std::make_shared<Job>();
+		job->stream = std::move(is);
+
+		auto work = [job, transparent = s.transparent, flags = GetBitmapFlags(type, 0)]() {
+			Instrumentation::ZoneScope zone(Instrumentation::Zone::CacheLoad);
+			job->bmp = Bitmap::Create(std::move(job->stream), transparent, flags);
+		};
+
+		auto done = [job, key = std::move(key), generation = cache_generation, on_ready = std::move(on_ready)]() {
+			// Invalid images are not published, LoadBitmap reports the error
+			if (job->bmp && generation == cache_generation && !cache.Contains(key) && IsBitDepthSupported(*job->bmp)) {
+				AddToCache(key, job->bmp);
+			}
+			job->bmp.reset();
+			on_ready();
+		};
+
+		AsyncDecoder::Submit(std::move(work), std::move(done));
+		return true;
+	}
 }
 
 std::vector<uint8_t> Cache::exfont_custom;
@@ -417,9 +495,9 @@ BitmapRef Cache::System(std::string_view file, bool bg_preserve_transparent_colo
 BitmapRef Cache::Exfont() {
 	const auto key = MakeHashKey("ExFont", "ExFont", false);
 
-	auto it = cache.find(key);
+	auto bmp = FindInCache(key);
 
-	if (it == cache.end()) {
+	if (!bmp) {
 		// Allow overwriting of built-in exfont with a custom ExFont image file
 		// exfont_custom is filled by Player::CreateGameObjects
 		BitmapRef exfont_img;
@@ -432,17 +510,15 @@ BitmapRef Cache::Exfont() {
 		}
 
 		return AddToCache(key, exfont_img);
-	} else {
-		it->second.last_access = Game_Clock::GetFrameTime();
-		return it->second.bitmap;
 	}
+	return bmp;
 }
 
 BitmapRef Cache::Tile(std::string_view filename, int tile_id) {
 	const auto key = MakeTileHashKey(filename, tile_id);
-	auto it = cache_tiles.find(key);
+	auto bmp = FindInCache(key);
 
-	if (it == cache_tiles.end() || it->second.expired()) {
+	if (!bmp) {
 		BitmapRef chipset = Cache::Chipset(filename);
 		Rect rect = Rect(0, 0, 16, 16);
 
@@ -467,38 +543,31 @@ BitmapRef Cache::Tile(std::string_view filename, int tile_id) {
 		rect.x += sub_tile_id % 6 * 16;
 		rect.y += sub_tile_id / 6 * 16;
 
-		auto bmp = Bitmap::Create(*chipset, rect);
+		bmp = Bitmap::Create(*chipset, rect);
 		bmp->SetId(fmt::format("{}/{}", chipset->GetId(), tile_id));
-		cache_tiles[key] = bmp;
-
-		return bmp;
-	} else { return it->second.lock(); }
+		return AddToCache(key, bmp);
+	}
+	return bmp;
 }
 
 BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, bool flip_x, bool flip_y, const Tone& tone, const Color& blend) {
-	std::string id = ToString(src_bitmap->GetId());
-
-	if (id.empty()) {
-		// Log causes false positives when empty bitmaps or placeholder (checkerboard)
-		// bitmaps are used.
-		//Output::Debug("Bitmap has no ID. Please report a bug!");
-		id = fmt::format("{}", (void*)(src_bitmap.get()));
+	const std::string_view id = src_bitmap->GetId();
+
+	// Bitmaps without an ID have no stable key: Their address is reused after
+	// they are freed, so their effects are not cached.
+	// Log causes false positives when empty bitmaps or placeholder (checkerboard)
+	// bitmaps are used.
+	//Output::Debug("Bitmap has no ID. Please report a bug!");
+	const bool cacheable = !id.empty();
+
+	std::string key;
+	BitmapRef bitmap_effects;
+	if (cacheable) {
+		key = MakeEffectHashKey(id, src_bitmap->GetTransparent(), rect, flip_x, flip_y, tone, blend);
+		bitmap_effects = FindInCache(key);
 	}
 
-	const effect_key_type key {
-		id,
-		src_bitmap->GetTransparent(),
-		rect,
-		flip_x,
-		flip_y,
-		tone,
-		blend
-	};
-
-	const auto it = cache_effects.find(key);
-
-	if (it == cache_effects.end() || it->second.expired()) {
-		BitmapRef bitmap_effects;
+	if (!bitmap_effects) {
 
 		auto create = [&rect] () -> BitmapRef {
 			return Bitmap::Create(rect.width, rect.height, true);
@@ -531,25 +600,50 @@ BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, boo
 
 		assert(bitmap_effects && "Effect cache used but no effect applied!");
 
-		return(cache_effects[key] = bitmap_effects).lock();
-	} else { return it->second.lock(); }
+		if (cacheable) {
+			return AddToCache(key, bitmap_effects);
+		}
+	}
+	return bitmap_effects;
 }
 
 void Cache::Clear() {
-	cache_effects.clear();
-	cache.clear();
-	cache_size = 0;
-
-	for (auto& kv : cache_tiles) {
-		auto& key = kv.first;
-		if (kv.second.expired()) {
+	for (auto& entry : cache) {
+		auto& key = entry.key;
+		if (key.empty() || key.front() != tile_key_prefix || entry.value.bitmap.use_count() == 1) {
 			continue;
 		}
 		Output::Debug("possible leak in cached tilemap {}/{}",
 				NameFromTileHash(key), IdFromTileHash(key));
 	}
 
-	cache_tiles.clear();
+	cache.Clear();
+	++cache_generation;
+}
+
+bool Cache::DecodeAsync(std::string_view folder_name, std::string_view filename, std::function<void()> on_ready) {
+	if (!AsyncDecoder::IsSupported() || filename.empty() || filename == CACHE_DEFAULT_BITMAP) {
+		return false;
+	}
+
+	for (int i = 0; i < Material::END; ++i) {
+		// The System flags depend on the game settings
+		if (i != Material::System && folder_name == spec[i].directory) {
+			return DecodeBitmapAsync(static_cast<Material::Type>(i), filename, std::move(on_ready));
+		}
+	}
+	return false;
+}
+
+Cache::Stats Cache::GetStats() {
+	Stats stats;
+	stats.size = cache.GetSize();
+	stats.budget = GetCacheBudget();
+	stats.count = cache.GetCount();
+	stats.hits = cache.GetStats().hits;
+	stats.misses = cache.GetStats().misses;
+	stats.evictions = cache.GetStats().evictions;
+	return stats;
 }
 
 void Cache::ClearAll() {
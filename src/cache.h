@@ -20,6 +20,7 @@
 
 // Headers
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -61,6 +62,34 @@ namespace Cache {
 	void Clear();
 	void ClearAll();
 
+	/**
+	 * Decodes an image on a worker thread and adds it to the cache.
+	 * The image is decoded with the default transparency of the folder.
+	 * System graphics are not supported.
+	 *
+	 * @param folder_name folder of the image, e.g. "Picture"
+	 * @param filename name of the image
+	 * @param on_ready invoked on the main thread after the image was added
+	 * @return true when decoding started, on_ready is only invoked in that case
+	 */
+	bool DecodeAsync(std::string_view folder_name, std::string_view filename, std::function<void()> on_ready);
+
+	/** Memory usage and access statistics of the cache */
+	struct Stats {
+		/** Size of all cached bitmaps in bytes */
+		size_t size = 0;
+		/** Configured budget in bytes, unused bitmaps are evicted above it */
+		size_t budget = 0;
+		/** Amount of cached bitmaps */
+		size_t count = 0;
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+	};
+
+	/** @return current cache statistics */
+	Stats GetStats();
+
 	/** @return the configured system bitmap, or nullptr if there is no system */
 	BitmapRef System(bool bg_preserve_transparent_color = false);
 
@@ -41,4 +41,13 @@
 
 #endif
 
+/** SIMD instruction sets the compiler targets, intrinsics headers are included where used */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define EP_HAVE_SSE2
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define EP_HAVE_NEON
+#endif
+
 #endif
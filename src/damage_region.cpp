@@ -0,0 +1,115 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "damage_region.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+	int64_t Area(const Rect& rect) {
+		return static_cast<int64_t>(rect.width) * rect.height;
+	}
+
+	bool Touches(const Rect& l, const Rect& r) {
+		// Adjacent rectangles are merged as well, otherwise tile aligned
+		// damage degenerates into many thin stripes
+		return l.x <= r.x + r.width && r.x <= l.x + l.width &&
+			l.y <= r.y + r.height && r.y <= l.y + l.height;
+	}
+}
+
+Rect DamageRegion::Union(const Rect& l, const Rect& r) {
+	if (l.IsEmpty()) {
+		return r;
+	}
+	if (r.IsEmpty()) {
+		return l;
+	}
+
+	const int x1 = std::min(l.x, r.x);
+	const int y1 = std::min(l.y, r.y);
+	const int x2 = std::max(l.x + l.width, r.x + r.width);
+	const int y2 = std::max(l.y + l.height, r.y + r.height);
+
+	return Rect(x1, y1, x2 - x1, y2 - y1);
+}
+
+void DamageRegion::Add(Rect rect) {
+	if (rect.IsEmpty()) {
+		return;
+	}
+
+	// Absorb every rectangle the new one touches. The union can touch
+	// further rectangles, so repeat until nothing changes.
+	bool merged = true;
+	while (merged) {
+		merged = false;
+		for (auto it = rects.begin(); it != rects.end(); ++it) {
+			if (Touches(*it, rect)) {
+				rect = Union(*it, rect);
+				rects.erase(it);
+				merged = true;
+				break;
+			}
+		}
+	}
+
+	if (rects.size() < max_rects) {
+		rects.push_back(rect);
+		return;
+	}
+
+	// Region is full: Merge with the rectangle that grows the least
+	size_t best = 0;
+	int64_t best_growth = std::numeric_limits<int64_t>::max();
+	for (size_t i = 0; i < rects.size(); ++i) {
+		const int64_t growth = Area(Union(rects[i], rect)) - Area(rects[i]) - Area(rect);
+		if (growth < best_growth) {
+			best_growth = growth;
+			best = i;
+		}
+	}
+
+	rect = Union(rects[best], rect);
+	rects.erase(rects.begin() + best);
+	Add(rect);
+}
+
+void DamageRegion::Add(const DamageRegion& other) {
+	for (auto& rect: other.rects) {
+		Add(rect);
+	}
+}
+
+void DamageRegion::Clip(const Rect& bounds) {
+	for (auto& rect: rects) {
+		rect.Adjust(bounds);
+	}
+
+	rects.erase(std::remove_if(rects.begin(), rects.end(), [](const Rect& rect) {
+		return rect.IsEmpty();
+	}), rects.end());
+}
+
+Rect DamageRegion::GetBounds() const {
+	Rect bounds;
+	for (auto& rect: rects) {
+		bounds = Union(bounds, rect);
+	}
+	return bounds;
+}
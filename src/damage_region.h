@@ -0,0 +1,136 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_DAMAGE_REGION_H
+#define EP_DAMAGE_REGION_H
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "color.h"
+#include "rect.h"
+#include "tone.h"
+
+/**
+ * A set of screen rectangles which must be redrawn.
+ * The amount of rectangles is bounded: Overlapping rectangles are merged and
+ * when the limit is reached the two rectangles whose union grows the least
+ * are combined.
+ */
+class DamageRegion {
+public:
+	/** Maximum amount of disjoint rectangles kept */
+	static constexpr size_t max_rects = 8;
+
+	/**
+	 * Adds a rectangle to the region. Empty rectangles are ignored.
+	 *
+	 * @param rect area to add
+	 */
+	void Add(Rect rect);
+
+	/**
+	 * Adds all rectangles of another region.
+	 *
+	 * @param other region to add
+	 */
+	void Add(const DamageRegion& other);
+
+	/**
+	 * Trims all rectangles to the given bounds.
+	 *
+	 * @param bounds rectangle to clip against
+	 */
+	void Clip(const Rect& bounds);
+
+	/** Removes all rectangles */
+	void Clear();
+
+	/** @return true when nothing is damaged */
+	bool IsEmpty() const;
+
+	/** @return smallest rectangle containing the whole region */
+	Rect GetBounds() const;
+
+	/** @return the rectangles of the region */
+	const std::vector<Rect>& GetRects() const;
+
+	/** @return whether two rectangles overlap */
+	static bool Intersects(const Rect& l, const Rect& r);
+
+	/** @return smallest rectangle containing both rectangles */
+	static Rect Union(const Rect& l, const Rect& r);
+
+private:
+	std::vector<Rect> rects;
+};
+
+/**
+ * Incremental FNV-1a hash used by drawables to fingerprint their render state.
+ */
+class DamageHash {
+public:
+	template <typename T>
+	std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value, DamageHash&>
+	Add(T value) {
+		unsigned char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		for (auto b: bytes) {
+			hash = (hash ^ b) * 1099511628211ULL;
+		}
+		return *this;
+	}
+
+	DamageHash& Add(const Rect& rect) {
+		return Add(rect.x).Add(rect.y).Add(rect.width).Add(rect.height);
+	}
+
+	DamageHash& Add(const Tone& tone) {
+		return Add(tone.red).Add(tone.green).Add(tone.blue).Add(tone.gray);
+	}
+
+	DamageHash& Add(const Color& color) {
+		return Add(color.red).Add(color.green).Add(color.blue).Add(color.alpha);
+	}
+
+	/** @return the hash value */
+	uint64_t Get() const {
+		return hash;
+	}
+
+private:
+	uint64_t hash = 14695981039346656037ULL;
+};
+
+inline bool DamageRegion::IsEmpty() const {
+	return rects.empty();
+}
+
+inline void DamageRegion::Clear() {
+	rects.clear();
+}
+
+inline const std::vector<Rect>& DamageRegion::GetRects() const {
+	return rects;
+}
+
+inline bool DamageRegion::Intersects(const Rect& l, const Rect& r) {
+	return !l.IsEmpty() && !r.IsEmpty() && !l.IsOutOfBounds(r);
+}
+
+#endif
@@ -20,6 +20,8 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include "rect.h"
 
 class Bitmap;
 class Drawable;
@@ -57,6 +59,18 @@ public:
 
 	virtual void Draw(Bitmap& dst) = 0;
 
+	/**
+	 * Reports the render state to the damage tracking renderer.
+	 * Called once per frame before Draw() when damage tracking is enabled.
+	 * Drawables which apply their state lazily in Draw() must apply it here too.
+	 *
+	 * @param bounds receives the screen area written by Draw()
+	 * @return hash of everything that influences the drawn pixels or std::nullopt
+	 * when damage tracking is not supported. Visible drawables without damage
+	 * tracking force a redraw of the whole screen.
+	 */
+	virtual std::optional<uint64_t> GetDamageState(Rect& bounds);
+
 	Z_t GetZ() const;
 
 	void SetZ(Z_t z);
@@ -118,6 +132,13 @@ private:
 	Flags _flags = Flags::Default;
 	int render_ox = 0;
 	int render_oy = 0;
+
+	/** Damage tracking state of the last frame, maintained by DrawableList */
+	Rect _damage_bounds;
+	uint64_t _damage_state = 0;
+	bool _damage_valid = false;
+
+	friend class DrawableList;
 };
 
 inline Drawable::Flags operator|(Drawable::Flags l, Drawable::Flags r) {
@@ -142,6 +163,10 @@ inline Drawable::Drawable(Z_t z, Flags flags)
 {
 }
 
+inline std::optional<uint64_t> Drawable::GetDamageState(Rect& /* bounds */) {
+	return std::nullopt;
+}
+
 inline Drawable::Z_t Drawable::GetZ() const {
 	return _z;
 }
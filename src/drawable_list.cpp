@@ -69,6 +69,12 @@ Drawable* DrawableList::Take(Drawable* ptr) {
 	auto ret = *iter;
 	// FIXME: Can we remove this O(N) operation here?
 	_list.erase(iter);
+
+	if (ret->_damage_valid) {
+		_removed_damage.Add(ret->_damage_bounds);
+		ret->_damage_valid = false;
+	}
+
 	return ret;
 
 	// Removing doesn't change sorted order, so not dirty flag.
@@ -111,3 +117,68 @@ void DrawableList::Draw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z) {
 	}
 }
 
+
+void DrawableList::Draw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z, const Rect& clip) {
+	if (IsDirty()) {
+		Sort();
+	} else {
+		assert(IsSorted());
+	}
+
+	for (auto* drawable : _list) {
+		auto z = drawable->GetZ();
+		if (z < min_z) {
+			continue;
+		}
+		if (z > max_z) {
+			break;
+		}
+		if (drawable->IsVisible() && DamageRegion::Intersects(drawable->_damage_bounds, clip)) {
+			drawable->Draw(dst);
+		}
+	}
+}
+
+bool DrawableList::CollectDamage(DamageRegion& damage, Drawable::Z_t min_z, Drawable::Z_t max_z) {
+	bool tracked = true;
+
+	damage.Add(_removed_damage);
+	_removed_damage.Clear();
+
+	for (auto* drawable : _list) {
+		auto z = drawable->GetZ();
+		if (z < min_z || z > max_z) {
+			continue;
+		}
+
+		Rect bounds;
+		uint64_t state = 0;
+		if (drawable->IsVisible()) {
+			auto drawable_state = drawable->GetDamageState(bounds);
+			if (!drawable_state) {
+				drawable->_damage_valid = false;
+				tracked = false;
+				continue;
+			}
+			// The z value decides which drawable wins where they overlap
+			state = DamageHash().Add(*drawable_state).Add(z).Get();
+		}
+
+		if (drawable->_damage_valid &&
+				drawable->_damage_state == state &&
+				drawable->_damage_bounds == bounds) {
+			continue;
+		}
+
+		if (drawable->_damage_valid) {
+			damage.Add(drawable->_damage_bounds);
+		}
+		damage.Add(bounds);
+
+		drawable->_damage_bounds = bounds;
+		drawable->_damage_state = state;
+		drawable->_damage_valid = true;
+	}
+
+	return tracked;
+}
@@ -19,6 +19,7 @@
 #define EP_DRAWABLE_LIST_H
 
 #include "drawable.h"
+#include "damage_region.h"
 #include <memory>
 #include <vector>
 #include <limits>
@@ -131,8 +132,33 @@ class DrawableList {
 		 */
 		void Draw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z);
 
+		/**
+		 * Like Draw() but skips all drawables whose damage bounds are outside of clip.
+		 * CollectDamage() must be called before to update the damage bounds.
+		 *
+		 * @param dst The bitmap to draw onto
+		 * @param min_z Skip any drawables with z < min_z
+		 * @param max_z Skip any drawables with z > max_z
+		 * @param clip Screen area that is redrawn
+		 */
+		void Draw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z, const Rect& clip);
+
+		/**
+		 * Queries the damage state of all visible drawables and adds the screen
+		 * area of every drawable whose state changed since the last call to damage.
+		 * Areas of drawables removed from the list are added as well.
+		 *
+		 * @param damage region receiving the changed screen areas
+		 * @param min_z Skip any drawables with z < min_z
+		 * @param max_z Skip any drawables with z > max_z
+		 * @return false when a visible drawable does not support damage tracking
+		 * and the whole screen must be redrawn
+		 */
+		bool CollectDamage(DamageRegion& damage, Drawable::Z_t min_z, Drawable::Z_t max_z);
+
 	private:
 		std::vector<Drawable*> _list;
+		DamageRegion _removed_damage;
 		bool _dirty = false;
 
 		void SetClean();
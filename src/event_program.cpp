@@ -0,0 +1,251 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "event_program.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace {
+	std::map<std::tuple<EventProgram::Owner, int, int>, std::shared_ptr<const EventProgram>> shared_programs;
+}
+
+EventProgram::EventProgram(const std::vector<lcf::rpg::EventCommand>& commands) :
+	source(commands.data()),
+	hash(Hash(commands))
+{
+	ops.resize(commands.size());
+	operands.resize(commands.size());
+	for (size_t i = 0; i < commands.size(); ++i) {
+		const auto& com = commands[i];
+		auto& op = ops[i];
+		op.code = com.code;
+		op.indent = com.indent;
+		if (static_cast<Cmd>(com.code) == Cmd::Label && !com.parameters.empty()) {
+			op.label = com.parameters[0];
+		}
+		if (HasOperands(static_cast<Cmd>(com.code))) {
+			operands[i] = DecodeOperands(com);
+		}
+	}
+}
+
+bool EventProgram::IsCompiledFrom(const std::vector<lcf::rpg::EventCommand>& commands) const {
+	return source == commands.data() && ops.size() == commands.size() && hash == Hash(commands);
+}
+
+uint32_t EventProgram::Hash(const std::vector<lcf::rpg::EventCommand>& commands) {
+	// FNV-1a
+	uint32_t h = 2166136261u;
+	auto mix = [&h](int32_t value) {
+		h = (h ^ static_cast<uint32_t>(value)) * 16777619u;
+	};
+
+	for (const auto& com: commands) {
+		mix(com.code);
+		mix(com.indent);
+		const auto code = static_cast<Cmd>(com.code);
+		if (code == Cmd::Label || HasOperands(code)) {
+			mix(static_cast<int32_t>(com.parameters.size()));
+			for (int32_t param: com.parameters) {
+				mix(param);
+			}
+		}
+	}
+	return h;
+}
+
+bool EventProgram::HasOperands(Cmd code) {
+	switch (code) {
+		case Cmd::ControlSwitches:
+		case Cmd::ControlVars:
+		case Cmd::ConditionalBranch:
+		case Cmd::Loop:
+		case Cmd::EndLoop:
+		case Cmd::Wait:
+			return true;
+		default:
+			return false;
+	}
+}
+
+EventProgram::Operands EventProgram::DecodeOperands(const lcf::rpg::EventCommand& com) {
+	using Kind = Operands::Kind;
+	const auto& p = com.parameters;
+	const int size = static_cast<int>(p.size());
+	Operands result;
+
+	// The checks mirror the generic command handlers, any form they treat
+	// differently depending on the patches is left to them
+	switch (static_cast<Cmd>(com.code)) {
+		case Cmd::ControlSwitches:
+			if (size >= 4 && (p[0] == 0 || p[0] == 1) && p[3] >= 0 && p[3] <= 2) {
+				result.kind = Kind::ControlSwitches;
+				result.a = p[1];
+				result.b = p[0] == 0 ? p[1] : p[2];
+				result.op = static_cast<int8_t>(p[3]);
+			}
+			break;
+		case Cmd::ControlVars:
+			// Single variable, constant or variable operand, no Maniac operation
+			if (size >= 7 && (p[0] == 0 || (p[0] == 1 && p[1] == p[2])) && p[3] >= 0 && p[3] <= 5 && (p[4] == 0 || p[4] == 1)) {
+				result.kind = Kind::ControlVariable;
+				result.a = p[1];
+				result.b = p[5];
+				result.op = static_cast<int8_t>(p[3]);
+				result.indirect = p[4] == 1;
+			}
+			break;
+		case Cmd::ConditionalBranch:
+			if (size < 6) {
+				break;
+			}
+			if (p[0] == 0) {
+				result.kind = Kind::BranchSwitch;
+				result.a = p[1];
+				result.b = p[2] == 0 ? 1 : 0;
+			} else if (p[0] == 1 && (p[2] == 0 || p[2] == 1) && p[4] >= 0 && p[4] <= 5) {
+				result.kind = Kind::BranchVariable;
+				result.a = p[1];
+				result.b = p[3];
+				result.op = static_cast<int8_t>(p[4]);
+				result.indirect = p[2] == 1;
+			}
+			break;
+		case Cmd::Loop:
+			if (size < 5 || p[0] == 0) {
+				result.kind = Kind::Loop;
+			}
+			break;
+		case Cmd::EndLoop:
+			if (size < 5 || p[0] == 0) {
+				result.kind = Kind::EndLoop;
+			}
+			break;
+		case Cmd::Wait:
+			// Plain waits, the other forms wait for a key or use Maniac modes
+			if (size == 1 || (size >= 2 && p[1] == 0 && (size == 2 || p[2] == 0))) {
+				result.kind = Kind::Wait;
+				result.a = p[0];
+			}
+			break;
+		default:
+			break;
+	}
+	return result;
+}
+
+std::shared_ptr<const EventProgram> EventProgram::GetShared(Owner owner, int id, int page_id, const std::vector<lcf::rpg::EventCommand>& commands) {
+	auto& program = shared_programs[std::make_tuple(owner, id, page_id)];
+	if (!program || !program->IsCompiledFrom(commands)) {
+		program = std::make_shared<const EventProgram>(commands);
+	}
+	return program;
+}
+
+void EventProgram::DropShared(Owner owner, int id) {
+	auto it = shared_programs.lower_bound(std::make_tuple(owner, id, std::numeric_limits<int>::min()));
+	while (it != shared_programs.end() && std::get<0>(it->first) == owner && std::get<1>(it->first) == id) {
+		it = shared_programs.erase(it);
+	}
+}
+
+void EventProgram::ClearShared() {
+	shared_programs.clear();
+}
+
+EventProgram::Jump& EventProgram::GetJump(int index) const {
+	if (jumps.empty()) {
+		jumps.resize(ops.size());
+	}
+	return jumps[index];
+}
+
+int EventProgram::FindNext(int index, std::initializer_list<Cmd> codes, int indent) const {
+	if (index < 0 || index >= GetSize() || codes.size() > Jump::max_codes) {
+		return ScanNext(index, codes, indent);
+	}
+
+	// Every command always searches with the same arguments, but verify it
+	std::array<int32_t, Jump::max_codes> key = {};
+	std::transform(codes.begin(), codes.end(), key.begin(), [](Cmd code) { return static_cast<int32_t>(code); });
+
+	auto& jump = GetJump(index);
+	if (jump.next == Jump::unknown || jump.next_indent != indent || jump.next_codes != key) {
+		jump.next = ScanNext(index, codes, indent);
+		jump.next_indent = indent;
+		jump.next_codes = key;
+	}
+	return jump.next;
+}
+
+int EventProgram::FindLoopStart(int index, int indent) const {
+	if (index < 0 || index >= GetSize() || indent != ops[index].indent) {
+		return ScanLoopStart(index, indent);
+	}
+
+	auto& jump = GetJump(index);
+	if (jump.loop_start == Jump::unknown) {
+		jump.loop_start = ScanLoopStart(index, indent);
+	}
+	return jump.loop_start;
+}
+
+int EventProgram::FindLabel(int label_id) const {
+	if (!labels_built) {
+		for (int idx = 0; idx < GetSize(); ++idx) {
+			if (static_cast<Cmd>(ops[idx].code) == Cmd::Label && ops[idx].label != no_label) {
+				// The first label with an id wins
+				labels.emplace(ops[idx].label, idx);
+			}
+		}
+		labels_built = true;
+	}
+
+	auto it = labels.find(label_id);
+	return it != labels.end() ? it->second : -1;
+}
+
+int EventProgram::ScanNext(int index, std::initializer_list<Cmd> codes, int indent) const {
+	const int size = GetSize();
+	for (++index; index < size; ++index) {
+		const auto& op = ops[index];
+		if (op.indent > indent) {
+			continue;
+		}
+		if (std::find(codes.begin(), codes.end(), static_cast<Cmd>(op.code)) != codes.end()) {
+			break;
+		}
+	}
+	return std::min(index, size);
+}
+
+int EventProgram::ScanLoopStart(int index, int indent) const {
+	for (int idx = std::min(index, GetSize() - 1); idx >= 0; idx--) {
+		const auto& op = ops[idx];
+		if (op.indent > indent) {
+			continue;
+		}
+		if (op.indent < indent) {
+			return out_of_scope;
+		}
+		if (static_cast<Cmd>(op.code) == Cmd::Loop) {
+			return idx;
+		}
+	}
+	return -1;
+}
@@ -0,0 +1,227 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_EVENT_PROGRAM_H
+#define EP_EVENT_PROGRAM_H
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <lcf/rpg/eventcommand.h>
+
+/**
+ * Compact form of an event command list, decoded once per event page or
+ * common event and executed by the interpreter.
+ *
+ * Holds the code, indentation and label id of every command in a dense
+ * array, so control flow searches do not have to walk the full command
+ * structures with their strings and parameter arrays.
+ *
+ * The operands of the common forms of the most frequently executed
+ * commands are decoded and validated up front, the interpreter executes
+ * them without touching the parameter array. All other commands are
+ * executed from the original list.
+ *
+ * The results of the searches are cached per command, the first search
+ * builds the jump table. Later searches from the same command are O(1).
+ * Frames of the same event page or common event share one program, so
+ * the tables survive when the frames are popped.
+ */
+class EventProgram {
+public:
+	using Cmd = lcf::rpg::EventCommand::Code;
+
+	/** Label id of commands which are no label */
+	static constexpr int32_t no_label = std::numeric_limits<int32_t>::min();
+
+	/** Returned by FindLoopStart when a command of a lower indentation was found first */
+	static constexpr int out_of_scope = -2;
+
+	/**
+	 * Pre-decoded operands of a command. Only forms which behave the same
+	 * with every patch are decoded, everything else has the kind None.
+	 */
+	struct Operands {
+		enum class Kind : int8_t {
+			None,
+			/** Switches a to b, op 0 turns them on, 1 off and 2 toggles them */
+			ControlSwitches,
+			/** Applies operation op (0 - 5) with value b to variable a */
+			ControlVariable,
+			/** Branch taken when switch a is on (b = 1) or off (b = 0) */
+			BranchSwitch,
+			/** Branch taken when variable a compares to b with operator op */
+			BranchVariable,
+			/** Start of an endless loop, does nothing */
+			Loop,
+			/** End of an endless loop, jumps back to the start */
+			EndLoop,
+			/** Waits a tenths of a second */
+			Wait
+		};
+
+		Kind kind = Kind::None;
+		int8_t op = 0;
+		/** b is the id of the variable holding the value */
+		bool indirect = false;
+		int32_t a = 0;
+		int32_t b = 0;
+	};
+
+	/** Owner of a shared program */
+	enum class Owner {
+		MapEvent,
+		CommonEvent
+	};
+
+	/**
+	 * Returns the program shared by all frames executing the commands of an
+	 * event page or common event, decoded on the first request.
+	 *
+	 * @param owner type of the event
+	 * @param id event id
+	 * @param page_id page id, 0 for common events
+	 * @param commands command list of the page or common event
+	 * @return shared program
+	 */
+	static std::shared_ptr<const EventProgram> GetShared(Owner owner, int id, int page_id, const std::vector<lcf::rpg::EventCommand>& commands);
+
+	/**
+	 * Drops the shared programs of all pages of an event, must be called
+	 * when the event is destroyed or replaced.
+	 *
+	 * @param owner type of the event
+	 * @param id event id
+	 */
+	static void DropShared(Owner owner, int id);
+
+	/** Drops all shared programs, must be called when the map or the database changes */
+	static void ClearShared();
+
+	EventProgram() = default;
+
+	/**
+	 * Decodes a command list.
+	 *
+	 * @param commands command list, must outlive the program or be recompiled
+	 */
+	explicit EventProgram(const std::vector<lcf::rpg::EventCommand>& commands);
+
+	/**
+	 * The list is compared by address, length and a hash of the codes,
+	 * indentations and decoded parameters, so a new list allocated at the
+	 * address of a destroyed one is not mistaken for it.
+	 *
+	 * @return whether the program was decoded from this list
+	 */
+	bool IsCompiledFrom(const std::vector<lcf::rpg::EventCommand>& commands) const;
+
+	/** @return number of commands */
+	int GetSize() const;
+
+	/** @return code of the command at index */
+	Cmd GetCode(int index) const;
+
+	/** @return indentation of the command at index */
+	int GetIndent(int index) const;
+
+	/** @return pre-decoded operands of the command at index */
+	const Operands& GetOperands(int index) const;
+
+	/**
+	 * Finds the next command after index with one of the codes and an
+	 * indentation less or equal to indent.
+	 *
+	 * @return index of the command or the size when there is none
+	 */
+	int FindNext(int index, std::initializer_list<Cmd> codes, int indent) const;
+
+	/**
+	 * Searches backwards from index for the Loop command matching an
+	 * EndLoop of the indentation.
+	 *
+	 * @return index of the Loop, -1 when there is none or out_of_scope
+	 */
+	int FindLoopStart(int index, int indent) const;
+
+	/**
+	 * @param label_id id of the label
+	 * @return index of the first Label command with the id, -1 when there is none
+	 */
+	int FindLabel(int label_id) const;
+
+private:
+	struct Op {
+		int32_t code = 0;
+		int32_t indent = 0;
+		int32_t label = no_label;
+	};
+
+	/** Cached search results of one command */
+	struct Jump {
+		static constexpr int32_t unknown = std::numeric_limits<int32_t>::min();
+		static constexpr size_t max_codes = 3;
+
+		int32_t next = unknown;
+		int32_t next_indent = 0;
+		std::array<int32_t, max_codes> next_codes = {};
+		int32_t loop_start = unknown;
+	};
+
+	/** @return hash of the fields the program is decoded from */
+	static uint32_t Hash(const std::vector<lcf::rpg::EventCommand>& commands);
+
+	/** @return whether the parameters of commands with this code are decoded */
+	static bool HasOperands(Cmd code);
+
+	static Operands DecodeOperands(const lcf::rpg::EventCommand& com);
+
+	int ScanNext(int index, std::initializer_list<Cmd> codes, int indent) const;
+	int ScanLoopStart(int index, int indent) const;
+	Jump& GetJump(int index) const;
+
+	std::vector<Op> ops;
+	std::vector<Operands> operands;
+	const lcf::rpg::EventCommand* source = nullptr;
+	uint32_t hash = 0;
+
+	mutable std::vector<Jump> jumps;
+	mutable std::unordered_map<int32_t, int> labels;
+	mutable bool labels_built = false;
+};
+
+inline int EventProgram::GetSize() const {
+	return static_cast<int>(ops.size());
+}
+
+inline EventProgram::Cmd EventProgram::GetCode(int index) const {
+	return static_cast<Cmd>(ops[index].code);
+}
+
+inline int EventProgram::GetIndent(int index) const {
+	return ops[index].indent;
+}
+
+inline const EventProgram::Operands& EventProgram::GetOperands(int index) const {
+	return operands[index];
+}
+
+#endif
@@ -15,7 +15,9 @@
  * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <sstream>
+#include <fmt/format.h>
 
 #include "fps_overlay.h"
 #include "game_clock.h"
@@ -24,6 +26,9 @@
 #include "input.h"
 #include "font.h"
 #include "drawable_mgr.h"
+#include "damage_region.h"
+#include "instrumentation.h"
+#include "player.h"
 
 using namespace std::chrono_literals;
 
@@ -58,10 +63,74 @@ bool FpsOverlay::Update() {
 	last_refresh_time = now;
 
 	UpdateText();
+	UpdateProfileText();
 
 	return true;
 }
 
+void FpsOverlay::UpdateProfileText() {
+	if (!Instrumentation::IsProfilerEnabled()) {
+		return;
+	}
+
+	auto frames = Instrumentation::GetRecentFrames();
+	if (frames.empty()) {
+		return;
+	}
+
+	auto add_line = [&](const char* name, auto get) {
+		Game_Clock::duration sum = {};
+		Game_Clock::duration max = {};
+		for (auto& frame: frames) {
+			sum += get(frame);
+			max = std::max(max, get(frame));
+		}
+		auto to_ms = [](Game_Clock::duration d) {
+			return std::chrono::duration<double, std::milli>(d).count();
+		};
+		profile_text.push_back(fmt::format("{:<24}{:6.2f}{:7.2f}", name, to_ms(sum) / frames.size(), to_ms(max)));
+	};
+
+	profile_text.clear();
+	profile_text.push_back(fmt::format("{:<24}{:>6}{:>7}", "ms", "avg", "max"));
+	add_line("Frame", [](auto& frame) { return frame.total; });
+	for (int i = 0; i < Instrumentation::num_zones; ++i) {
+		auto zone = static_cast<Instrumentation::Zone>(i);
+		add_line(Instrumentation::GetZoneName(zone), [i](auto& frame) { return frame.zones[i]; });
+	}
+
+	profile_dirty = true;
+}
+
+std::optional<uint64_t> FpsOverlay::GetDamageState(Rect& bounds) {
+	if (!draw_fps && last_speed_mod <= 1) {
+		bounds = Rect();
+		return 0;
+	}
+
+	// The text width is only known after drawing, use the whole top row.
+	// The height of the bitmap font never changes.
+	bounds = Rect(0, 0, Player::screen_width, 16);
+	if (draw_fps && !profile_text.empty()) {
+		bounds.height += static_cast<int>(profile_text.size()) * 16;
+	}
+
+	DamageHash hash;
+	hash.Add(draw_fps).Add(fps_dirty).Add(fps_rect)
+		.Add(last_speed_mod).Add(speedup_dirty).Add(speedup_rect)
+		.Add(profile_dirty).Add(profile_rect);
+	if (fps_bitmap) {
+		hash.Add(fps_bitmap->GetRevision());
+	}
+	if (speedup_bitmap) {
+		hash.Add(speedup_bitmap->GetRevision());
+	}
+	if (profile_bitmap) {
+		hash.Add(profile_bitmap->GetRevision());
+	}
+	return hash.Get();
+}
+
 void FpsOverlay::Draw(Bitmap& dst) {
 	if (draw_fps) {
 		if (fps_dirty) {
@@ -82,6 +151,35 @@ void FpsOverlay::Draw(Bitmap& dst) {
 		}
 
 		dst.Blit(1, 2, *fps_bitmap, fps_rect, 255);
+
+		if (!profile_text.empty()) {
+			if (profile_dirty) {
+				Rect rect;
+				for (auto& line: profile_text) {
+					auto line_rect = Text::GetSize(*Font::DefaultBitmapFont(), line);
+					rect.width = std::max(rect.width, line_rect.width + 1);
+					rect.height += line_rect.height;
+				}
+
+				if (!profile_bitmap || profile_bitmap->GetWidth() < rect.width || profile_bitmap->GetHeight() < rect.height) {
+					profile_bitmap = Bitmap::Create(rect.width, rect.height, true);
+				}
+				profile_bitmap->Clear();
+				profile_bitmap->Fill(Color(0, 0, 0, 128));
+
+				int y = 0;
+				for (auto& line: profile_text) {
+					Text::Draw(*profile_bitmap, 1, y, *Font::DefaultBitmapFont(), Color(255, 255, 255, 255), line);
+					y += Text::GetSize(*Font::DefaultBitmapFont(), line).height;
+				}
+
+				profile_rect = Rect(0, 0, rect.width, rect.height);
+
+				profile_dirty = false;
+			}
+
+			dst.Blit(1, 2 + fps_rect.height + 1, *profile_bitmap, profile_rect, 255);
+		}
 	}
 
 	// Always drawn when speedup is on independent of FPS
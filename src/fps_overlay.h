@@ -20,6 +20,7 @@
 
 #include <deque>
 #include <string>
+#include <vector>
 #include "drawable.h"
 #include "memory_management.h"
 #include "rect.h"
@@ -28,6 +29,8 @@
 /**
  * FpsOverlay class.
  * Shows current FPS and the speedup indicator.
+ * When the frame profiler is enabled the time spent per subsystem
+ * is shown below the FPS.
  */
 class FpsOverlay : public Drawable {
 public:
@@ -35,6 +38,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
+
 	/**
 	 * Update the fps overlay.
 	 *
@@ -58,20 +63,25 @@ public:
 
 private:
 	void UpdateText();
+	void UpdateProfileText();
 
 	BitmapRef fps_bitmap;
 	BitmapRef speedup_bitmap;
+	BitmapRef profile_bitmap;
 	Game_Clock::time_point last_refresh_time;
 
 	/** Rect to draw on screen */
 	Rect fps_rect;
 	Rect speedup_rect;
+	Rect profile_rect;
 
 	std::string text;
+	std::vector<std::string> profile_text;
 
 	int last_speed_mod = 1;
 	bool speedup_dirty = true;
 	bool fps_dirty = true;
+	bool profile_dirty = false;
 	bool draw_fps = true;
 };
 
@@ -23,6 +23,7 @@
 #include "main_data.h"
 #include "frame.h"
 #include "drawable_mgr.h"
+#include "damage_region.h"
 
 Frame::Frame() :
 	Drawable(Priority_Frame)
@@ -41,6 +42,17 @@ void Frame::Update() {
 	// no-op
 }
 
+std::optional<uint64_t> Frame::GetDamageState(Rect& bounds) {
+	if (!frame_bitmap) {
+		bounds = Rect();
+		return 0;
+	}
+
+	bounds = frame_bitmap->GetRect();
+
+	return DamageHash().Add(frame_bitmap.get()).Add(frame_bitmap->GetRevision()).Get();
+}
+
 void Frame::Draw(Bitmap& dst) {
 	if (frame_bitmap) {
 		dst.Blit(0, 0, *frame_bitmap, frame_bitmap->GetRect(), 255);
@@ -32,6 +32,8 @@ public:
 	Frame();
 
 	void Draw(Bitmap& dst) override;
+
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
 	void Update();
 
 private:
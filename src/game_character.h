@@ -943,6 +943,8 @@ protected:
 	void IncAnimFrame();
 	void UpdateFlash();
 	bool BeginMoveRouteJump(int32_t& current_index, const lcf::rpg::MoveRoute& current_route);
+	/** Keeps the spatial event index of the map in sync */
+	void OnEventMoved(int old_x, int old_y);
 
 	lcf::rpg::SaveMapEventBase* data();
 	const lcf::rpg::SaveMapEventBase* data() const;
@@ -999,7 +1001,11 @@ inline int Game_Character::GetX() const {
 }
 
 inline void Game_Character::SetX(int new_x) {
+	int old_x = data()->position_x;
 	data()->position_x = new_x;
+	if (_type == Event && old_x != new_x) {
+		OnEventMoved(old_x, GetY());
+	}
 }
 
 inline int Game_Character::GetY() const {
@@ -1007,7 +1013,11 @@ inline int Game_Character::GetY() const {
 }
 
 inline void Game_Character::SetY(int new_y) {
+	int old_y = data()->position_y;
 	data()->position_y = new_y;
+	if (_type == Event && old_y != new_y) {
+		OnEventMoved(GetX(), old_y);
+	}
 }
 
 inline int Game_Character::GetMapId() const {
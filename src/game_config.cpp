@@ -473,6 +473,14 @@ void Game_Config::LoadFromArgs(CmdlineParser& cp) {
 			video.pause_when_focus_lost.Set(false);
 			continue;
 		}
+		if (cp.ParseNext(arg, 0, "--damage-tracking")) {
+			video.damage_tracking.Set(true);
+			continue;
+		}
+		if (cp.ParseNext(arg, 0, "--no-damage-tracking")) {
+			video.damage_tracking.Set(false);
+			continue;
+		}
 		if (cp.ParseNext(arg, 0, "--window")) {
 			video.fullscreen.Set(false);
 			continue;
@@ -535,6 +543,16 @@ void Game_Config::LoadFromArgs(CmdlineParser& cp) {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 1, "--se-cache-size")) {
+			if (arg.ParseValue(0, li_value)) {
+				audio.se_cache_size.Set(li_value);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 0, "--preload-se")) {
+			audio.se_preload.Set(true);
+			continue;
+		}
 		if (cp.ParseNext(arg, 1, "--font1")) {
 			if (arg.NumValues() > 0) {
 				player.font1.Set(FileFinder::MakeCanonical(arg.Value(0), 0));
@@ -559,6 +577,12 @@ void Game_Config::LoadFromArgs(CmdlineParser& cp) {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 1, "--image-cache-size")) {
+			if (arg.ParseValue(0, li_value)) {
+				player.image_cache_size.Set(li_value);
+			}
+			continue;
+		}
 		if (cp.ParseNext(arg, 1, "--soundfont-path")) {
 			if (arg.NumValues() > 0) {
 				soundfont_path = FileFinder::MakeCanonical(arg.Value(0), 0);
@@ -602,6 +626,7 @@ void Game_Config::LoadFromStream(Filesystem_Stream::InputStream& is) {
 	video.pause_when_focus_lost.FromIni(ini);
 	video.game_resolution.FromIni(ini);
 	video.screen_scale.FromIni(ini);
+	video.damage_tracking.FromIni(ini);
 
 	if (ini.HasValue("Video", "WindowX") && ini.HasValue("Video", "WindowY") && ini.HasValue("Video", "WindowWidth") && ini.HasValue("Video", "WindowHeight")) {
 		video.window_x.FromIni(ini);
@@ -617,6 +642,8 @@ void Game_Config::LoadFromStream(Filesystem_Stream::InputStream& is) {
 	audio.wildmidi_midi.FromIni(ini);
 	audio.native_midi.FromIni(ini);
 	audio.soundfont.FromIni(ini);
+	audio.se_cache_size.FromIni(ini);
+	audio.se_preload.FromIni(ini);
 
 	/** INPUT SECTION */
 	input.buttons = Input::GetDefaultButtonMappings();
@@ -684,6 +711,7 @@ void Game_Config::LoadFromStream(Filesystem_Stream::InputStream& is) {
 	player.automatic_screenshots.FromIni(ini);
 	player.automatic_screenshots_interval.FromIni(ini);
 	player.prefer_easyrpg_map_files.FromIni(ini);
+	player.image_cache_size.FromIni(ini);
 }
 
 void Game_Config::WriteToStream(Filesystem_Stream::OutputStream& os) const {
@@ -701,6 +729,7 @@ void Game_Config::WriteToStream(Filesystem_Stream::OutputStream& os) const {
 	video.pause_when_focus_lost.ToIni(os);
 	video.game_resolution.ToIni(os);
 	video.screen_scale.ToIni(os);
+	video.damage_tracking.ToIni(os);
 
 	// only preserve when toggling between window and fullscreen is supported
 	if (video.fullscreen.IsOptionVisible()) {
@@ -720,6 +749,8 @@ void Game_Config::WriteToStream(Filesystem_Stream::OutputStream& os) const {
 	audio.wildmidi_midi.ToIni(os);
 	audio.native_midi.ToIni(os);
 	audio.soundfont.ToIni(os);
+	audio.se_cache_size.ToIni(os);
+	audio.se_preload.ToIni(os);
 
 	os << "\n";
 
@@ -778,6 +809,7 @@ void Game_Config::WriteToStream(Filesystem_Stream::OutputStream& os) const {
 	player.automatic_screenshots.ToIni(os);
 	player.automatic_screenshots_interval.ToIni(os);
 	player.prefer_easyrpg_map_files.ToIni(os);
+	player.image_cache_size.ToIni(os);
 
 	os << "\n";
 }
@@ -109,6 +109,7 @@ struct Game_ConfigPlayer {
 	BoolConfigParam automatic_screenshots{ "Automatic screenshots", "Periodically take screenshots", "Player", "AutomaticScreenshots", false };
 	RangeConfigParam<int> automatic_screenshots_interval{ "Screenshot interval", "The interval between automatic screenshots (seconds)", "Player", "AutomaticScreenshotsInterval", 30, 1, 999999 };
 	BoolConfigParam prefer_easyrpg_map_files{ "Prefer EasyRPG map files", "Attempt to load EasyRPG map files (.emu) first and fall back to RPG Maker map files (.lmu)", "Player", "PreferEasyRpgMapFiles", true };
+	RangeConfigParam<int> image_cache_size{ "Image cache size", "Memory used for caching images (MB). Lower it on devices with little RAM", "Player", "ImageCacheSize", 10, 1, 1024 };
 
 	void Hide();
 };
@@ -136,6 +137,7 @@ struct Game_ConfigVideo {
 		Utils::MakeSvArray("original", "widescreen", "ultrawide"),
 		Utils::MakeSvArray("The default resolution (320x240, 4:3)", "Can cause glitches (416x240, 16:9)", "Can cause glitches (560x240, 21:9)")};
 	RangeConfigParam<int> screen_scale{ "Scaling", "Adjust screen scaling (Overscan/Underscan)", "Video", "ScreenScale", 100, 50, 150 };
+	BoolConfigParam damage_tracking{ "Partial redraw", "Only redraw parts of the screen that changed (Experimental)", "Video", "DamageTracking", false };
 
 	// These are never shown and are used to restore the window to the previous position
 	ConfigParam<int> window_x{ "", "", "Video", "WindowX", -1 };
@@ -154,6 +156,8 @@ struct Game_ConfigAudio {
 	BoolConfigParam native_midi { "Native MIDI", "Play MIDI through the operating system ", "Audio", "NativeMidi", true };
 	LockedConfigParam<std::string> fmmidi_midi { "FmMidi", "Play MIDI using the built-in MIDI synthesizer", "[Always ON]" };
 	PathConfigParam soundfont { "Soundfont", "Soundfont to use for " EP_FLUID_NAME, "Audio", "Soundfont", "" };
+	RangeConfigParam<int> se_cache_size{ "SFX cache size", "Memory used for caching sound effects (MB)", "Audio", "SeCacheSize", 3, 1, 256 };
+	BoolConfigParam se_preload{ "Preload SFX", "Decode the sound effects of the game in the background after loading", "Audio", "PreloadSe", false };
 
 	void Hide();
 };
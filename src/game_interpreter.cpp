@@ -20,6 +20,7 @@
 #include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <regex>
 #include <sstream>
 #include <string>
@@ -56,6 +57,7 @@
 #include "scene_settings.h"
 #include "scene.h"
 #include "game_clock.h"
+#include "instrumentation.h"
 #include "input.h"
 #include "main_data.h"
 #include "output.h"
@@ -77,6 +79,90 @@ enum BranchSubcommand {
 	eOptionBranchElse = 1
 };
 
+namespace {
+	// Amount of upcoming commands scanned for assets
+	constexpr int prefetch_lookahead = 8;
+
+	// Maniac Patch can read file names from strings, these are only known on execution
+	bool IsLiteralString(lcf::rpg::EventCommand const& com, int mode_idx, int shift) {
+		if (!Player::IsPatchManiac() || static_cast<int>(com.parameters.size()) <= mode_idx) {
+			return true;
+		}
+		return ((com.parameters[mode_idx] >> (shift * 4)) & 0xF) == 0;
+	}
+
+	void PrefetchFile(std::string_view folder_name, std::string_view file_name, bool graphic) {
+		if (file_name.empty()) {
+			return;
+		}
+
+		auto* request = AsyncHandler::RequestFile(folder_name, file_name);
+		if (request->IsReady()) {
+			return;
+		}
+		if (graphic) {
+			request->SetGraphicFile(true);
+		}
+		request->Start();
+	}
+
+	void PrefetchCommand(lcf::rpg::EventCommand const& com) {
+		using Cmd = lcf::rpg::EventCommand::Code;
+
+		switch (static_cast<Cmd>(com.code)) {
+			case Cmd::ShowPicture: {
+				const int size = static_cast<int>(com.parameters.size());
+				// Picture pointer patch replaces parts of the name with a variable
+				if ((size <= 17 || IsLiteralString(com, 17, 2)) && (size <= 19 || com.parameters[19] == 0)) {
+					PrefetchFile("Picture", com.string, true);
+				}
+				break;
+			}
+			case Cmd::ChangeFaceGraphic:
+				if (IsLiteralString(com, 3, 0)) {
+					PrefetchFile("FaceSet", com.string, true);
+				}
+				break;
+			case Cmd::ChangeSpriteAssociation:
+				if (IsLiteralString(com, 3, 1)) {
+					PrefetchFile("CharSet", com.string, true);
+				}
+				break;
+			case Cmd::ChangePBG:
+				if (IsLiteralString(com, 6, 0)) {
+					PrefetchFile("Panorama", com.string, true);
+				}
+				break;
+			case Cmd::ShowBattleAnimation:
+			case Cmd::ShowBattleAnimation_B:
+				if (!com.parameters.empty()) {
+					auto* anim = lcf::ReaderUtil::GetElement(lcf::Data::animations, com.parameters[0]);
+					if (anim) {
+						PrefetchFile(anim->large ? "Battle2" : "Battle", anim->animation_name, true);
+					}
+				}
+				break;
+			case Cmd::PlayBGM:
+				if (IsLiteralString(com, 4, 0)) {
+					PrefetchFile("Music", com.string, false);
+				}
+				break;
+			case Cmd::PlaySound:
+				if (IsLiteralString(com, 3, 0)) {
+					PrefetchFile("Sound", com.string, false);
+				}
+				break;
+			case Cmd::Teleport:
+				if (!com.parameters.empty() && com.parameters[0] > 0) {
+					PrefetchFile(".", Game_Map::ConstructMapName(com.parameters[0], false), false);
+				}
+				break;
+			default:
+				break;
+		}
+	}
+}
+
 Game_Interpreter::Game_Interpreter(bool _main_flag) {
 	main_flag = _main_flag;
 
@@ -89,8 +175,11 @@ Game_Interpreter::~Game_Interpreter() {
 // Clear.
 void Game_Interpreter::Clear() {
 	_state = {};
+	_programs.clear();
 	_keyinput = {};
 	_async_op = {};
+	prefetch_list = nullptr;
+	prefetch_index = 0;
 }
 
 // Is interpreter running.
@@ -142,6 +231,32 @@ void Game_Interpreter::PushInternal(
 	}
 
 	_state.stack.push_back(std::move(frame));
+	// Drop the program of a previous frame at this depth
+	_programs.resize(_state.stack.size() - 1);
+}
+
+void Game_Interpreter::ShareProgram(size_t depth, EventProgram::Owner owner, int id, int page_id, const std::vector<lcf::rpg::EventCommand>& commands) {
+	if (_state.stack.size() <= depth) {
+		return;
+	}
+
+	_programs.resize(_state.stack.size());
+	auto& entry = _programs.back();
+	entry.program = EventProgram::GetShared(owner, id, page_id, commands);
+	entry.commands = GetFrame().commands.data();
+}
+
+const EventProgram& Game_Interpreter::GetProgram() {
+	_programs.resize(_state.stack.size());
+
+	// Frames pushed from a plain list or loaded from a savegame decode their own program
+	auto& entry = _programs.back();
+	const auto& commands = GetFrame().commands;
+	if (!entry.program || entry.commands != commands.data() || entry.program->GetSize() != static_cast<int>(commands.size())) {
+		entry.program = std::make_shared<const EventProgram>(commands);
+		entry.commands = commands.data();
+	}
+	return *entry.program;
 }
 
 
@@ -372,6 +487,8 @@ int Game_Interpreter::GetSubcommandIndex(int indent) const {
 
 // Update
 void Game_Interpreter::Update(bool reset_loop_count) {
+	Instrumentation::ZoneScope zone(Instrumentation::Zone::InterpreterUpdate);
+
 	if (reset_loop_count) {
 		loop_count = 0;
 	}
@@ -546,28 +663,59 @@ void Game_Interpreter::Update(bool reset_loop_count) {
 		Output::Debug("Event {} exceeded execution limit", event_id);
 	}
 
+	PrefetchAssets();
+
 	if (Game_Map::GetNeedRefresh()) {
 		Game_Map::Refresh();
 	}
 }
 
+void Game_Interpreter::PrefetchAssets() {
+	const auto* frame = GetFramePtr();
+	if (frame == nullptr) {
+		return;
+	}
+
+	const auto& list = frame->commands;
+	int start = frame->current_command;
+	if (list.data() == prefetch_list) {
+		// Only scan commands that were not visited yet
+		start = std::max(start, prefetch_index);
+	}
+	int end = std::min(frame->current_command + prefetch_lookahead, static_cast<int>(list.size()));
+
+	for (int i = start; i < end; ++i) {
+		PrefetchCommand(list[i]);
+	}
+
+	prefetch_list = list.data();
+	prefetch_index = std::max(start, end);
+}
+
 // Setup Starting Event
 void Game_Interpreter::PushInternal(Game_Event* ev, ExecutionType ex_type) {
+	const auto depth = _state.stack.size();
+	const int page_id = ev->GetActivePage() ? ev->GetActivePage()->ID : 0;
 	PushInternal(
 		{ ex_type, EventType::MapEvent },
-		ev->GetList(), ev->GetId(), ev->GetActivePage() ? ev->GetActivePage()->ID : 0
+		ev->GetList(), ev->GetId(), page_id
 	);
+	ShareProgram(depth, EventProgram::Owner::MapEvent, ev->GetId(), page_id, ev->GetList());
 }
 
 void Game_Interpreter::PushInternal(Game_Event* ev, const lcf::rpg::EventPage* page, ExecutionType ex_type) {
+	const auto depth = _state.stack.size();
 	PushInternal(
 		{ ex_type, EventType::MapEvent },
 		page->event_commands, ev->GetId(), page->ID
 	);
+	ShareProgram(depth, EventProgram::Owner::MapEvent, ev->GetId(), page->ID, page->event_commands);
 }
 
 void Game_Interpreter::PushInternal(Game_CommonEvent* ev, ExecutionType ex_type) {
+	const auto depth = _state.stack.size();
 	PushInternal({ ex_type, EventType::CommonEvent }, ev->GetList(), ev->GetId());
+	ShareProgram(depth, EventProgram::Owner::CommonEvent, ev->GetId(), 0, ev->GetList());
 }
 
 bool Game_Interpreter::CheckGameOver() {
@@ -582,32 +730,64 @@ bool Game_Interpreter::CheckGameOver() {
 }
 
 void Game_Interpreter::SkipToNextConditional(std::initializer_list<Cmd> codes, int indent) {
-	auto& frame = GetFrame();
-	const auto& list = frame.commands;
-	auto& index = frame.current_command;
+	const auto& program = GetProgram();
+	auto& index = GetFrame().current_command;
 
-	if (index >= static_cast<int>(list.size())) {
+	if (index >= program.GetSize()) {
 		return;
 	}
 
-	for (++index; index < static_cast<int>(list.size()); ++index) {
-		const auto& com = list[index];
-		if (com.indent > indent) {
-			continue;
-		}
-		if (std::find(codes.begin(), codes.end(), static_cast<Cmd>(com.code)) != codes.end()) {
-			break;
-		}
-	}
+	index = program.FindNext(index, codes, indent);
 }
 
 // Execute Command.
 bool Game_Interpreter::ExecuteCommand() {
 	auto& frame = GetFrame();
-	const auto& com = frame.commands[frame.current_command];
+	const int index = frame.current_command;
+
+	const auto& program = GetProgram();
+	const auto& operands = program.GetOperands(index);
+	if (operands.kind != EventProgram::Operands::Kind::None) {
+		return ExecuteOperands(operands, program.GetIndent(index));
+	}
+
+	const auto& com = frame.commands[index];
 	return ExecuteCommand(com);
 }
 
+bool Game_Interpreter::ExecuteOperands(const EventProgram::Operands& operands, int indent) {
+	using Kind = EventProgram::Operands::Kind;
+
+	switch (operands.kind) {
+		case Kind::ControlSwitches:
+			SetSwitches(operands.a, operands.b, operands.op);
+			return true;
+		case Kind::ControlVariable: {
+			const int value = operands.indirect ? Main_Data::game_variables->Get(operands.b) : operands.b;
+			OperateVariable(operands.a, operands.op, value);
+			return true;
+		}
+		case Kind::BranchSwitch:
+			BranchOnResult(Main_Data::game_switches->Get(operands.a) == (operands.b != 0), indent);
+			return true;
+		case Kind::BranchVariable: {
+			const int value = operands.indirect ? Main_Data::game_variables->Get(operands.b) : operands.b;
+			BranchOnResult(CheckOperator(Main_Data::game_variables->Get(operands.a), value, operands.op), indent);
+			return true;
+		}
+		case Kind::Loop:
+			return true;
+		case Kind::EndLoop:
+			return RestartLoop(indent);
+		case Kind::Wait:
+			SetupWait(operands.a);
+			return true;
+		case Kind::None:
+			break;
+	}
+	return true;
+}
+
 bool Game_Interpreter::ExecuteCommand(lcf::rpg::EventCommand const& com) {
 	switch (static_cast<Cmd>(com.code)) {
 		case Cmd::ShowMessage:
@@ -858,6 +1038,7 @@ bool Game_Interpreter::OnFinishStackFrame() {
 	} else {
 		// If a called frame, or base frame of foreground interpreter, pop the stack.
 		_state.stack.pop_back();
+		_programs.resize(std::min(_programs.size(), _state.stack.size()));
 	}
 
 	if (is_base_frame) {
@@ -1076,25 +1257,27 @@ bool Game_Interpreter::CommandControlSwitches(lcf::rpg::EventCommand const& com)
 			return true;
 		}
 
-		int val = com.parameters[3];
+		SetSwitches(start, end, com.parameters[3]);
+	}
+	return true;
+}
 
-		if (start == end) {
-			if (val < 2) {
-				Main_Data::game_switches->Set(start, val == 0);
-			} else {
-				Main_Data::game_switches->Flip(start);
-			}
-			Game_Map::SetNeedRefreshForSwitchChange(start);
+void Game_Interpreter::SetSwitches(int start, int end, int val) {
+	if (start == end) {
+		if (val < 2) {
+			Main_Data::game_switches->Set(start, val == 0);
 		} else {
-			if (val < 2) {
-				Main_Data::game_switches->SetRange(start, end, val == 0);
-			} else {
-				Main_Data::game_switches->FlipRange(start, end);
-			}
-			Game_Map::SetNeedRefresh(true);
+			Main_Data::game_switches->Flip(start);
 		}
+		Game_Map::SetNeedRefreshForSwitchChange(start);
+	} else {
+		if (val < 2) {
+			Main_Data::game_switches->SetRange(start, end, val == 0);
+		} else {
+			Main_Data::game_switches->FlipRange(start, end);
+		}
+		Game_Map::SetNeedRefresh(true);
 	}
-	return true;
 }
 
 bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com) { // code 10220
@@ -1299,43 +1482,7 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 
 		if (start == end) {
 			// Single variable case - if this is random value, we already called the RNG earlier.
-			switch (operation) {
-				case 0:
-					Main_Data::game_variables->Set(start, value);
-					break;
-				case 1:
-					Main_Data::game_variables->Add(start, value);
-					break;
-				case 2:
-					Main_Data::game_variables->Sub(start, value);
-					break;
-				case 3:
-					Main_Data::game_variables->Mult(start, value);
-					break;
-				case 4:
-					Main_Data::game_variables->Div(start, value);
-					break;
-				case 5:
-					Main_Data::game_variables->Mod(start, value);
-					break;
-				case 6:
-					Main_Data::game_variables->BitOr(start, value);
-					break;
-				case 7:
-					Main_Data::game_variables->BitAnd(start, value);
-					break;
-				case 8:
-					Main_Data::game_variables->BitXor(start, value);
-					break;
-				case 9:
-					Main_Data::game_variables->BitShiftLeft(start, value);
-					break;
-				case 10:
-					Main_Data::game_variables->BitShiftRight(start, value);
-					break;
-			}
-			Game_Map::SetNeedRefreshForVarChange(start);
-			RuntimePatches::OnVariableChanged(start);
+			OperateVariable(start, operation, value);
 		} else if (com.parameters[4] == 1) {
 			// Multiple variables - Direct variable lookup
 			int var_id = com.parameters[5];
@@ -1502,6 +1649,46 @@ bool Game_Interpreter::CommandControlVariables(lcf::rpg::EventCommand const& com
 	return true;
 }
 
+void Game_Interpreter::OperateVariable(int var_id, int operation, int value) {
+	switch (operation) {
+		case 0:
+			Main_Data::game_variables->Set(var_id, value);
+			break;
+		case 1:
+			Main_Data::game_variables->Add(var_id, value);
+			break;
+		case 2:
+			Main_Data::game_variables->Sub(var_id, value);
+			break;
+		case 3:
+			Main_Data::game_variables->Mult(var_id, value);
+			break;
+		case 4:
+			Main_Data::game_variables->Div(var_id, value);
+			break;
+		case 5:
+			Main_Data::game_variables->Mod(var_id, value);
+			break;
+		case 6:
+			Main_Data::game_variables->BitOr(var_id, value);
+			break;
+		case 7:
+			Main_Data::game_variables->BitAnd(var_id, value);
+			break;
+		case 8:
+			Main_Data::game_variables->BitXor(var_id, value);
+			break;
+		case 9:
+			Main_Data::game_variables->BitShiftLeft(var_id, value);
+			break;
+		case 10:
+			Main_Data::game_variables->BitShiftRight(var_id, value);
+			break;
+	}
+	Game_Map::SetNeedRefreshForVarChange(var_id);
+	RuntimePatches::OnVariableChanged(var_id);
+}
+
 int Game_Interpreter::OperateValue(int operation, int operand_type, int operand) {
 	int value = ValueOrVariable(operand_type, operand);
 
@@ -3770,14 +3957,18 @@ bool Game_Interpreter::CommandConditionalBranch(lcf::rpg::EventCommand const& co
 		Output::Warning("ConditionalBranch: Branch {} unsupported", com.parameters[0]);
 	}
 
+	BranchOnResult(result, com.indent);
+	return true;
+}
+
+void Game_Interpreter::BranchOnResult(bool result, int indent) {
 	int sub_idx = subcommand_sentinel;
 	if (!result) {
 		sub_idx = eOptionBranchElse;
-		SkipToNextConditional({Cmd::ElseBranch, Cmd::EndBranch}, com.indent);
+		SkipToNextConditional({Cmd::ElseBranch, Cmd::EndBranch}, indent);
 	}
 
-	SetSubcommandIndex(com.indent, sub_idx);
-	return true;
+	SetSubcommandIndex(indent, sub_idx);
 }
 
 
@@ -3790,19 +3981,9 @@ bool Game_Interpreter::CommandEndBranch(lcf::rpg::EventCommand const& /* com */)
 }
 
 bool Game_Interpreter::CommandJumpToLabel(lcf::rpg::EventCommand const& com) { // code 12120
-	auto& frame = GetFrame();
-	const auto& list = frame.commands;
-	auto& index = frame.current_command;
-
-	int label_id = com.parameters[0];
-
-	for (int idx = 0; (size_t)idx < list.size(); idx++) {
-		if (static_cast<Cmd>(list[idx].code) != Cmd::Label)
-			continue;
-		if (list[idx].parameters.empty() || list[idx].parameters[0] != label_id)
-			continue;
-		index = idx;
-		break;
+	int label_idx = GetProgram().FindLabel(com.parameters[0]);
+	if (label_idx >= 0) {
+		GetFrame().current_command = label_idx;
 	}
 
 	return true;
@@ -3886,20 +4067,15 @@ bool Game_Interpreter::CommandBreakLoop(lcf::rpg::EventCommand const& /* com */)
 
 	// This emulates an RPG_RT bug where break loop ignores scopes and
 	// unconditionally jumps to the next EndLoop command.
-	auto pcode = static_cast<Cmd>(list[index].code);
-	for (++index; index < (int)list.size(); ++index) {
-		if (pcode == Cmd::EndLoop) {
-			break;
-		}
-		pcode = static_cast<Cmd>(list[index].code);
-	}
+	const auto& program = GetProgram();
+	index = program.FindNext(index, { Cmd::EndLoop }, std::numeric_limits<int>::max());
+	index = std::min(index + 1, program.GetSize());
 
 	return true;
 }
 
 bool Game_Interpreter::CommandEndLoop(lcf::rpg::EventCommand const& com) { // code 22210
 	auto& frame = GetFrame();
-	const auto& list = frame.commands;
 	auto& index = frame.current_command;
 
 	int indent = com.indent;
@@ -3955,16 +4131,19 @@ bool Game_Interpreter::CommandEndLoop(lcf::rpg::EventCommand const& com) { // co
 		}
 	}
 
-	// Restart the loop
-	for (int idx = index; idx >= 0; idx--) {
-		if (list[idx].indent > indent)
-			continue;
-		if (list[idx].indent < indent)
-			return false;
-		if (static_cast<Cmd>(list[idx].code) != Cmd::Loop)
-			continue;
-		index = idx;
-		break;
+	return RestartLoop(indent);
+}
+
+bool Game_Interpreter::RestartLoop(int indent) {
+	auto& frame = GetFrame();
+	auto& index = frame.current_command;
+
+	int loop_idx = GetProgram().FindLoopStart(index, indent);
+	if (loop_idx == EventProgram::out_of_scope) {
+		return false;
+	}
+	if (loop_idx >= 0) {
+		index = loop_idx;
 	}
 
 	// Jump past the Cmd::Loop to the first command.
@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 #include "async_handler.h"
+#include "event_program.h"
 #include "game_character.h"
 #include "game_actor.h"
 #include "game_interpreter_shared.h"
@@ -89,6 +90,17 @@ public:
 	bool ExecuteCommand();
 	virtual bool ExecuteCommand(lcf::rpg::EventCommand const& com);
 
+	/**
+	 * Executes a command from its pre-decoded operands. These commands do
+	 * not go through ExecuteCommand(com), derived interpreters must not
+	 * handle their codes.
+	 *
+	 * @param operands operands of the command
+	 * @param indent indentation of the command
+	 * @return false when the interpreter must stop for this frame
+	 */
+	bool ExecuteOperands(const EventProgram::Operands& operands, int indent);
+
 
 	/**
 	 * Returns the interpreters current state information.
@@ -140,6 +152,17 @@ protected:
 	const lcf::rpg::SaveEventExecFrame* GetFramePtr() const;
 	lcf::rpg::SaveEventExecFrame* GetFramePtr();
 
+	/** @return the decoded command list of the current frame, decoded when it executes first */
+	const EventProgram& GetProgram();
+
+	/**
+	 * Attaches the shared program of an event page or common event to the
+	 * frame pushed last.
+	 *
+	 * @param depth stack size before the push, nothing is done when no frame was pushed
+	 */
+	void ShareProgram(size_t depth, EventProgram::Owner owner, int id, int page_id, const std::vector<lcf::rpg::EventCommand>& commands);
+
 	bool main_flag;
 
 	int loop_count = 0;
@@ -179,6 +202,40 @@ protected:
 	 */
 	void SetupWait(int duration);
 
+	/**
+	 * Turns switches on or off or toggles them.
+	 *
+	 * @param start first switch
+	 * @param end last switch
+	 * @param val 0: on, 1: off, 2: toggle
+	 */
+	void SetSwitches(int start, int end, int val);
+
+	/**
+	 * Applies an operation to a single variable.
+	 *
+	 * @param var_id variable
+	 * @param operation operation of ControlVariables (0 - 10)
+	 * @param value right operand
+	 */
+	void OperateVariable(int var_id, int operation, int value);
+
+	/**
+	 * Enters a conditional branch or skips to its else branch.
+	 *
+	 * @param result whether the condition is met
+	 * @param indent indentation of the branch
+	 */
+	void BranchOnResult(bool result, int indent);
+
+	/**
+	 * Jumps back to the first command of the loop ending at the current command.
+	 *
+	 * @param indent indentation of the EndLoop
+	 * @return false when the loop start is out of scope
+	 */
+	bool RestartLoop(int indent);
+
 	/**
 	 * Sets up a wait using frames (and closes the message box)
 	 */
@@ -358,9 +415,29 @@ protected:
 	int ManiacBitmask(int value, int mask) const;
 
 	lcf::rpg::SaveEventExecState _state;
+	/** Decoded command list of a stack frame */
+	struct FrameProgram {
+		std::shared_ptr<const EventProgram> program;
+		/** Commands of the frame the program was attached to */
+		const lcf::rpg::EventCommand* commands = nullptr;
+	};
+
+	/** Decoded command lists of the stack frames, in the same order */
+	std::vector<FrameProgram> _programs;
 	KeyInputState _keyinput;
 	AsyncOp _async_op = {};
 
+	/**
+	 * Requests the assets (pictures, music, maps, ...) used by the next
+	 * commands of the current frame, so they are loaded before the command
+	 * is executed.
+	 */
+	void PrefetchAssets();
+
+	/** Command list and index up to which assets were prefetched */
+	const lcf::rpg::EventCommand* prefetch_list = nullptr;
+	int prefetch_index = 0;
+
 	private:
 		void PushInternal(
 			InterpreterPush push_info,
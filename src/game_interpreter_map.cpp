@@ -60,6 +60,7 @@
 #include "input.h"
 #include "main_data.h"
 #include "output.h"
+#include "pathfinder.h"
 #include "player.h"
 #include "util_macro.h"
 #include "game_interpreter_map.h"
@@ -967,6 +968,11 @@ bool Game_Interpreter_Map::CommandEasyRpgPathfinder(lcf::rpg::EventCommand const
 		}
 	}
 
+	if (!Pathfinder::HasFrameBudget()) {
+		// Other searches used up this frame, retry in the next one
+		return false;
+	}
+
 	chara->CalculateMoveRoute(args);
 
 	return true;
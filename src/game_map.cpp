@@ -22,6 +22,7 @@
 #include <sstream>
 #include <algorithm>
 #include <climits>
+#include <functional>
 #include <numeric>
 #include <unordered_set>
 
@@ -31,6 +32,7 @@
 #include "game_battle.h"
 #include "game_battler.h"
 #include "game_map.h"
+#include "event_program.h"
 #include "game_interpreter_map.h"
 #include "game_switches.h"
 #include "game_player.h"
@@ -46,6 +48,7 @@
 #include "map_data.h"
 #include "main_data.h"
 #include "output.h"
+#include "pathfinder.h"
 #include "util_macro.h"
 #include "game_system.h"
 #include "filefinder.h"
@@ -57,6 +60,7 @@
 #include <lcf/rpg/save.h>
 #include "scene_gameover.h"
 #include "feature.h"
+#include "instrumentation.h"
 
 namespace {
 	// Intended bad value, Game_Map::Init sets them correctly
@@ -75,6 +79,8 @@ namespace {
 	std::vector<Game_Event> events;
 	std::vector<Game_CommonEvent> common_events;
 	std::unique_ptr<Game_Map::Caching::MapCache> map_cache;
+	Game_Map::Caching::EventGrid event_grid;
+	Game_Map::Caching::PassageGrid passage_grid;
 
 	std::unique_ptr<lcf::rpg::Map> map;
 
@@ -98,6 +104,87 @@ namespace Game_Map {
 void SetupCommon();
 }
 
+static const std::vector<int>& GetEventBucket(int x, int y) {
+	if (!event_grid.IsValid()) {
+		event_grid.Rebuild(events, map ? map->width : 0, map ? map->height : 0);
+	}
+	return event_grid.GetBucket(x, y);
+}
+
+// Directions the lower layer tile allows
+static int GetLowerPassage(int tile_index) {
+	if (tile_index >= static_cast<int>(map->lower_layer.size())) {
+		return 0;
+	}
+
+	int tile_raw_id = map->lower_layer[tile_index];
+	int tile_id = 0;
+
+	if (tile_raw_id >= BLOCK_E) {
+		tile_id = tile_raw_id - BLOCK_E;
+		if (tile_id >= static_cast<int>(map_info.lower_tiles.size())) {
+			return 0;
+		}
+		tile_id = map_info.lower_tiles[tile_id] + BLOCK_E_INDEX;
+
+	} else if (tile_raw_id >= BLOCK_D) {
+		tile_id = (tile_raw_id - BLOCK_D) / BLOCK_D_STRIDE + BLOCK_D_INDEX;
+		int autotile_id = (tile_raw_id - BLOCK_D) % BLOCK_D_STRIDE;
+
+		if (((passages_down[tile_id] & Passable::Wall) != 0) && (
+				(autotile_id >= 20 && autotile_id <= 23) ||
+				(autotile_id >= 33 && autotile_id <= 37) ||
+				autotile_id == 42 || autotile_id == 43 ||
+				autotile_id == 45 || autotile_id == 46))
+			return Passable::Down | Passable::Left | Passable::Right | Passable::Up;
+
+	} else if (tile_raw_id >= BLOCK_C) {
+		tile_id = (tile_raw_id - BLOCK_C) / BLOCK_C_STRIDE + BLOCK_C_INDEX;
+
+	} else if (tile_raw_id >= 0) {
+		tile_id = tile_raw_id / BLOCK_B_STRIDE;
+	}
+
+	if (tile_id >= static_cast<int>(passages_down.size())) {
+		return 0;
+	}
+	return passages_down[tile_id] & (Passable::Down | Passable::Left | Passable::Right | Passable::Up);
+}
+
+// Passage bits of the upper layer tile
+static int GetUpperPassage(int tile_index) {
+	if (tile_index >= static_cast<int>(map->upper_layer.size())) {
+		return 0;
+	}
+
+	int tile_id = map->upper_layer[tile_index] - BLOCK_F;
+	if (tile_id < 0 || tile_id >= static_cast<int>(map_info.upper_tiles.size())) {
+		return 0;
+	}
+	tile_id = map_info.upper_tiles[tile_id];
+	return tile_id < static_cast<int>(passages_up.size()) ? passages_up[tile_id] : 0;
+}
+
+static void UpdatePassage(int tile_index) {
+	const int upper = GetUpperPassage(tile_index);
+	// The lower tile only matters when the upper tile is drawn above it
+	const int lower = (upper & Passable::Above) != 0
+		? GetLowerPassage(tile_index)
+		: Passable::Down | Passable::Left | Passable::Right | Passable::Up;
+	passage_grid.Set(tile_index, upper, lower);
+}
+
+static const Game_Map::Caching::PassageGrid& GetPassageGrid() {
+	if (!passage_grid.IsValid()) {
+		const int num_tiles = map ? map->width * map->height : 0;
+		passage_grid.Resize(num_tiles);
+		for (int i = 0; i < num_tiles; ++i) {
+			UpdatePassage(i);
+		}
+	}
+	return passage_grid;
+}
+
 void Game_Map::OnContinueFromBattle() {
 	Main_Data::game_system->BgmPlay(Main_Data::game_system->GetBeforeBattleMusic());
 }
@@ -133,6 +220,8 @@ void Game_Map::InitCommonEvents() {
 
 void Game_Map::Dispose() {
 	events.clear();
+	event_grid.Invalidate();
+	passage_grid.Invalidate();
 	map.reset();
 	map_info = {};
 	panorama = {};
@@ -166,6 +255,7 @@ void Game_Map::Setup(std::unique_ptr<lcf::rpg::Map> map_in) {
 
 	std::iota(map_info.lower_tiles.begin(), map_info.lower_tiles.end(), 0);
 	std::iota(map_info.upper_tiles.begin(), map_info.upper_tiles.end(), 0);
+	passage_grid.Invalidate();
 
 	// Save allowed
 	const auto* current_info = &GetMapInfo();
@@ -226,6 +316,7 @@ void Game_Map::SetupFromSave(
 	map = std::move(map_in);
 	map_info = std::move(save_map);
 	panorama = std::move(save_pan);
+	passage_grid.Invalidate();
 
 	SetupCommon();
 
@@ -285,6 +376,9 @@ void Game_Map::SetupFromSave(
 	map_info.events.clear();
 	interpreter->Clear();
 
+	// The save data bypasses the position setters
+	event_grid.Invalidate();
+
 	GetVehicle(Game_Vehicle::Boat)->SetSaveData(std::move(save_boat));
 	GetVehicle(Game_Vehicle::Ship)->SetSaveData(std::move(save_ship));
 	GetVehicle(Game_Vehicle::Airship)->SetSaveData(std::move(save_airship));
@@ -385,6 +479,7 @@ void Game_Map::SetupCommon() {
 	}
 
 	map_cache->Clear();
+	EventProgram::ClearShared();
 
 	CreateMapEvents();
 }
@@ -395,6 +490,7 @@ void Game_Map::CreateMapEvents() {
 		events.emplace_back(GetMapId(), &ev);
 		AddEventToCache(ev);
 	}
+	event_grid.Invalidate();
 }
 
 void Game_Map::AddEventToCache(const lcf::rpg::Event& ev) {
@@ -433,6 +529,62 @@ void Game_Map::Caching::MapCache::Clear() {
 	for (int i = 0; i < static_cast<int>(ObservedVarOps_END); i++) {
 		refresh_targets_by_varid[i].clear();
 	}
+	dirty_event_ids.clear();
+	dirty_flags.clear();
+}
+
+std::vector<int> Game_Map::Caching::MapCache::TakeDirtyEvents() {
+	std::vector<int> ids;
+	ids.swap(dirty_event_ids);
+
+	for (int id: ids) {
+		dirty_flags[id] = false;
+	}
+	std::sort(ids.begin(), ids.end());
+	return ids;
+}
+
+void Game_Map::Caching::EventGrid::Rebuild(const std::vector<Game_Event>& events, int width, int height) {
+	this->width = width;
+	this->height = height;
+	buckets_x = (width + (1 << bucket_shift) - 1) >> bucket_shift;
+	int buckets_y = (height + (1 << bucket_shift) - 1) >> bucket_shift;
+
+	for (auto& bucket: buckets) {
+		bucket.clear();
+	}
+	// One more for all events outside of the map
+	buckets.resize(buckets_x * buckets_y + 1);
+
+	for (int i = 0; i < static_cast<int>(events.size()); ++i) {
+		buckets[GetBucketIndex(events[i].GetX(), events[i].GetY())].push_back(i);
+	}
+	valid = true;
+}
+
+void Game_Map::Caching::EventGrid::Move(int index, int old_x, int old_y, int new_x, int new_y) {
+	int from = GetBucketIndex(old_x, old_y);
+	int to = GetBucketIndex(new_x, new_y);
+	if (from == to) {
+		return;
+	}
+
+	auto& old_bucket = buckets[from];
+	auto it = std::lower_bound(old_bucket.begin(), old_bucket.end(), index);
+	if (it == old_bucket.end() || *it != index) {
+		// Out of sync, rebuild on the next lookup
+		valid = false;
+		return;
+	}
+	old_bucket.erase(it);
+
+	auto& new_bucket = buckets[to];
+	new_bucket.insert(std::lower_bound(new_bucket.begin(), new_bucket.end(), index), index);
+}
+
+void Game_Map::Caching::PassageGrid::Resize(int num_tiles) {
+	tiles.assign(num_tiles, 0);
+	valid = true;
 }
 
 bool Game_Map::CloneMapEvent(int src_map_id, int src_event_id, int target_x, int target_y, int target_event_id, std::string_view target_name) {
@@ -491,8 +643,10 @@ bool Game_Map::CloneMapEvent(int src_map_id, int src_event_id, int target_x, int
 		}), std::move(game_event));
 
 	UpdateUnderlyingEventReferences();
+	event_grid.Invalidate();
 
 	AddEventToCache(new_event);
+	EventProgram::DropShared(EventProgram::Owner::MapEvent, new_event.ID);
 
 	Scene_Map* scene = (Scene_Map*)Scene::Find(Scene::Map).get();
 	if (scene) {
@@ -515,6 +669,7 @@ bool Game_Map::DestroyMapEvent(const int event_id, bool from_clone) {
 
 	// Remove event from cache
 	RemoveEventFromCache(*event);
+	EventProgram::DropShared(EventProgram::Owner::MapEvent, event_id);
 
 	// Remove event from events vector
 	for (auto it = events.begin(); it != events.end(); ++it) {
@@ -523,6 +678,7 @@ bool Game_Map::DestroyMapEvent(const int event_id, bool from_clone) {
 			break;
 		}
 	}
+	event_grid.Invalidate();
 
 	// Remove event from map
 	for (auto it = map->events.begin(); it != map->events.end(); ++it) {
@@ -641,9 +797,22 @@ std::vector<uint8_t> Game_Map::GetTilesLayer(int layer) {
 }
 
 void Game_Map::Refresh() {
+	// Events marked during the refresh are handled by the next one
+	auto dirty_events = map_cache->TakeDirtyEvents();
+
 	if (GetMapId() > 0) {
-		for (Game_Event& ev : events) {
-			ev.RefreshPage();
+		if (need_refresh) {
+			for (Game_Event& ev : events) {
+				ev.RefreshPage();
+			}
+		} else {
+			// Only events observing a changed switch or variable.
+			// Iterates all events to keep the order of a full refresh.
+			for (Game_Event& ev : events) {
+				if (std::binary_search(dirty_events.begin(), dirty_events.end(), ev.GetId())) {
+					ev.RefreshPage();
+				}
+			}
 		}
 	}
 
@@ -886,19 +1055,22 @@ bool Game_Map::CheckOrMakeWayEx(const Game_Character& self,
 	}
 	if (vehicle_type != Game_Vehicle::Airship && check_events_and_vehicles) {
 		// Check for collision with events on the target tile.
-		if (ignore_some_events_by_id.empty()) {
-			for (auto& other: GetEvents()) {
-				if (CheckOrMakeCollideEvent(other)) {
-					return false;
-				}
+		// Making way can move events, so the bucket is looked up again for every event.
+		for (int next = 0;;) {
+			auto& bucket = GetEventBucket(to_x, to_y);
+			auto it = std::lower_bound(bucket.begin(), bucket.end(), next);
+			if (it == bucket.end()) {
+				break;
 			}
-		} else {
-			for (auto& other: GetEvents()) {
-				if (std::find(ignore_some_events_by_id.begin(), ignore_some_events_by_id.end(), other.GetId()) != ignore_some_events_by_id.end())
-					continue;
-				if (CheckOrMakeCollideEvent(other)) {
-					return false;
-				}
+			next = *it + 1;
+
+			auto& other = events[*it];
+			if (!ignore_some_events_by_id.empty()
+					&& std::find(ignore_some_events_by_id.begin(), ignore_some_events_by_id.end(), other.GetId()) != ignore_some_events_by_id.end()) {
+				continue;
+			}
+			if (CheckOrMakeCollideEvent(other)) {
+				return false;
 			}
 		}
 
@@ -956,7 +1128,8 @@ bool Game_Map::CanLandAirship(int x, int y) {
 		return false;
 	}
 
-	for (auto& ev: events) {
+	for (int i: GetEventBucket(x, y)) {
+		auto& ev = events[i];
 		if (ev.IsInPosition(x, y)
 				&& ev.IsActive()
 				&& ev.GetActivePage() != nullptr) {
@@ -994,7 +1167,8 @@ bool Game_Map::CanDisembarkShip(Game_Player& player, int x, int y) {
 		return false;
 	}
 
-	for (auto& ev: GetEvents()) {
+	for (int i: GetEventBucket(x, y)) {
+		auto& ev = events[i];
 		if (ev.IsInPosition(x, y)
 			&& ev.GetLayer() == lcf::rpg::EventPage::Layers_same
 			&& ev.IsActive()
@@ -1009,32 +1183,7 @@ bool Game_Map::CanDisembarkShip(Game_Player& player, int x, int y) {
 }
 
 bool Game_Map::IsPassableLowerTile(int bit, int tile_index) {
-	int tile_raw_id = map->lower_layer[tile_index];
-	int tile_id = 0;
-
-	if (tile_raw_id >= BLOCK_E) {
-		tile_id = tile_raw_id - BLOCK_E;
-		tile_id = map_info.lower_tiles[tile_id] + BLOCK_E_INDEX;
-
-	} else if (tile_raw_id >= BLOCK_D) {
-		tile_id = (tile_raw_id - BLOCK_D) / BLOCK_D_STRIDE + BLOCK_D_INDEX;
-		int autotile_id = (tile_raw_id - BLOCK_D) % BLOCK_D_STRIDE;
-
-		if (((passages_down[tile_id] & Passable::Wall) != 0) && (
-				(autotile_id >= 20 && autotile_id <= 23) ||
-				(autotile_id >= 33 && autotile_id <= 37) ||
-				autotile_id == 42 || autotile_id == 43 ||
-				autotile_id == 45 || autotile_id == 46))
-			return true;
-
-	} else if (tile_raw_id >= BLOCK_C) {
-		tile_id = (tile_raw_id - BLOCK_C) / BLOCK_C_STRIDE + BLOCK_C_INDEX;
-
-	} else if (map->lower_layer[tile_index] < BLOCK_C) {
-		tile_id = tile_raw_id / BLOCK_B_STRIDE;
-	}
-
-	return (passages_down[tile_id] & bit) != 0;
+	return (GetLowerPassage(tile_index) & bit) != 0;
 }
 
 bool Game_Map::IsPassableTile(
@@ -1072,7 +1221,8 @@ bool Game_Map::IsPassableTile(
 
 		// Highest ID event with layer=below, not through, and a tile graphic wins.
 		int event_tile_id = 0;
-		for (auto& ev: events) {
+		for (int i: GetEventBucket(x, y)) {
+			auto& ev = events[i];
 			if (self == &ev) {
 				continue;
 			}
@@ -1104,22 +1254,12 @@ bool Game_Map::IsPassableTile(
 
 	if (check_map_geometry) {
 		int tile_index = x + y * GetTilesX();
-		int tile_id = map->upper_layer[tile_index] - BLOCK_F;
-		tile_id = map_info.upper_tiles[tile_id];
 
 		if (vehicle_type == Game_Vehicle::Boat || vehicle_type == Game_Vehicle::Ship) {
-			if ((passages_up[tile_id] & Passable::Above) == 0)
-				return false;
-			return true;
+			return (GetUpperPassage(tile_index) & Passable::Above) != 0;
 		}
 
-		if ((passages_up[tile_id] & bit) == 0)
-			return false;
-
-		if ((passages_up[tile_id] & Passable::Above) == 0)
-			return true;
-
-		return IsPassableLowerTile(bit, tile_index);
+		return GetPassageGrid().IsPassable(tile_index, bit);
 	} else {
 		return true;
 	}
@@ -1186,9 +1326,9 @@ int Game_Map::GetTerrainTag(int x, int y) {
 }
 
 Game_Event* Game_Map::GetEventAt(int x, int y, bool require_active) {
-	auto& events = GetEvents();
-	for (auto iter = events.rbegin(); iter != events.rend(); ++iter) {
-		auto& ev = *iter;
+	auto& bucket = GetEventBucket(x, y);
+	for (auto iter = bucket.rbegin(); iter != bucket.rend(); ++iter) {
+		auto& ev = events[*iter];
 		if (ev.IsInPosition(x, y) && (!require_active || ev.IsActive())) {
 			return &ev;
 		}
@@ -1196,6 +1336,30 @@ Game_Event* Game_Map::GetEventAt(int x, int y, bool require_active) {
 	return nullptr;
 }
 
+std::vector<Game_Event*> Game_Map::GetEventsXY(int x, int y) {
+	std::vector<Game_Event*> result;
+	for (int i: GetEventBucket(x, y)) {
+		if (events[i].IsInPosition(x, y)) {
+			result.push_back(&events[i]);
+		}
+	}
+	return result;
+}
+
+void Game_Map::OnEventMoved(const Game_Event& ev, int old_x, int old_y) {
+	if (!event_grid.IsValid()) {
+		return;
+	}
+
+	// Events which are not (yet) part of the map are not indexed
+	const auto* first = events.data();
+	const auto* last = first + events.size();
+	if (std::less<>()(&ev, first) || !std::less<>()(&ev, last)) {
+		return;
+	}
+	event_grid.Move(static_cast<int>(&ev - first), old_x, old_y, ev.GetX(), ev.GetY());
+}
+
 bool Game_Map::LoopHorizontal() {
 	return map->scroll_type == lcf::rpg::Map::ScrollType_horizontal || map->scroll_type == lcf::rpg::Map::ScrollType_both;
 }
@@ -1255,6 +1419,8 @@ int Game_Map::CheckEvent(int x, int y) {
 }
 
 void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
+	Instrumentation::ZoneScope zone(Instrumentation::Zone::MapUpdate);
+
 	if (GetNeedRefresh()) {
 		Refresh();
 	}
@@ -1262,6 +1428,7 @@ void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
 	if (!actx.IsActive()) {
 		//If not resuming from async op ...
 		UpdateProcessedFlags(is_preupdate);
+		Pathfinder::ResetFrameBudget();
 	}
 
 	if (!actx.IsActive() || actx.IsParallelCommonEvent()) {
@@ -1783,7 +1950,7 @@ bool Game_Map::GetNeedRefresh() {
 		return false;
 	}
 
-	return need_refresh;
+	return need_refresh || (map_cache && map_cache->HasDirtyEvents());
 }
 
 void Game_Map::SetNeedRefresh(bool refresh) {
@@ -1793,15 +1960,13 @@ void Game_Map::SetNeedRefresh(bool refresh) {
 void Game_Map::SetNeedRefreshForSwitchChange(int switch_id) {
 	if (need_refresh)
 		return;
-	if (map_cache->GetNeedRefresh<Caching::ObservedVarOps::SwitchSet>(switch_id))
-		SetNeedRefresh(true);
+	map_cache->MarkRefreshTargets<Caching::ObservedVarOps::SwitchSet>(switch_id);
 }
 
 void Game_Map::SetNeedRefreshForVarChange(int var_id) {
 	if (need_refresh)
 		return;
-	if (map_cache->GetNeedRefresh<Caching::ObservedVarOps::VarSet>(var_id))
-		SetNeedRefresh(true);
+	map_cache->MarkRefreshTargets<Caching::ObservedVarOps::VarSet>(var_id);
 }
 
 void Game_Map::SetNeedRefreshForSwitchChange(std::initializer_list<int> switch_ids) {
@@ -1871,6 +2036,8 @@ void Game_Map::SetChipset(int id) {
 	}
 	map_info.chipset_id = id;
 
+	passage_grid.Invalidate();
+
 	if (!ReloadChipset()) {
 		Output::Warning("SetChipset: Invalid chipset ID {}", map_info.chipset_id);
 	} else {
@@ -1970,17 +2137,29 @@ static int DoSubstitute(std::vector<uint8_t>& tiles, int old_id, int new_id) {
 }
 
 int Game_Map::SubstituteDown(int old_id, int new_id) {
-	return DoSubstitute(map_info.lower_tiles, old_id, new_id);
+	int num_subst = DoSubstitute(map_info.lower_tiles, old_id, new_id);
+	if (num_subst > 0) {
+		passage_grid.Invalidate();
+	}
+	return num_subst;
 }
 
 int Game_Map::SubstituteUp(int old_id, int new_id) {
-	return DoSubstitute(map_info.upper_tiles, old_id, new_id);
+	int num_subst = DoSubstitute(map_info.upper_tiles, old_id, new_id);
+	if (num_subst > 0) {
+		passage_grid.Invalidate();
+	}
+	return num_subst;
 }
 
 void Game_Map::ReplaceTileAt(int x, int y, int new_id, int layer) {
 	auto pos = x + y * map->width;
 	auto& layer_vec = layer >= 1 ? map->upper_layer : map->lower_layer;
 	layer_vec[pos] = static_cast<int16_t>(new_id);
+
+	if (passage_grid.IsValid()) {
+		UpdatePassage(pos);
+	}
 }
 
 int Game_Map::GetTileIdAt(int x, int y, int layer, bool chip_id_or_index) {
@@ -176,7 +176,10 @@ namespace Game_Map {
 	void PlayBgm();
 
 	/**
-	 * Refreshes the map.
+	 * Refreshes the pages of the map events.
+	 * After SetNeedRefresh all events are refreshed, otherwise only the
+	 * events marked by SetNeedRefreshForSwitchChange and
+	 * SetNeedRefreshForVarChange.
 	 */
 	void Refresh();
 
@@ -528,7 +531,7 @@ namespace Game_Map {
 	void SetPositionY(int new_position_y, bool reset_panorama = true);
 
 	/**
-	 * @return need refresh flag.
+	 * @return whether any event page must be refreshed.
 	 */
 	bool GetNeedRefresh();
 
@@ -540,7 +543,8 @@ namespace Game_Map {
 	Game_Interpreter_Map& GetInterpreter();
 
 	/**
-	 * Sets the need refresh flag.
+	 * Sets the need refresh flag. When set the next Refresh
+	 * refreshes the pages of all events.
 	 *
 	 * @param refresh need refresh flag.
 	 */
@@ -607,6 +611,25 @@ namespace Game_Map {
 	 */
 	Game_Event* GetEventAt(int x, int y, bool require_active);
 
+	/**
+	 * Looks up the events at a tile in the spatial index of the map.
+	 *
+	 * @param x x position on the map
+	 * @param y y position on the map
+	 * @return the events at (x,y) in ascending id order
+	 */
+	std::vector<Game_Event*> GetEventsXY(int x, int y);
+
+	/**
+	 * Updates the spatial index after an event changed its position.
+	 * Called by Game_Character::SetX and SetY.
+	 *
+	 * @param ev the moved event
+	 * @param old_x previous x position
+	 * @param old_y previous y position
+	 */
+	void OnEventMoved(const Game_Event& ev, int old_x, int old_y);
+
 	bool LoopHorizontal();
 	bool LoopVertical();
 
@@ -697,6 +720,20 @@ namespace Game_Map {
 
 	void UpdateProcessedFlags(bool is_preupdate);
 	bool UpdateCommonEvents(MapUpdateAsyncContext& actx);
+
+	/**
+	 * Updates the parallel interpreters and the movement of all map events
+	 * in ascending ID order.
+	 *
+	 * The updates cannot run concurrently or be planned ahead: an update can
+	 * draw random numbers, push other events out of the way (MakeWay), change
+	 * pages through a map refresh and change switches and variables read by
+	 * the following events. bench/map_events.cpp compares the read-only
+	 * passability pre-check with the cost of handing it to a worker thread.
+	 *
+	 * @param actx async context, resumes at the suspended event when active
+	 * @return false when an event suspended due to an async operation
+	 */
 	bool UpdateMapEvents(MapUpdateAsyncContext& actx);
 	bool UpdateMessage(MapUpdateAsyncContext& actx);
 	bool UpdateForegroundEvents(MapUpdateAsyncContext& actx);
@@ -718,6 +755,8 @@ namespace Game_Map {
 			void AddEvent(const lcf::rpg::Event& ev);
 			void RemoveEvent(const lcf::rpg::Event& ev);
 
+			const std::vector<int>& GetEventIds() const;
+
 		private:
 			std::vector<int> event_ids;
 		};
@@ -739,12 +778,120 @@ namespace Game_Map {
 			template <ObservedVarOps Op>
 			void RemoveEventAsRefreshTarget(int var_id, const lcf::rpg::Event& ev);
 
+			/**
+			 * Marks all events which observe the switch or variable
+			 * for a page refresh. An event is only recorded once until
+			 * the marks are taken.
+			 *
+			 * @param var_id ID of the changed switch or variable
+			 * @return whether any event observes it
+			 */
 			template <ObservedVarOps Op>
-			bool GetNeedRefresh(int var_id);
+			bool MarkRefreshTargets(int var_id);
+
+			/** @return whether any event is marked for a page refresh */
+			bool HasDirtyEvents() const;
+
+			/**
+			 * Removes all marks.
+			 *
+			 * @return IDs of the marked events, sorted and without duplicates
+			 */
+			std::vector<int> TakeDirtyEvents();
 
 			void Clear();
 		private:
 			MapEventCacheData_t refresh_targets_by_varid[ObservedVarOps_END];
+			std::vector<int> dirty_event_ids;
+			/** Indexed by event ID, whether the ID is in dirty_event_ids */
+			std::vector<bool> dirty_flags;
+		};
+
+		/**
+		 * Spatial index of the map events.
+		 * The map is split into square buckets of tiles which hold the
+		 * indices into the events vector in ascending order. Events outside
+		 * of the map share one extra bucket.
+		 */
+		class EventGrid {
+		public:
+			/** Marks the index as outdated, it is rebuilt on the next lookup */
+			void Invalidate();
+
+			/** @return whether the index matches the events */
+			bool IsValid() const;
+
+			/**
+			 * Indexes all events.
+			 *
+			 * @param events events of the map
+			 * @param width map width in tiles
+			 * @param height map height in tiles
+			 */
+			void Rebuild(const std::vector<Game_Event>& events, int width, int height);
+
+			/**
+			 * Moves an event to the bucket of its new position.
+			 *
+			 * @param index index of the event in the events vector
+			 */
+			void Move(int index, int old_x, int old_y, int new_x, int new_y);
+
+			/** @return indices of the events which may be at (x,y) in ascending order */
+			const std::vector<int>& GetBucket(int x, int y) const;
+
+		private:
+			int GetBucketIndex(int x, int y) const;
+
+			static constexpr int bucket_shift = 3;
+
+			std::vector<std::vector<int>> buckets;
+			int width = 0;
+			int height = 0;
+			int buckets_x = 0;
+			bool valid = false;
+		};
+
+		/**
+		 * Passability of the map geometry, one byte per tile.
+		 * The high nibble holds the directions (Passable bits) the upper
+		 * layer tile allows and the low nibble the directions of the
+		 * lower layer tile. When the upper tile is not drawn above the
+		 * lower one it decides alone and all lower directions are set.
+		 */
+		class PassageGrid {
+		public:
+			/** Marks the grid as outdated, it is rebuilt on the next lookup */
+			void Invalidate();
+
+			/** @return whether the grid matches the map */
+			bool IsValid() const;
+
+			/**
+			 * Resizes the grid and marks it valid. All tiles must be
+			 * written with Set afterwards.
+			 *
+			 * @param num_tiles number of tiles of the map
+			 */
+			void Resize(int num_tiles);
+
+			/**
+			 * @param tile_index the tile index
+			 * @param upper directions of the upper layer tile
+			 * @param lower directions of the lower layer tile
+			 */
+			void Set(int tile_index, int upper, int lower);
+
+			/**
+			 * @param tile_index the tile index
+			 * @param bit which direction bits to check
+			 * @return whether both layers allow any of the directions
+			 */
+			bool IsPassable(int tile_index, int bit) const;
+
+		private:
+			std::vector<uint8_t> tiles;
+			bool valid = false;
 		};
 	}
 
@@ -914,11 +1061,69 @@ inline void Game_Map::Caching::MapCache::RemoveEventAsRefreshTarget(int var_id,
 }
 
 template <Game_Map::Caching::ObservedVarOps Op>
-inline bool Game_Map::Caching::MapCache::GetNeedRefresh(int var_id) {
+inline bool Game_Map::Caching::MapCache::MarkRefreshTargets(int var_id) {
 	static_assert(static_cast<int>(Op) >= 0 && Op < ObservedVarOps_END);
 
 	auto& events_cache = refresh_targets_by_varid[static_cast<int>(Op)];
-	return events_cache.find(var_id) != events_cache.end();
+	auto it = events_cache.find(var_id);
+	if (it == events_cache.end()) {
+		return false;
+	}
+
+	for (int id: it->second.GetEventIds()) {
+		if (id >= static_cast<int>(dirty_flags.size())) {
+			dirty_flags.resize(id + 1);
+		}
+		if (!dirty_flags[id]) {
+			dirty_flags[id] = true;
+			dirty_event_ids.push_back(id);
+		}
+	}
+	return true;
+}
+
+inline bool Game_Map::Caching::MapCache::HasDirtyEvents() const {
+	return !dirty_event_ids.empty();
+}
+
+inline const std::vector<int>& Game_Map::Caching::MapEventCache::GetEventIds() const {
+	return event_ids;
+}
+
+inline void Game_Map::Caching::EventGrid::Invalidate() {
+	valid = false;
+}
+
+inline bool Game_Map::Caching::EventGrid::IsValid() const {
+	return valid;
+}
+
+inline int Game_Map::Caching::EventGrid::GetBucketIndex(int x, int y) const {
+	if (x < 0 || y < 0 || x >= width || y >= height) {
+		return static_cast<int>(buckets.size()) - 1;
+	}
+	return (y >> bucket_shift) * buckets_x + (x >> bucket_shift);
+}
+
+inline const std::vector<int>& Game_Map::Caching::EventGrid::GetBucket(int x, int y) const {
+	return buckets[GetBucketIndex(x, y)];
+}
+
+inline void Game_Map::Caching::PassageGrid::Invalidate() {
+	valid = false;
+}
+
+inline bool Game_Map::Caching::PassageGrid::IsValid() const {
+	return valid;
+}
+
+inline void Game_Map::Caching::PassageGrid::Set(int tile_index, int upper, int lower) {
+	tiles[tile_index] = static_cast<uint8_t>(((upper & 0x0F) << 4) | (lower & 0x0F));
+}
+
+inline bool Game_Map::Caching::PassageGrid::IsPassable(int tile_index, int bit) const {
+	const int passage = tiles[tile_index];
+	return ((passage >> 4) & bit) != 0 && (passage & bit) != 0;
 }
 
 #endif
@@ -453,16 +453,14 @@ bool Game_Player::CheckEventTriggerHere(TriggerSet triggers, bool triggered_by_d
 
 	bool result = false;
 
-	for (auto& ev: Game_Map::GetEvents()) {
-		const auto trigger = ev.GetTrigger();
-		if (ev.IsActive()
-				&& ev.GetX() == GetX()
-				&& ev.GetY() == GetY()
-				&& ev.GetLayer() != lcf::rpg::EventPage::Layers_same
+	for (auto* ev: Game_Map::GetEventsXY(GetX(), GetY())) {
+		const auto trigger = ev->GetTrigger();
+		if (ev->IsActive()
+				&& ev->GetLayer() != lcf::rpg::EventPage::Layers_same
 				&& trigger.has_value()
 				&& triggers[*trigger]) {
 			SetEncounterCalling(false);
-			result |= ev.ScheduleForegroundExecution(triggered_by_decision_key, face_player);
+			result |= ev->ScheduleForegroundExecution(triggered_by_decision_key, face_player);
 		}
 	}
 	return result;
@@ -474,16 +472,14 @@ bool Game_Player::CheckEventTriggerThere(TriggerSet triggers, int x, int y, bool
 	}
 	bool result = false;
 
-	for (auto& ev : Game_Map::GetEvents()) {
-		const auto trigger = ev.GetTrigger();
-		if (ev.IsActive()
-				&& ev.GetX() == x
-				&& ev.GetY() == y
-				&& ev.GetLayer() == lcf::rpg::EventPage::Layers_same
+	for (auto* ev: Game_Map::GetEventsXY(x, y)) {
+		const auto trigger = ev->GetTrigger();
+		if (ev->IsActive()
+				&& ev->GetLayer() == lcf::rpg::EventPage::Layers_same
 				&& trigger.has_value()
 				&& triggers[*trigger]) {
 			SetEncounterCalling(false);
-			result |= ev.ScheduleForegroundExecution(triggered_by_decision_key, face_player);
+			result |= ev->ScheduleForegroundExecution(triggered_by_decision_key, face_player);
 		}
 	}
 	return result;
@@ -27,6 +27,7 @@
 #include "game_strings.h"
 #include "game_switches.h"
 #include "game_variables.h"
+#include "lru_cache.h"
 #include "output.h"
 #include "player.h"
 #include "utils.h"
@@ -35,6 +36,27 @@
 #include "json_helper.h"
 #endif
 
+namespace {
+	// Compiled regular expressions by their pattern
+	constexpr size_t regex_cache_budget = 256 * 1024;
+	// The memory used by a compiled regex is not observable, this is a rough guess
+	constexpr size_t regex_size_estimate = 4 * 1024;
+
+	LruCache<std::wstring, std::wregex> regex_cache(regex_cache_budget);
+
+	const std::wregex& GetRegex(const std::wstring& pattern) {
+		if (auto* regex = regex_cache.Find(pattern)) {
+			return *regex;
+		}
+
+		// Throws on invalid patterns, these are not cached
+		std::wregex regex(pattern);
+
+		regex_cache.Evict([](const std::wregex&) { return true; });
+		return regex_cache.Insert(pattern, std::move(regex), regex_size_estimate + pattern.size() * sizeof(wchar_t));
+	}
+}
+
 void Game_Strings::WarnGet(int id) const {
 	Output::Debug("Invalid read strvar[{}]!", id);
 	--_warnings;
@@ -69,13 +91,13 @@ std::string_view Game_Strings::Cat(Str_Params params, std::string_view string) {
 		return {};
 	}
 
-	auto it = _strings.find(params.string_id);
-	if (it == _strings.end()) {
+	if (params.string_id > static_cast<int>(_strings.size())) {
 		Set(params, string);
 		return Get(params.string_id);
 	}
-	it->second += ToString(string);
-	return it->second;
+	auto& str = _strings[params.string_id - 1];
+	str.append(string.data(), string.size());
+	return str;
 }
 
 int Game_Strings::ToNum(Str_Params params, int var_id, Game_Variables& variables) {
@@ -83,16 +105,16 @@ int Game_Strings::ToNum(Str_Params params, int var_id, Game_Variables& variables
 		return -1;
 	}
 
-	auto it = _strings.find(params.string_id);
-	if (it == _strings.end()) {
+	if (params.string_id > static_cast<int>(_strings.size())) {
 		return 0;
 	}
+	const auto& str = _strings[params.string_id - 1];
 
 	int num;
 	if (params.hex)
-		num = static_cast<int>(std::strtol(it->second.c_str(), nullptr, 16));
+		num = static_cast<int>(std::strtol(str.c_str(), nullptr, 16));
 	else
-		num = static_cast<int>(std::strtol(it->second.c_str(), nullptr, 0));
+		num = static_cast<int>(std::strtol(str.c_str(), nullptr, 0));
 
 	variables.Set(var_id, num);
 
@@ -160,7 +182,7 @@ int Game_Strings::Split(Str_Params params, const std::string& delimiter, int str
 				break;
 			}
 
-			Set(params, std::string(start_copy, iter - start_copy));
+			Set(params, std::string_view(start_copy, iter - start_copy));
 
 			params.string_id++;
 			components++;
@@ -168,19 +190,15 @@ int Game_Strings::Split(Str_Params params, const std::string& delimiter, int str
 	} else {
 		components = 1;
 
-		if (str.find(delimiter) == std::string::npos) {
-			// token not found
-		} else {
-			// This works for UTF-8
-			std::string token;
-			for (auto index = str.find(delimiter); index != std::string::npos; index = str.find(delimiter)) {
-				token = str.substr(0, index);
-				Set(params, token);
-				params.string_id++;
-				components++;
-				str.erase(0, index + delimiter.length());
-			}
+		// This works for UTF-8
+		size_t pos = 0;
+		for (auto index = str.find(delimiter); index != std::string::npos; index = str.find(delimiter, pos)) {
+			Set(params, std::string_view(str).substr(pos, index - pos));
+			params.string_id++;
+			components++;
+			pos = index + delimiter.length();
 		}
+		str.erase(0, pos);
 	}
 
 	// set the remaining string
@@ -318,9 +336,7 @@ std::string_view Game_Strings::ExMatch(Str_Params params, std::string expr, int
 	auto wbase = Utils::ToWideString(base);
 	auto wexpr = Utils::ToWideString(expr);
 
-	std::wregex r(wexpr);
-
-	std::regex_search(wbase, match, r);
+	std::regex_search(wbase, match, GetRegex(wexpr));
 	str_result = Utils::FromWideString(match.str());
 
 	var_result = match.position() + begin;
@@ -373,17 +389,24 @@ const Game_Strings::Strings_t& Game_Strings::RangeOp(Str_Params params, int stri
 std::string Game_Strings::PrependMin(std::string_view string, int min_size, char c) {
 	int len = Utils::UTF8Length(string);
 
+	std::string ret;
 	if (min_size < 0) {
 		// Left adjust
 		min_size = abs(min_size);
 		if (len < min_size) {
 			int s = min_size - len;
-			return ToString(string) + std::string(s, c);
+			ret.reserve(string.size() + s);
+			ret.append(string.data(), string.size());
+			ret.append(s, c);
+			return ret;
 		}
 	} else if (len < min_size) {
 		// Right adjust
 		int s = min_size - len;
-		return std::string(s, c) + ToString(string);
+		ret.reserve(string.size() + s);
+		ret.append(s, c);
+		ret.append(string.data(), string.size());
+		return ret;
 	}
 	return ToString(string);
 }
@@ -432,7 +455,12 @@ std::string Game_Strings::Insert(std::string_view source, std::string_view what,
 	// Points at insertion location
 	auto ret = Utils::UTF8Skip(iter, end, where);
 
-	return std::string(source.data(), ret.next) + ToString(what) + std::string(ret.next, end);
+	std::string result;
+	result.reserve(source.size() + what.size());
+	result.append(source.data(), ret.next);
+	result.append(what.data(), what.size());
+	result.append(ret.next, end);
+	return result;
 }
 
 std::string Game_Strings::Erase(std::string_view source, int begin, int length) {
@@ -455,9 +483,11 @@ std::string Game_Strings::Erase(std::string_view source, int begin, int length)
 	// Points at end of deletion
 	auto right = Utils::UTF8Skip(left.next, end, length);
 
-	std::string ret = std::string(source.data(), left.next);
+	std::string ret;
+	ret.reserve(source.size());
+	ret.append(source.data(), left.next);
 	if (right.next != nullptr) {
-		ret += std::string(right.next, end);
+		ret.append(right.next, end);
 	}
 
 	return ret;
@@ -470,9 +500,7 @@ std::string Game_Strings::RegExReplace(std::string_view str, std::string_view se
 	auto wsearch = Utils::ToWideString(search);
 	auto wreplace = Utils::ToWideString(replace);
 
-	std::wregex rexp(wsearch);
-
-	auto result = std::regex_replace(wstr, rexp, wreplace, flags);
+	auto result = std::regex_replace(wstr, GetRegex(wsearch), wreplace, flags);
 
 	return Utils::FromWideString(result);
 }
@@ -522,16 +550,7 @@ std::optional<std::string> Game_Strings::ManiacsCommandInserterHex(char ch, cons
 };
 
 int Game_Strings::GetSizeWithLimit() {
-	if (_size < 0) {
-		_size = 0;
-		for (auto& [index, value] : _strings) {
-			assert(index > 0);
-			if (index > _size) {
-				_size = index;
-			}
-		}
-	}
-	return std::max(_size, static_cast<int>(lcf::Data::maniac_string_variables.size()));
+	return std::max(static_cast<int>(_strings.size()), static_cast<int>(lcf::Data::maniac_string_variables.size()));
 }
 
 std::string_view Game_Strings::GetName(int id) const {
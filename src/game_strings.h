@@ -19,6 +19,8 @@
 #include "system.h"
 #include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <lcf/data.h>
 #include "compiler.h"
 #include "game_variables.h"
@@ -47,7 +49,8 @@
  */
 class Game_Strings {
 public:
-	using Strings_t = std::unordered_map<int, std::string>;
+	/** String of ID n is at index n - 1, unset strings are empty */
+	using Strings_t = std::vector<std::string>;
 
 	// currently only warns when ID <= 0
 	static constexpr int max_warnings = 10;
@@ -110,12 +113,16 @@ public:
 
 private:
 	void Set(Str_Params params, std::string_view string);
+	void Store(int id, std::string_view string);
 	bool ShouldWarn(int id) const;
 	void WarnGet(int id) const;
 
+	/**
+	 * Dense table of all strings. The slots are only grown and keep their
+	 * buffers, so writing a string of a similar length does not allocate.
+	 */
 	Strings_t _strings;
 	mutable int _warnings = max_warnings;
-	int _size = -1;
 
 #ifdef HAVE_NLOHMANN_JSON
 	std::unordered_map<int, nlohmann::ordered_json> _json_cache;
@@ -129,23 +136,11 @@ inline void Game_Strings::Set(Str_Params params, std::string_view string) {
 		return;
 	}
 
-	std::string ins_string = ToString(string);
 	if (params.extract) {
-		ins_string = Extract(ins_string, params.hex);
-	}
-
-	auto it = _strings.find(params.string_id);
-	if (it == _strings.end()) {
-		if (ins_string.empty()) {
-			return;
-		} else {
-			_strings[params.string_id] = ins_string;
-			if (params.string_id > _size) {
-				_size = params.string_id;
-			}
-		}
+		// Extracting can read other strings, it must finish before the slot is written
+		Store(params.string_id, Extract(string, params.hex));
 	} else {
-		it->second = ins_string;
+		Store(params.string_id, string);
 	}
 
 #ifdef HAVE_NLOHMANN_JSON
@@ -153,9 +148,23 @@ inline void Game_Strings::Set(Str_Params params, std::string_view string) {
 #endif
 }
 
+inline void Game_Strings::Store(int id, std::string_view string) {
+	if (id > static_cast<int>(_strings.size())) {
+		if (string.empty()) {
+			return;
+		}
+		// Growing moves the slots, the string could point into one of them
+		std::string copy = ToString(string);
+		_strings.resize(id);
+		_strings[id - 1] = std::move(copy);
+		return;
+	}
+
+	_strings[id - 1].assign(string.data(), string.size());
+}
+
 inline void Game_Strings::SetData(Strings_t s) {
 	_strings = std::move(s);
-	_size = -1;
 
 #ifdef HAVE_NLOHMANN_JSON
 	_json_cache.clear();
@@ -163,15 +172,11 @@ inline void Game_Strings::SetData(Strings_t s) {
 }
 
 inline void Game_Strings::SetData(const std::vector<lcf::DBString>& s) {
-	int i = 1;
-	for (const auto& string: s) {
-		if (!s.empty()) {
-			_strings[i] = ToString(string);
-		}
-		++i;
+	if (s.size() > _strings.size()) {
+		_strings.resize(s.size());
 	}
-	if ((i - 1) > _size) {
-		_size = i - 1;
+	for (size_t i = 0; i < s.size(); ++i) {
+		_strings[i] = ToString(s[i]);
 	}
 #ifdef HAVE_NLOHMANN_JSON
 	_json_cache.clear();
@@ -184,13 +189,10 @@ inline const Game_Strings::Strings_t& Game_Strings::GetData() const {
 
 inline std::vector<lcf::DBString> Game_Strings::GetLcfData() const {
 	std::vector<lcf::DBString> lcf_data;
+	lcf_data.reserve(_strings.size());
 
-	for (auto& [index, value]: _strings) {
-		assert(index > 0);
-		if (index >= static_cast<int>(lcf_data.size())) {
-			lcf_data.resize(index + 1);
-		}
-		lcf_data[index - 1] = lcf::DBString(value);
+	for (const auto& value: _strings) {
+		lcf_data.emplace_back(value);
 	}
 
 	return lcf_data;
@@ -204,11 +206,10 @@ inline std::string_view Game_Strings::Get(int id) const {
 	if (EP_UNLIKELY(ShouldWarn(id))) {
 		WarnGet(id);
 	}
-	auto it = _strings.find(id);
-	if (it == _strings.end()) {
+	if (id <= 0 || id > static_cast<int>(_strings.size())) {
 		return {};
 	}
-	return it->second;
+	return _strings[id - 1];
 }
 
 inline std::string_view Game_Strings::GetIndirect(int id, const Game_Variables& variables) const {
@@ -26,6 +26,57 @@ void Game_Switches::WarnGet(int variable_id) const {
 	--_warnings;
 }
 
+void Game_Switches::SetData(const Switches_t& s) {
+	_words.assign((s.size() + word_bits - 1) / word_bits, 0);
+	_size = static_cast<int>(s.size());
+	for (int i = 0; i < _size; ++i) {
+		if (s[i]) {
+			_words[i / word_bits] |= Word(1) << (i % word_bits);
+		}
+	}
+}
+
+Game_Switches::Switches_t Game_Switches::GetData() const {
+	Switches_t s(_size);
+	for (int i = 0; i < _size; ++i) {
+		s[i] = GetBit(i);
+	}
+	return s;
+}
+
+void Game_Switches::Resize(int size) {
+	if (size > _size) {
+		_words.resize((size + word_bits - 1) / word_bits, 0);
+		_size = size;
+	}
+}
+
+template <typename F>
+void Game_Switches::WriteRange(int first_id, int last_id, F&& op) {
+	// op(word, mask) modifies the bits of the word selected by the mask
+	const int begin = std::max(0, first_id - 1);
+	const int end = last_id;
+	if (begin >= end) {
+		return;
+	}
+
+	const int first_word = begin / word_bits;
+	const int last_word = (end - 1) / word_bits;
+	const Word first_mask = ~Word(0) << (begin % word_bits);
+	const Word last_mask = ~Word(0) >> (word_bits - 1 - (end - 1) % word_bits);
+
+	if (first_word == last_word) {
+		op(_words[first_word], first_mask & last_mask);
+		return;
+	}
+
+	op(_words[first_word], first_mask);
+	for (int w = first_word + 1; w < last_word; ++w) {
+		op(_words[w], ~Word(0));
+	}
+	op(_words[last_word], last_mask);
+}
+
 bool Game_Switches::Set(int switch_id, bool value) {
 	if (EP_UNLIKELY(ShouldWarn(switch_id, switch_id))) {
 		Output::Debug("Invalid write sw[{}] = {}!", switch_id, value);
@@ -34,11 +85,11 @@ bool Game_Switches::Set(int switch_id, bool value) {
 	if (switch_id <= 0) {
 		return false;
 	}
-	auto& ss = _switches;
-	if (switch_id > static_cast<int>(ss.size())) {
-		ss.resize(switch_id);
-	}
-	ss[switch_id - 1] = value;
+	Resize(switch_id);
+	const int index = switch_id - 1;
+	const Word mask = Word(1) << (index % word_bits);
+	auto& word = _words[index / word_bits];
+	word = value ? (word | mask) : (word & ~mask);
 	return value;
 }
 
@@ -47,12 +98,11 @@ void Game_Switches::SetRange(int first_id, int last_id, bool value) {
 		Output::Debug("Invalid write sw[{},{}] = {}!", first_id, last_id, value);
 		--_warnings;
 	}
-	auto& ss = _switches;
-	if (last_id > static_cast<int>(ss.size())) {
-		ss.resize(last_id, false);
-	}
-	for (int i = std::max(0, first_id - 1); i < last_id; ++i) {
-		ss[i] = value;
+	Resize(last_id);
+	if (value) {
+		WriteRange(first_id, last_id, [](Word& word, Word mask) { word |= mask; });
+	} else {
+		WriteRange(first_id, last_id, [](Word& word, Word mask) { word &= ~mask; });
 	}
 }
 
@@ -64,12 +114,10 @@ bool Game_Switches::Flip(int switch_id) {
 	if (switch_id <= 0) {
 		return false;
 	}
-	auto& ss = _switches;
-	if (switch_id > static_cast<int>(ss.size())) {
-		ss.resize(switch_id);
-	}
-	ss[switch_id - 1].flip();
-	return ss[switch_id - 1];
+	Resize(switch_id);
+	const int index = switch_id - 1;
+	_words[index / word_bits] ^= Word(1) << (index % word_bits);
+	return GetBit(index);
 }
 
 void Game_Switches::FlipRange(int first_id, int last_id) {
@@ -77,13 +125,8 @@ void Game_Switches::FlipRange(int first_id, int last_id) {
 		Output::Debug("Invalid flip sw[{},{}]!", first_id, last_id);
 		--_warnings;
 	}
-	auto& ss = _switches;
-	if (last_id > static_cast<int>(ss.size())) {
-		ss.resize(last_id);
-	}
-	for (int i = std::max(0, first_id - 1); i < last_id; ++i) {
-		ss[i].flip();
-	}
+	Resize(last_id);
+	WriteRange(first_id, last_id, [](Word& word, Word mask) { word ^= mask; });
 }
 
 std::string_view Game_Switches::GetName(int _id) const {
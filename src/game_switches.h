@@ -19,6 +19,7 @@
 #define EP_GAME_SWITCHES_H
 
 // Headers
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <lcf/data.h>
@@ -27,6 +28,9 @@
 
 /**
  * Game_Switches class
+ *
+ * The switches are stored as a bitset, range operations update 64
+ * switches at once.
  */
 class Game_Switches {
 public:
@@ -35,8 +39,8 @@ public:
 
 	Game_Switches() = default;
 
-	void SetData(Switches_t s);
-	const Switches_t& GetData() const;
+	void SetData(const Switches_t& s);
+	Switches_t GetData() const;
 
 	void SetLowerLimit(size_t limit);
 
@@ -59,33 +63,34 @@ public:
 	void SetWarning(int w);
 
 private:
+	using Word = uint64_t;
+	static constexpr int word_bits = 64;
+
 	bool ShouldWarn(int first_id, int last_id) const;
 	void WarnGet(int variable_id) const;
-
-	Switches_t _switches;
+	void Resize(int size);
+	bool GetBit(int index) const;
+	template <typename F>
+		void WriteRange(int first_id, int last_id, F&& op);
+
+	/** Bits beyond _size are always 0 */
+	std::vector<Word> _words;
+	int _size = 0;
 	size_t lower_limit = 0;
 	mutable int _warnings = kMaxWarnings;
 };
 
 
-inline void Game_Switches::SetData(Switches_t s) {
-	_switches = std::move(s);
-}
-
-inline const Game_Switches::Switches_t& Game_Switches::GetData() const {
-	return _switches;
-}
-
 inline void Game_Switches::SetLowerLimit(size_t limit) {
 	lower_limit = limit;
 }
 
 inline int Game_Switches::GetSize() const {
-	return static_cast<int>(_switches.size());
+	return _size;
 }
 
 inline int Game_Switches::GetSizeWithLimit() const {
-	return std::max<int>(lower_limit, _switches.size());
+	return std::max<int>(lower_limit, _size);
 }
 
 inline bool Game_Switches::IsValid(int variable_id) const {
@@ -100,10 +105,14 @@ inline bool Game_Switches::Get(int switch_id) const {
 	if (EP_UNLIKELY(ShouldWarn(switch_id, switch_id))) {
 		WarnGet(switch_id);
 	}
-	if (switch_id <= 0 || switch_id > static_cast<int>(_switches.size())) {
+	if (switch_id <= 0 || switch_id > _size) {
 		return false;
 	}
-	return _switches[switch_id - 1];
+	return GetBit(switch_id - 1);
+}
+
+inline bool Game_Switches::GetBit(int index) const {
+	return (_words[index / word_bits] >> (index % word_bits)) & 1;
 }
 
 inline int Game_Switches::GetInt(int switch_id) const {
@@ -18,6 +18,7 @@
 // Headers
 #include <fstream>
 #include <functional>
+#include <unordered_set>
 #include "game_system.h"
 #include "async_handler.h"
 #include "game_battle.h"
@@ -217,6 +218,36 @@ void Game_System::SePlay(const lcf::rpg::Animation &animation) {
 	}
 }
 
+void Game_System::PreloadSe() {
+	if (!Audio().SE_GetPreloadEnabled()) {
+		return;
+	}
+
+	std::unordered_set<std::string> queued;
+	auto preload = [&](const lcf::rpg::Sound& se) {
+		// Ineluki scripts and links are not sound files
+		if (se.name.empty() || se.name == "(OFF)" || EndsWith(se.name, ".script") || EndsWith(se.name, ".link")) {
+			return;
+		}
+		if (queued.insert(se.name).second) {
+			AudioSeCache::Preload(se.name);
+		}
+	};
+
+	// Most frequently played first, the cache may run full
+	for (int i = 0; i < SFX_Count; ++i) {
+		preload(GetSystemSE(i));
+	}
+	for (const auto& skill : lcf::Data::skills) {
+		preload(skill.sound_effect);
+	}
+	for (const auto& animation : lcf::Data::animations) {
+		for (const auto& timing : animation.timings) {
+			preload(timing.se);
+		}
+	}
+}
+
 std::string_view Game_System::GetSystemName() {
 	return !data.graphics_name.empty() ?
 		std::string_view(data.graphics_name) : std::string_view(lcf::Data::system.system_name);
@@ -135,6 +135,12 @@ public:
 	 */
 	void SePlay(const lcf::rpg::Animation& animation);
 
+	/**
+	 * Queues the system sounds and the sounds of all skills and animations
+	 * for decoding in the background when enabled in the audio settings.
+	 */
+	void PreloadSe();
+
 	/** @return system graphic filename.  */
 	std::string_view GetSystemName();
 
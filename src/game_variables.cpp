@@ -18,12 +18,22 @@
 // Headers
 #include "game_variables.h"
 #include "output.h"
+#include "compiler.h"
 #include <lcf/reader_util.h>
 #include <lcf/data.h>
 #include "utils.h"
 #include "rand.h"
+#include <array>
 #include <cmath>
 
+#ifdef EP_HAVE_SSE2
+#  include <emmintrin.h>
+#endif
+
+#ifdef EP_HAVE_NEON
+#  include <arm_neon.h>
+#endif
+
 namespace {
 using Var_t = Game_Variables::Var_t;
 
@@ -128,6 +138,158 @@ constexpr Var_t VarBitShiftRight(Var_t n, Var_t d) {
 	return n >> d;
 };
 
+
+/** Range operations with a vectorized implementation */
+enum class VectorOp {
+	None,
+	Set,
+	Add,
+	Sub,
+	BitOr,
+	BitAnd,
+	BitXor
+};
+
+/** Scalar operation of a range write together with its vector kernel */
+template <Var_t (*Fn)(Var_t, Var_t), VectorOp V = VectorOp::None>
+struct RangeOp {
+	static constexpr VectorOp vector_op = V;
+
+	constexpr Var_t operator()(Var_t l, Var_t r) const {
+		return Fn(l, r);
+	}
+};
+
+constexpr RangeOp<VarSet, VectorOp::Set> RangeSet;
+constexpr RangeOp<VarAdd, VectorOp::Add> RangeAdd;
+constexpr RangeOp<VarSub, VectorOp::Sub> RangeSub;
+constexpr RangeOp<VarMult> RangeMult;
+constexpr RangeOp<VarDiv> RangeDiv;
+constexpr RangeOp<VarMod> RangeMod;
+constexpr RangeOp<VarBitOr, VectorOp::BitOr> RangeBitOr;
+constexpr RangeOp<VarBitAnd, VectorOp::BitAnd> RangeBitAnd;
+constexpr RangeOp<VarBitXor, VectorOp::BitXor> RangeBitXor;
+constexpr RangeOp<VarBitShiftLeft> RangeBitShiftLeft;
+constexpr RangeOp<VarBitShiftRight> RangeBitShiftRight;
+
+// Amount of values generated at once by ranges with changing operands
+constexpr int range_chunk_size = 256;
+
+#if defined(EP_HAVE_SSE2)
+inline __m128i Select(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Same results as VarAdd and VarSub: saturates towards the sign of l on overflow
+inline __m128i Saturate(__m128i l, __m128i res, __m128i overflow) {
+	__m128i sat = _mm_xor_si128(_mm_srai_epi32(l, 31), _mm_set1_epi32(std::numeric_limits<Var_t>::max()));
+	return Select(_mm_srai_epi32(overflow, 31), sat, res);
+}
+
+template <VectorOp V>
+inline __m128i ComputeVector(__m128i l, __m128i r) {
+	if constexpr (V == VectorOp::Set) {
+		return r;
+	} else if constexpr (V == VectorOp::Add) {
+		__m128i res = _mm_add_epi32(l, r);
+		return Saturate(l, res, _mm_and_si128(_mm_xor_si128(l, res), _mm_xor_si128(r, res)));
+	} else if constexpr (V == VectorOp::Sub) {
+		__m128i res = _mm_sub_epi32(l, r);
+		return Saturate(l, res, _mm_and_si128(_mm_xor_si128(l, r), _mm_xor_si128(l, res)));
+	} else if constexpr (V == VectorOp::BitOr) {
+		return _mm_or_si128(l, r);
+	} else if constexpr (V == VectorOp::BitAnd) {
+		return _mm_and_si128(l, r);
+	} else {
+		return _mm_xor_si128(l, r);
+	}
+}
+
+/** @return amount of processed variables, the remainder is left for the scalar code */
+template <VectorOp V>
+int ApplyVector(Var_t* vars, const Var_t* values, Var_t value, int count, Var_t minval, Var_t maxval) {
+	if constexpr (V == VectorOp::None) {
+		return 0;
+	} else {
+		const __m128i lo = _mm_set1_epi32(minval);
+		const __m128i hi = _mm_set1_epi32(maxval);
+		const __m128i uniform = _mm_set1_epi32(value);
+
+		int i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vars + i));
+			__m128i r = values ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)) : uniform;
+			__m128i res = ComputeVector<V>(l, r);
+			res = Select(_mm_cmplt_epi32(res, lo), lo, res);
+			res = Select(_mm_cmpgt_epi32(res, hi), hi, res);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(vars + i), res);
+		}
+		return i;
+	}
+}
+#elif defined(EP_HAVE_NEON)
+template <VectorOp V>
+inline int32x4_t ComputeVector(int32x4_t l, int32x4_t r) {
+	if constexpr (V == VectorOp::Set) {
+		return r;
+	} else if constexpr (V == VectorOp::Add) {
+		return vqaddq_s32(l, r);
+	} else if constexpr (V == VectorOp::Sub) {
+		return vqsubq_s32(l, r);
+	} else if constexpr (V == VectorOp::BitOr) {
+		return vorrq_s32(l, r);
+	} else if constexpr (V == VectorOp::BitAnd) {
+		return vandq_s32(l, r);
+	} else {
+		return veorq_s32(l, r);
+	}
+}
+
+/** @return amount of processed variables, the remainder is left for the scalar code */
+template <VectorOp V>
+int ApplyVector(Var_t* vars, const Var_t* values, Var_t value, int count, Var_t minval, Var_t maxval) {
+	if constexpr (V == VectorOp::None) {
+		return 0;
+	} else {
+		const int32x4_t lo = vdupq_n_s32(minval);
+		const int32x4_t hi = vdupq_n_s32(maxval);
+		const int32x4_t uniform = vdupq_n_s32(value);
+
+		int i = 0;
+		for (; i + 4 <= count; i += 4) {
+			int32x4_t l = vld1q_s32(vars + i);
+			int32x4_t r = values ? vld1q_s32(values + i) : uniform;
+			int32x4_t res = ComputeVector<V>(l, r);
+			vst1q_s32(vars + i, vminq_s32(vmaxq_s32(res, lo), hi));
+		}
+		return i;
+	}
+}
+#else
+template <VectorOp V>
+int ApplyVector(Var_t*, const Var_t*, Var_t, int, Var_t, Var_t) {
+	return 0;
+}
+#endif
+
+/** vars[i] = clamp(op(vars[i], value)) */
+template <typename F>
+void ApplyRange(Var_t* vars, int count, Var_t value, F op, Var_t minval, Var_t maxval) {
+	int i = ApplyVector<F::vector_op>(vars, nullptr, value, count, minval, maxval);
+	for (; i < count; ++i) {
+		vars[i] = Utils::Clamp(op(vars[i], value), minval, maxval);
+	}
+}
+
+/** vars[i] = clamp(op(vars[i], values[i])), values must not overlap vars or start behind vars */
+template <typename F>
+void ApplyRange(Var_t* vars, const Var_t* values, int count, F op, Var_t minval, Var_t maxval) {
+	int i = ApplyVector<F::vector_op>(vars, values, 0, count, minval, maxval);
+	for (; i < count; ++i) {
+		vars[i] = Utils::Clamp(op(vars[i], values[i]), minval, maxval);
+	}
+}
+
 }
 
 Game_Variables::Game_Variables(Var_t minval, Var_t maxval)
@@ -191,22 +353,47 @@ void Game_Variables::PrepareArray(const int first_id_a, const int last_id_a, con
 
 template <typename V, typename F>
 void Game_Variables::WriteRange(const int first_id, const int last_id, V&& value, F&& op) {
-	auto& vv = _variables;
-	for (int i = std::max(0, first_id - 1); i < last_id; ++i) {
-		auto& v = vv[i];
-		v = Utils::Clamp(op(v, value()), _min, _max);
+	// The values are generated in order before they are applied with the vector kernels
+	std::array<Var_t, range_chunk_size> values;
+	for (int i = std::max(0, first_id - 1); i < last_id; i += range_chunk_size) {
+		const int count = std::min(range_chunk_size, last_id - i);
+		for (int j = 0; j < count; ++j) {
+			values[j] = value();
+		}
+		ApplyRange(_variables.data() + i, values.data(), count, op, _min, _max);
+	}
+}
+
+template <typename F>
+void Game_Variables::WriteRangeConstant(const int first_id, const int last_id, Var_t value, F&& op) {
+	const int begin = std::max(0, first_id - 1);
+	if (begin < last_id) {
+		ApplyRange(_variables.data() + begin, last_id - begin, value, op, _min, _max);
 	}
 }
 
 template <typename F>
 void Game_Variables::WriteArray(const int first_id_a, const int last_id_a, const int first_id_b, F&& op) {
 	auto& vv = _variables;
-	int out_b = std::max(0, first_id_b - 1);
-	for (int i = std::max(0, first_id_a - 1); i < last_id_a; ++i) {
-		auto& v_a = vv[i];
-		auto v_b = vv[out_b++];
-		v_a = Utils::Clamp(op(v_a, v_b), _min, _max);
+	const int begin_a = std::max(0, first_id_a - 1);
+	const int begin_b = std::max(0, first_id_b - 1);
+	const int count = last_id_a - begin_a;
+	if (count <= 0) {
+		return;
+	}
+
+	if (begin_b < begin_a && begin_a - begin_b < count) {
+		// B reads values which were written earlier in the loop
+		int out_b = begin_b;
+		for (int i = begin_a; i < last_id_a; ++i) {
+			auto& v_a = vv[i];
+			auto v_b = vv[out_b++];
+			v_a = Utils::Clamp(op(v_a, v_b), _min, _max);
+		}
+		return;
 	}
+
+	ApplyRange(vv.data() + begin_a, vv.data() + begin_b, count, op, _min, _max);
 }
 
 std::vector<Var_t> Game_Variables::GetRange(int variable_id, int length) {
@@ -264,240 +451,257 @@ Game_Variables::Var_t Game_Variables::BitShiftRight(int variable_id, Var_t value
 
 void Game_Variables::SetRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] = {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarSet);
+	WriteRangeConstant(first_id, last_id, value, RangeSet);
 }
 
 void Game_Variables::AddRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] += {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarAdd);
+	WriteRangeConstant(first_id, last_id, value, RangeAdd);
 }
 
 void Game_Variables::SubRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] -= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarSub);
+	WriteRangeConstant(first_id, last_id, value, RangeSub);
 }
 
 void Game_Variables::MultRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] *= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarMult);
+	WriteRangeConstant(first_id, last_id, value, RangeMult);
 }
 
 void Game_Variables::DivRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] /= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarDiv);
+	WriteRangeConstant(first_id, last_id, value, RangeDiv);
 }
 
 void Game_Variables::ModRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] %= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarMod);
+	WriteRangeConstant(first_id, last_id, value, RangeMod);
 }
 
 void Game_Variables::BitOrRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] |= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitOr);
+	WriteRangeConstant(first_id, last_id, value, RangeBitOr);
 }
 
 void Game_Variables::BitAndRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] &= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitAnd);
+	WriteRangeConstant(first_id, last_id, value, RangeBitAnd);
 }
 
 void Game_Variables::BitXorRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] ^= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitXor);
+	WriteRangeConstant(first_id, last_id, value, RangeBitXor);
 }
 
 void Game_Variables::BitShiftLeftRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] <<= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitShiftLeft);
+	WriteRangeConstant(first_id, last_id, value, RangeBitShiftLeft);
 }
 
 void Game_Variables::BitShiftRightRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] >>= {}!", value);
-	WriteRange(first_id, last_id, [value](){ return value; }, VarBitShiftRight);
+	WriteRangeConstant(first_id, last_id, value, RangeBitShiftRight);
 }
 
 template <typename F>
 void Game_Variables::WriteRangeVariable(int first_id, const int last_id, const int var_id, F&& op) {
 	if (var_id >= first_id && var_id <= last_id) {
-		auto value = Get(var_id);
-		WriteRange(first_id, var_id, [value](){ return value; }, std::forward<F>(op));
+		WriteRangeConstant(first_id, var_id, Get(var_id), op);
 		first_id = var_id + 1;
 	}
-	auto value = Get(var_id);
-	WriteRange(first_id, last_id, [value](){ return value; }, std::forward<F>(op));
+	WriteRangeConstant(first_id, last_id, Get(var_id), op);
 }
 
+template <typename F>
+void Game_Variables::WriteRangeVariableIndirect(int first_id, const int last_id, const int var_id, F&& op) {
+	// The operand only changes after the range wrote to var_id or to the variable var_id points to
+	first_id = std::max(1, first_id);
+	while (first_id <= last_id) {
+		const int target_id = Get(var_id);
+		const auto value = Get(target_id);
+
+		int split_id = last_id;
+		for (int id: { var_id, target_id }) {
+			if (id >= first_id && id < split_id) {
+				split_id = id;
+			}
+		}
+
+		WriteRangeConstant(first_id, split_id, value, op);
+		first_id = split_id + 1;
+	}
+}
 
 void Game_Variables::SetRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] = Var({})!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarSet);
+	WriteRangeVariable(first_id, last_id, var_id, RangeSet);
 }
 
 void Game_Variables::AddRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] += var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarAdd);
+	WriteRangeVariable(first_id, last_id, var_id, RangeAdd);
 }
 
 void Game_Variables::SubRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] -= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarSub);
+	WriteRangeVariable(first_id, last_id, var_id, RangeSub);
 }
 
 void Game_Variables::MultRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] *= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarMult);
+	WriteRangeVariable(first_id, last_id, var_id, RangeMult);
 }
 
 void Game_Variables::DivRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] /= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarDiv);
+	WriteRangeVariable(first_id, last_id, var_id, RangeDiv);
 }
 
 void Game_Variables::ModRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] /= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarMod);
+	WriteRangeVariable(first_id, last_id, var_id, RangeMod);
 }
 
 void Game_Variables::BitOrRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] |= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarBitOr);
+	WriteRangeVariable(first_id, last_id, var_id, RangeBitOr);
 }
 
 void Game_Variables::BitAndRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] &= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarBitAnd);
+	WriteRangeVariable(first_id, last_id, var_id, RangeBitAnd);
 }
 
 void Game_Variables::BitXorRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] ^= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarBitXor);
+	WriteRangeVariable(first_id, last_id, var_id, RangeBitXor);
 }
 
 void Game_Variables::BitShiftLeftRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] <<= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarBitShiftLeft);
+	WriteRangeVariable(first_id, last_id, var_id, RangeBitShiftLeft);
 }
 
 void Game_Variables::BitShiftRightRangeVariable(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] >>= var[{}]!", var_id);
-	WriteRangeVariable(first_id, last_id, var_id, VarBitShiftRight);
+	WriteRangeVariable(first_id, last_id, var_id, RangeBitShiftRight);
 }
 
 void Game_Variables::SetRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] = var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarSet);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeSet);
 }
 
 void Game_Variables::AddRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] += var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarAdd);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeAdd);
 }
 
 void Game_Variables::SubRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] -= var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarSub);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeSub);
 }
 
 void Game_Variables::MultRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] *= var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarMult);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeMult);
 }
 
 void Game_Variables::DivRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] /= var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarDiv);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeDiv);
 }
 
 void Game_Variables::ModRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] %= var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarMod);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeMod);
 }
 
 void Game_Variables::BitOrRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] |= var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarBitOr);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeBitOr);
 }
 
 void Game_Variables::BitAndRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] &= var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarBitAnd);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeBitAnd);
 }
 
 void Game_Variables::BitXorRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] ^= var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarBitXor);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeBitXor);
 }
 
 void Game_Variables::BitShiftLeftRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] <<= var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarBitShiftLeft);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeBitShiftLeft);
 }
 
 void Game_Variables::BitShiftRightRangeVariableIndirect(int first_id, int last_id, int var_id) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] >>= var[var[{}]]!", var_id);
-	WriteRange(first_id, last_id, [this,var_id](){ return Get(Get(var_id)); }, VarBitShiftRight);
+	WriteRangeVariableIndirect(first_id, last_id, var_id, RangeBitShiftRight);
 }
 
 void Game_Variables::SetRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] = rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarSet);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeSet);
 }
 
 void Game_Variables::AddRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] += rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarAdd);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeAdd);
 }
 
 void Game_Variables::SubRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] -= rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarSub);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeSub);
 }
 
 void Game_Variables::MultRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] *= rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarMult);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeMult);
 }
 
 void Game_Variables::DivRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] /= rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarDiv);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeDiv);
 }
 
 void Game_Variables::ModRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] %= rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarMod);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeMod);
 }
 
 void Game_Variables::BitOrRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] |= rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarBitOr);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeBitOr);
 }
 
 void Game_Variables::BitAndRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] &= rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarBitAnd);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeBitAnd);
 }
 
 void Game_Variables::BitXorRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] ^= rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarBitXor);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeBitXor);
 }
 
 void Game_Variables::BitShiftLeftRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] <<= rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarBitShiftLeft);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeBitShiftLeft);
 }
 
 void Game_Variables::BitShiftRightRangeRandom(int first_id, int last_id, Var_t minval, Var_t maxval) {
 	PrepareRange(first_id, last_id, "Invalid write var[{},{}] >>= rand({},{})!", minval, maxval);
-	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, VarBitShiftRight);
+	WriteRange(first_id, last_id, [minval,maxval](){ return Rand::GetRandomNumber(minval, maxval); }, RangeBitShiftRight);
 }
 
 void Game_Variables::EnumerateRange(int first_id, int last_id, Var_t value) {
 	PrepareRange(first_id, last_id, "Invalid write enumerate(var[{},{}])!");
 	Var_t out_value = value;
-	WriteRange(first_id, last_id, [&out_value](){ return out_value++; }, VarSet);
+	WriteRange(first_id, last_id, [&out_value](){ return out_value++; }, RangeSet);
 }
 
 void Game_Variables::SortRange(int first_id, int last_id, bool asc) {
@@ -530,7 +734,7 @@ void Game_Variables::SetArray(int first_id_a, int last_id_a, int first_id_b) {
 	// Maniac Patch uses memcpy which is actually a memmove
 	// This ensures overlapping areas are copied properly
 	if (first_id_a < first_id_b) {
-		WriteArray(first_id_a, last_id_a, first_id_b, VarSet);
+		WriteArray(first_id_a, last_id_a, first_id_b, RangeSet);
 	} else {
 		auto& vv = _variables;
 		const int steps = std::max(0, last_id_a - first_id_a + 1);
@@ -546,52 +750,52 @@ void Game_Variables::SetArray(int first_id_a, int last_id_a, int first_id_b) {
 
 void Game_Variables::AddArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] += var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarAdd);
+	WriteArray(first_id_a, last_id_a, first_id_b, RangeAdd);
 }
 
 void Game_Variables::SubArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] -= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarSub);
+	WriteArray(first_id_a, last_id_a, first_id_b, RangeSub);
 }
 
 void Game_Variables::MultArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] *= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarMult);
+	WriteArray(first_id_a, last_id_a, first_id_b, RangeMult);
 }
 
 void Game_Variables::DivArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] /= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarDiv);
+	WriteArray(first_id_a, last_id_a, first_id_b, RangeDiv);
 }
 
 void Game_Variables::ModArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] %= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarMod);
+	WriteArray(first_id_a, last_id_a, first_id_b, RangeMod);
 }
 
 void Game_Variables::BitOrArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] |= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarBitOr);
+	WriteArray(first_id_a, last_id_a, first_id_b, RangeBitOr);
 }
 
 void Game_Variables::BitAndArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] &= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarBitAnd);
+	WriteArray(first_id_a, last_id_a, first_id_b, RangeBitAnd);
 }
 
 void Game_Variables::BitXorArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] ^= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarBitXor);
+	WriteArray(first_id_a, last_id_a, first_id_b, RangeBitXor);
 }
 
 void Game_Variables::BitShiftLeftArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] <<= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarBitShiftLeft);
+	WriteArray(first_id_a, last_id_a, first_id_b, RangeBitShiftLeft);
 }
 
 void Game_Variables::BitShiftRightArray(int first_id_a, int last_id_a, int first_id_b) {
 	PrepareArray(first_id_a, last_id_a, first_id_b, "Invalid write var[{},{}] >>= var[{},{}]!");
-	WriteArray(first_id_a, last_id_a, first_id_b, VarBitShiftRight);
+	WriteArray(first_id_a, last_id_a, first_id_b, RangeBitShiftRight);
 }
 
 void Game_Variables::SwapArray(int first_id_a, int last_id_a, int first_id_b) {
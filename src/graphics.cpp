@@ -30,6 +30,10 @@
 #include "drawable_mgr.h"
 #include "baseui.h"
 #include "game_clock.h"
+#include "game_system.h"
+#include "main_data.h"
+#include "damage_region.h"
+#include "instrumentation.h"
 
 using namespace std::chrono_literals;
 
@@ -42,6 +46,19 @@ namespace Graphics {
 	std::unique_ptr<FpsOverlay> fps_overlay;
 
 	std::string window_title_key;
+
+	/** State of the previous frame, damage tracking is only possible when it matches */
+	struct DamageContext {
+		const DrawableList* list = nullptr;
+		const Bitmap* dst = nullptr;
+		Drawable::Z_t min_z = 0;
+		uint64_t background = 0;
+		uint64_t dst_revision = 0;
+		bool valid = false;
+	};
+	DamageContext damage_context;
+
+	Rect FullDraw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z, bool erased);
 }
 
 void Graphics::Init() {
@@ -104,18 +121,83 @@ void Graphics::UpdateTitle() {
 #endif
 }
 
-void Graphics::Draw(Bitmap& dst) {
+Rect Graphics::Draw(Bitmap& dst) {
+	Instrumentation::ZoneScope zone(Instrumentation::Zone::GraphicsDraw);
+
 	auto& transition = Transition::instance();
 
 	auto min_z = std::numeric_limits<Drawable::Z_t>::min();
 	auto max_z = std::numeric_limits<Drawable::Z_t>::max();
+	bool erased = false;
 	if (transition.IsActive()) {
 		min_z = transition.GetZ();
 	} else if (transition.IsErasedNotActive()) {
 		min_z = transition.GetZ() + 1;
+		erased = true;
+	}
+
+	auto& drawable_list = DrawableMgr::GetLocalList();
+
+	// The transition renders the whole screen every frame
+	if (!DisplayUi->IsDamageTracking() || transition.IsActive()) {
+		damage_context.valid = false;
+		return FullDraw(dst, min_z, max_z, erased);
+	}
+
+	DamageHash background;
+	background.Add(current_scene.get());
+	if (Main_Data::game_system) {
+		background.Add(Main_Data::game_system->GetBackgroundColor());
+	}
+
+	// Anything drawn to the screen outside of this function invalidates the tracking
+	const bool full = !damage_context.valid
+		|| damage_context.list != &drawable_list
+		|| damage_context.dst != &dst
+		|| damage_context.min_z != min_z
+		|| damage_context.background != background.Get()
+		|| damage_context.dst_revision != dst.GetRevision();
+
+	// Always collect, this updates the state stored in the drawables
+	DamageRegion damage;
+	const bool tracked = drawable_list.CollectDamage(damage, min_z, max_z);
+
+	damage_context.list = &drawable_list;
+	damage_context.dst = &dst;
+	damage_context.min_z = min_z;
+	damage_context.background = background.Get();
+	damage_context.valid = true;
+
+	Rect bounds;
+	if (full || !tracked) {
+		bounds = FullDraw(dst, min_z, max_z, erased);
+	} else {
+		damage.Clip(dst.GetRect());
+
+		for (auto& rect: damage.GetRects()) {
+			dst.SetClipRect(rect);
+			if (erased) {
+				dst.ClearRect(rect);
+			} else if (!drawable_list.empty() && min_z == std::numeric_limits<Drawable::Z_t>::min()) {
+				current_scene->DrawBackground(dst);
+			}
+			drawable_list.Draw(dst, min_z, max_z, rect);
+		}
+		dst.ClearClipRect();
+
+		bounds = damage.GetBounds();
+	}
+
+	damage_context.dst_revision = dst.GetRevision();
+	return bounds;
+}
+
+Rect Graphics::FullDraw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z, bool erased) {
+	if (erased) {
 		dst.Clear();
 	}
 	LocalDraw(dst, min_z, max_z);
+	return dst.GetRect();
 }
 
 void Graphics::LocalDraw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z) {
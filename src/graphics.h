@@ -48,7 +48,15 @@ namespace Graphics {
 	 */
 	void Update();
 
-	void Draw(Bitmap& dst);
+	/**
+	 * Draws the current scene to the screen.
+	 * When damage tracking is enabled only the parts of the screen that
+	 * changed since the last call are redrawn.
+	 *
+	 * @param dst screen surface
+	 * @return area of dst that was redrawn
+	 */
+	Rect Draw(Bitmap& dst);
 
 	void LocalDraw(Bitmap& dst, Drawable::Z_t min_z, Drawable::Z_t max_z);
 
@@ -16,12 +16,77 @@
  */
 
 #include "instrumentation.h"
+#include "filefinder.h"
+#include "output.h"
 #include "utils.h"
+#include <algorithm>
+#include <iterator>
+#include <mutex>
 
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 __itt_domain* Instrumentation::domain = nullptr;
 #endif
 
+std::atomic<bool> Instrumentation::profiler_enabled = false;
+
+namespace {
+	// Limits the memory usage of long traces to approximately 32 MB
+	constexpr size_t max_trace_events = 1 << 20;
+
+	constexpr const char* zone_names[] = {
+		"Scene::Update",
+		"Game_Map::Update",
+		"Game_Interpreter::Update",
+		"Graphics::Draw",
+		"Audio Decode",
+		"Cache Load",
+	};
+	static_assert(std::size(zone_names) == Instrumentation::num_zones);
+
+	struct TraceEvent {
+		const char* name;
+		Game_Clock::time_point start;
+		Game_Clock::duration duration;
+		int thread;
+	};
+
+	std::string trace_path;
+	Game_Clock::time_point trace_start;
+	std::mutex trace_mutex;
+	std::vector<TraceEvent> trace_events;
+	bool trace_full = false;
+
+	// Zones run on multiple threads, the time is summed up in nanoseconds
+	std::array<std::atomic<int64_t>, Instrumentation::num_zones> zone_times = {};
+
+	Game_Clock::time_point frame_start;
+	std::array<Instrumentation::FrameRecord, Instrumentation::num_recent_frames> recent_frames;
+	int recent_frames_next = 0;
+	int recent_frames_count = 0;
+
+	std::atomic<int> next_thread_id = 1;
+
+	int GetThreadId() {
+		thread_local int id = next_thread_id++;
+		return id;
+	}
+
+	void AddTraceEvent(const char* name, Game_Clock::time_point start, Game_Clock::duration duration) {
+		int thread = GetThreadId();
+
+		std::lock_guard<std::mutex> lock(trace_mutex);
+		if (trace_events.size() >= max_trace_events) {
+			trace_full = true;
+			return;
+		}
+		trace_events.push_back({ name, start, duration, thread });
+	}
+
+	double ToMicroseconds(Game_Clock::duration d) {
+		return std::chrono::duration<double, std::micro>(d).count();
+	}
+}
+
 void Instrumentation::Init(const char* name) {
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	assert(!domain);
@@ -34,3 +99,84 @@ void Instrumentation::Init(const char* name) {
 	(void)name;
 #endif
 }
+
+void Instrumentation::EnableProfiler(std::string path) {
+	trace_path = std::move(path);
+	trace_start = Game_Clock::now();
+	frame_start = trace_start;
+	profiler_enabled = true;
+}
+
+void Instrumentation::WriteTrace() {
+	if (trace_path.empty()) {
+		return;
+	}
+
+	auto os = FileFinder::Root().OpenOutputStream(trace_path, std::ios::out | std::ios::trunc);
+	if (!os) {
+		Output::Warning("Failed to write trace to {}", trace_path);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(trace_mutex);
+
+	os << "{\"traceEvents\":[\n";
+	const char* sep = "";
+	for (const auto& ev: trace_events) {
+		os << fmt::format("{}{{\"name\":\"{}\",\"cat\":\"player\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":1,\"tid\":{}}}",
+			sep, ev.name, ToMicroseconds(ev.start - trace_start), ToMicroseconds(ev.duration), ev.thread);
+		sep = ",\n";
+	}
+	os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	if (trace_full) {
+		Output::Warning("Trace is incomplete, only the first {} events were recorded", max_trace_events);
+	}
+	Output::Debug("Wrote {} trace events to {}", trace_events.size(), trace_path);
+}
+
+const char* Instrumentation::GetZoneName(Zone zone) {
+	return zone_names[static_cast<int>(zone)];
+}
+
+std::vector<Instrumentation::FrameRecord> Instrumentation::GetRecentFrames() {
+	std::vector<FrameRecord> frames;
+	frames.reserve(recent_frames_count);
+
+	int first = recent_frames_next - recent_frames_count + num_recent_frames;
+	for (int i = 0; i < recent_frames_count; ++i) {
+		frames.push_back(recent_frames[(first + i) % num_recent_frames]);
+	}
+	return frames;
+}
+
+void Instrumentation::ProfileFrameBegin() {
+	frame_start = Game_Clock::now();
+}
+
+void Instrumentation::ProfileFrameEnd() {
+	auto now = Game_Clock::now();
+
+	auto& record = recent_frames[recent_frames_next];
+	record.total = now - frame_start;
+	for (int i = 0; i < num_zones; ++i) {
+		auto ns = std::chrono::nanoseconds(zone_times[i].exchange(0, std::memory_order_relaxed));
+		record.zones[i] = std::chrono::duration_cast<Game_Clock::duration>(ns);
+	}
+
+	recent_frames_next = (recent_frames_next + 1) % num_recent_frames;
+	recent_frames_count = std::min(recent_frames_count + 1, num_recent_frames);
+
+	if (!trace_path.empty()) {
+		AddTraceEvent("Frame", frame_start, record.total);
+	}
+}
+
+void Instrumentation::ProfileZone(Zone zone, Game_Clock::time_point start, Game_Clock::time_point end) {
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+	zone_times[static_cast<int>(zone)].fetch_add(ns.count(), std::memory_order_relaxed);
+
+	if (!trace_path.empty()) {
+		AddTraceEvent(GetZoneName(zone), start, end - start);
+	}
+}
@@ -25,10 +25,37 @@
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 #include <ittnotify.h>
 #endif
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <string>
+#include <vector>
+#include "game_clock.h"
 
 class Instrumentation {
 public:
+	/** Subsystems measured by the frame profiler */
+	enum class Zone {
+		SceneUpdate,
+		MapUpdate,
+		InterpreterUpdate,
+		GraphicsDraw,
+		AudioDecode,
+		CacheLoad,
+		Count
+	};
+
+	static constexpr int num_zones = static_cast<int>(Zone::Count);
+
+	/** Amount of frames kept by the frame profiler */
+	static constexpr int num_recent_frames = 120;
+
+	/** Time spent in a frame, total and per zone */
+	struct FrameRecord {
+		Game_Clock::duration total = {};
+		std::array<Game_Clock::duration, num_zones> zones = {};
+	};
+
 	/**
 	 * Must be called once on startup to initialize the instrumentation framework.
 	 *
@@ -42,6 +69,57 @@ public:
 	/** Call at the end of a frame */
 	static void FrameEnd();
 
+	/**
+	 * Enables the frame profiler. Must be called before any other thread
+	 * is started.
+	 *
+	 * @param trace_path when not empty a trace in the Chrome trace event
+	 *   format is recorded and written to this path by WriteTrace.
+	 *   The trace can be opened in chrome://tracing or Perfetto.
+	 */
+	static void EnableProfiler(std::string trace_path);
+
+	/** @return whether the frame profiler is enabled */
+	static bool IsProfilerEnabled();
+
+	/**
+	 * Writes the recorded trace to the path passed to EnableProfiler.
+	 * Does nothing when no trace is recorded.
+	 */
+	static void WriteTrace();
+
+	/**
+	 * @param zone profiler zone
+	 * @return human readable name of the zone
+	 */
+	static const char* GetZoneName(Zone zone);
+
+	/** @return the most recent frames, the oldest frame first */
+	static std::vector<FrameRecord> GetRecentFrames();
+
+	/**
+	 * RAII wrapper which adds the time until destruction to a profiler zone.
+	 * Can be used on any thread. Does nothing when the profiler is disabled.
+	 */
+	class ZoneScope {
+	public:
+		/**
+		 * Create a ZoneScope
+		 *
+		 * @param zone profiler zone the time is added to
+		 */
+		explicit ZoneScope(Zone zone);
+
+		ZoneScope(const ZoneScope&) = delete;
+		ZoneScope& operator=(const ZoneScope&) = delete;
+
+		~ZoneScope();
+	private:
+		Zone zone;
+		bool active;
+		Game_Clock::time_point start;
+	};
+
 	/** RAII wrapper around FrameBegin() / FrameEnd() */
 	class FrameScope {
 	public:
@@ -74,6 +152,12 @@ public:
 	};
 
 private:
+	static void ProfileFrameBegin();
+	static void ProfileFrameEnd();
+	static void ProfileZone(Zone zone, Game_Clock::time_point start, Game_Clock::time_point end);
+
+	static std::atomic<bool> profiler_enabled;
+
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	static __itt_domain* domain;
 #endif
@@ -84,12 +168,36 @@ inline void Instrumentation::FrameBegin() {
 	assert(domain);
 	__itt_frame_begin_v3(domain, nullptr);
 #endif
+	if (profiler_enabled.load(std::memory_order_relaxed)) {
+		ProfileFrameBegin();
+	}
 }
 inline void Instrumentation::FrameEnd() {
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	assert(domain);
 	__itt_frame_end_v3(domain, nullptr);
 #endif
+	if (profiler_enabled.load(std::memory_order_relaxed)) {
+		ProfileFrameEnd();
+	}
+}
+
+inline bool Instrumentation::IsProfilerEnabled() {
+	return profiler_enabled.load(std::memory_order_relaxed);
+}
+
+inline Instrumentation::ZoneScope::ZoneScope(Zone zone)
+	: zone(zone), active(profiler_enabled.load(std::memory_order_relaxed))
+{
+	if (active) {
+		start = Game_Clock::now();
+	}
+}
+
+inline Instrumentation::ZoneScope::~ZoneScope() {
+	if (active) {
+		ProfileZone(zone, start, Game_Clock::now());
+	}
 }
 
 inline Instrumentation::FrameScope::FrameScope(bool frame_begin)
@@ -0,0 +1,340 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_LRU_CACHE_H
+#define EP_LRU_CACHE_H
+
+// Headers
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * A key value cache which keeps track of the order in which the entries
+ * were used and of their size in bytes.
+ * Lookup, insertion and touching of entries are O(1). When the total size
+ * exceeds the budget the least recently used entries are evicted first.
+ *
+ * Entries which can not be evicted are pinned: they are moved behind the
+ * least recently used entry and skipped by later evictions until they
+ * are touched or unpinned. Evicting is O(1) per visited entry.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class LruCache {
+	public:
+		struct Entry {
+			K key;
+			V value;
+			size_t size;
+			bool pinned = false;
+		};
+
+		/** Access statistics */
+		struct Stats {
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0;
+		};
+
+		using container_type = std::list<Entry>;
+		using iterator = typename container_type::const_iterator;
+
+		/** Construct an empty cache without a budget */
+		LruCache() = default;
+
+		/**
+		 * Construct an empty cache.
+		 *
+		 * @param budget maximum size in bytes
+		 */
+		explicit LruCache(size_t budget);
+
+		/**
+		 * Looks up an entry and marks it as most recently used, a pinned
+		 * entry is unpinned. Counts a hit or a miss.
+		 *
+		 * @param key key to lookup
+		 * @return the value or nullptr when not found
+		 */
+		V* Find(const K& key);
+
+		/**
+		 * Checks whether an entry exists without touching it or
+		 * the statistics.
+		 *
+		 * @param key key to lookup
+		 * @return whether the entry exists
+		 */
+		bool Contains(const K& key) const;
+
+		/**
+		 * Adds an entry as the most recently used one. An existing entry with
+		 * the same key is replaced. Does not evict anything.
+		 *
+		 * @param key key of the entry
+		 * @param value value of the entry
+		 * @param size size of the entry in bytes
+		 * @return the stored value
+		 */
+		V& Insert(K key, V value, size_t size);
+
+		/**
+		 * Removes an entry.
+		 *
+		 * @param key key of the entry
+		 * @return whether an entry was removed
+		 */
+		bool Erase(const K& key);
+
+		/**
+		 * Evicts the least recently used entries until the size is within the
+		 * budget. Entries for which can_evict returns false are kept and
+		 * pinned, later calls do not check them again.
+		 *
+		 * @param can_evict predicate called with the value of an entry
+		 * @return amount of evicted entries
+		 */
+		template <typename F>
+		size_t Evict(F&& can_evict);
+
+		/**
+		 * Unpins the entries for which can_evict returns true, they become
+		 * the least recently used entries. O(number of pinned entries).
+		 *
+		 * @param can_evict predicate called with the value of a pinned entry
+		 * @return amount of unpinned entries
+		 */
+		template <typename F>
+		size_t Unpin(F&& can_evict);
+
+		/** Removes all entries, the statistics are kept */
+		void Clear();
+
+		/** @return sum of the size of all entries in bytes */
+		size_t GetSize() const;
+
+		/** @return amount of entries */
+		size_t GetCount() const;
+
+		/** @return amount of pinned entries */
+		size_t GetPinnedCount() const;
+
+		/** @return maximum size in bytes */
+		size_t GetBudget() const;
+
+		/**
+		 * Sets the maximum size. The cache is not trimmed until Evict is called.
+		 *
+		 * @param budget maximum size in bytes
+		 */
+		void SetBudget(size_t budget);
+
+		/** @return access statistics */
+		const Stats& GetStats() const;
+
+		/** Resets the access statistics */
+		void ResetStats();
+
+		/** @return iterator to the most recently used entry */
+		iterator begin() const;
+
+		/** @return iterator past the last entry, the pinned entries come last */
+		iterator end() const;
+
+	private:
+		/** Removes the entry from the pinned entries when it is one */
+		void Release(typename container_type::iterator it);
+
+		/** Evictable entries from most to least recently used, followed by the pinned ones */
+		container_type entries;
+		/** First pinned entry, end when there is none */
+		typename container_type::iterator pinned_begin = entries.end();
+		size_t pinned_count = 0;
+		std::unordered_map<K, typename container_type::iterator, Hash> index;
+		size_t size = 0;
+		size_t budget = 0;
+		Stats stats;
+};
+
+template <typename K, typename V, typename Hash>
+inline LruCache<K, V, Hash>::LruCache(size_t budget) : budget(budget) {
+}
+
+template <typename K, typename V, typename Hash>
+inline V* LruCache<K, V, Hash>::Find(const K& key) {
+	auto it = index.find(key);
+	if (it == index.end()) {
+		++stats.misses;
+		return nullptr;
+	}
+
+	++stats.hits;
+	Release(it->second);
+	entries.splice(entries.begin(), entries, it->second);
+	return &it->second->value;
+}
+
+template <typename K, typename V, typename Hash>
+inline bool LruCache<K, V, Hash>::Contains(const K& key) const {
+	return index.find(key) != index.end();
+}
+
+template <typename K, typename V, typename Hash>
+inline V& LruCache<K, V, Hash>::Insert(K key, V value, size_t entry_size) {
+	Erase(key);
+
+	entries.push_front({ key, std::move(value), entry_size });
+	index.emplace(std::move(key), entries.begin());
+	size += entry_size;
+
+	return entries.front().value;
+}
+
+template <typename K, typename V, typename Hash>
+inline bool LruCache<K, V, Hash>::Erase(const K& key) {
+	auto it = index.find(key);
+	if (it == index.end()) {
+		return false;
+	}
+
+	size -= it->second->size;
+	Release(it->second);
+	entries.erase(it->second);
+	index.erase(it);
+	return true;
+}
+
+template <typename K, typename V, typename Hash>
+inline void LruCache<K, V, Hash>::Release(typename container_type::iterator it) {
+	if (!it->pinned) {
+		return;
+	}
+
+	if (it == pinned_begin) {
+		++pinned_begin;
+	}
+	it->pinned = false;
+	--pinned_count;
+}
+
+template <typename K, typename V, typename Hash>
+template <typename F>
+inline size_t LruCache<K, V, Hash>::Evict(F&& can_evict) {
+	size_t evicted = 0;
+
+	while (size > budget && pinned_begin != entries.begin()) {
+		auto it = std::prev(pinned_begin);
+		if (!can_evict(static_cast<const V&>(it->value))) {
+			// Already in front of the pinned entries
+			it->pinned = true;
+			pinned_begin = it;
+			++pinned_count;
+			continue;
+		}
+
+		size -= it->size;
+		index.erase(it->key);
+		entries.erase(it);
+		++evicted;
+	}
+
+	stats.evictions += evicted;
+	return evicted;
+}
+
+template <typename K, typename V, typename Hash>
+template <typename F>
+inline size_t LruCache<K, V, Hash>::Unpin(F&& can_evict) {
+	size_t unpinned = 0;
+
+	for (auto it = pinned_begin; it != entries.end();) {
+		auto cur = it++;
+		if (!can_evict(static_cast<const V&>(cur->value))) {
+			continue;
+		}
+
+		// Becomes the least recently used evictable entry
+		const bool first = cur == pinned_begin;
+		Release(cur);
+		if (!first) {
+			entries.splice(pinned_begin, entries, cur);
+		}
+		++unpinned;
+	}
+
+	return unpinned;
+}
+
+template <typename K, typename V, typename Hash>
+inline void LruCache<K, V, Hash>::Clear() {
+	entries.clear();
+	index.clear();
+	size = 0;
+	pinned_begin = entries.end();
+	pinned_count = 0;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t LruCache<K, V, Hash>::GetSize() const {
+	return size;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t LruCache<K, V, Hash>::GetCount() const {
+	return entries.size();
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t LruCache<K, V, Hash>::GetPinnedCount() const {
+	return pinned_count;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t LruCache<K, V, Hash>::GetBudget() const {
+	return budget;
+}
+
+template <typename K, typename V, typename Hash>
+inline void LruCache<K, V, Hash>::SetBudget(size_t budget) {
+	this->budget = budget;
+}
+
+template <typename K, typename V, typename Hash>
+inline const typename LruCache<K, V, Hash>::Stats& LruCache<K, V, Hash>::GetStats() const {
+	return stats;
+}
+
+template <typename K, typename V, typename Hash>
+inline void LruCache<K, V, Hash>::ResetStats() {
+	stats = {};
+}
+
+template <typename K, typename V, typename Hash>
+inline typename LruCache<K, V, Hash>::iterator LruCache<K, V, Hash>::begin() const {
+	return entries.begin();
+}
+
+template <typename K, typename V, typename Hash>
+inline typename LruCache<K, V, Hash>::iterator LruCache<K, V, Hash>::end() const {
+	return entries.end();
+}
+
+#endif
@@ -26,13 +26,17 @@
 #include "game_party.h"
 #include "game_switches.h"
 #include "game_variables.h"
+#include "lru_cache.h"
 #include "main_data.h"
 #include "output.h"
 #include "player.h"
+#include "utils.h"
 
 #include <lcf/reader_lcf.h>
 #include <lcf/reader_util.h>
 #include <lcf/writer_lcf.h>
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 /*
@@ -177,431 +181,668 @@ struct ProcessAssignmentRet {
 	}
 };
 
-ProcessAssignmentRet ProcessAssignment(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator end, const Game_BaseInterpreterContext& ip);
+namespace {
+	/** Instructions of a compiled expression, they operate on a value stack */
+	enum class Code : uint8_t {
+		/** Pushes arg */
+		Push,
+		/** Replaces the id on the stack with the value of the Var, Switch, VarIndirect or SwitchIndirect op */
+		Load,
+		/** Like Load but the id is in arg */
+		LoadImm,
+		/** Applies op to the topmost value */
+		Unary,
+		/** Applies op to the two topmost values */
+		Binary,
+		/** Pops condition, true and false value and pushes one of them */
+		Ternary,
+		/** Pops an id and a value and assigns them with op to the target */
+		Inplace,
+		/** Pops argc arguments and calls the function in arg */
+		Call
+	};
 
-int Process(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator end, const Game_BaseInterpreterContext& ip) {
-	int value = 0;
-	int imm = 0;
-	int imm2 = 0;
-	int imm3 = 0;
+	struct Instr {
+		Code code = Code::Push;
+		uint8_t argc = 0;
+		Op op = Op::Null;
+		Op target = Op::Null;
+		int32_t arg = 0;
+	};
 
-	if (it == end) {
-		return 0;
+	/**
+	 * Expression in postfix form, the op codes are only decoded once.
+	 * Subexpressions without side effects and only constant operands are
+	 * folded into a single Push.
+	 */
+	struct CompiledExpression {
+		/** Op codes the expression was compiled from */
+		std::vector<int32_t> source;
+		bool multiple = false;
+		std::vector<Instr> code;
+		/** Amount of values left on the stack, one per expression */
+		int results = 0;
+		int max_depth = 0;
+	};
+
+	// Deeper expressions are evaluated on the heap
+	constexpr int stack_size = 64;
+
+	// Compiled expressions are looked up by the address of their op codes
+	constexpr size_t expression_cache_budget = 256 * 1024;
+	LruCache<const int32_t*, CompiledExpression> expression_cache(expression_cache_budget);
+
+	int32_t ClampInt32(int64_t value) {
+		return static_cast<int32_t>(Utils::Clamp<int64_t>(value, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
 	}
 
-	auto op = static_cast<Op>(*it);
-	++it;
+	int32_t Load(Op op, int32_t id) {
+		switch (op) {
+			case Op::Var:
+				return Main_Data::game_variables->Get(id);
+			case Op::Switch:
+				return Main_Data::game_switches->GetInt(id);
+			case Op::VarIndirect:
+				return Main_Data::game_variables->GetIndirect(id);
+			case Op::SwitchIndirect:
+				return Main_Data::game_switches->GetInt(Main_Data::game_variables->Get(id));
+			default:
+				return 0;
+		}
+	}
 
-	// When entering the switch it is on the first argument
-	switch (op) {
-		case Op::Null:
-			it++;
-			return 0;
-		case Op::U8:
-		case Op::UX8:
-			value = *it++;
-			return value;
-		case Op::U16:
-		case Op::UX16:
-			imm = *it++;
-			if (it == end) {
+	int32_t Unary(Op op, int32_t value) {
+		switch (op) {
+			case Op::Negate:
+				return -value;
+			case Op::Not:
+				return !value ? 0 : 1;
+			case Op::Flip:
+				return ~value;
+			default:
 				return 0;
-			}
-			imm2 = *it++;
-			value = (imm2 << 8) + imm;
-			return value;
-		case Op::S32:
-		case Op::SX32:
-			imm = *it++;
-			if (it == end) {
+		}
+	}
+
+	int32_t Binary(Op op, int32_t imm, int32_t imm2) {
+		switch (op) {
+			case Op::Add:
+				return ClampInt32(static_cast<int64_t>(imm) + imm2);
+			case Op::Sub:
+				return ClampInt32(static_cast<int64_t>(imm) - imm2);
+			case Op::Mul:
+				return ClampInt32(static_cast<int64_t>(imm) * imm2);
+			case Op::Div:
+				if (imm2 == 0) {
+					return imm;
+				}
+				return imm / imm2;
+			case Op::Mod:
+				if (imm2 == 0) {
+					return imm;
+				}
+				return imm % imm2;
+			case Op::BitOr:
+				return imm | imm2;
+			case Op::BitAnd:
+				return imm & imm2;
+			case Op::BitXor:
+				return imm ^ imm2;
+			case Op::BitShiftLeft:
+				return imm << imm2;
+			case Op::BitShiftRight:
+				return imm >> imm2;
+			case Op::Equal:
+				return imm == imm2 ? 1 : 0;
+			case Op::GreaterEqual:
+				return imm >= imm2 ? 1 : 0;
+			case Op::LessEqual:
+				return imm <= imm2 ? 1 : 0;
+			case Op::Greater:
+				return imm > imm2 ? 1 : 0;
+			case Op::Less:
+				return imm < imm2 ? 1 : 0;
+			case Op::NotEqual:
+				return imm != imm2 ? 1 : 0;
+			case Op::Or:
+				return !!imm || !!imm2 ? 1 : 0;
+			case Op::And:
+				return !!imm && !!imm2 ? 1 : 0;
+			default:
 				return 0;
-			}
-			imm2 = *it++;
-			if (it == end) {
+		}
+	}
+
+	int32_t Assign(Op op, const ProcessAssignmentRet& ret, int32_t imm2) {
+		switch (op) {
+			case Op::AssignInplace:
+				return ret.assign(imm2);
+			case Op::AddInplace:
+				return ret.assign(ClampInt32(static_cast<int64_t>(ret.fetch()) + imm2));
+			case Op::SubInplace:
+				return ret.assign(ClampInt32(static_cast<int64_t>(ret.fetch()) - imm2));
+			case Op::MulInplace:
+				return ret.assign(ClampInt32(static_cast<int64_t>(ret.fetch()) * imm2));
+			case Op::DivInplace:
+				if (imm2 == 0) {
+					return ret.fetch();
+				}
+				return ret.assign(ret.fetch() / imm2);
+			case Op::ModInplace:
+				if (imm2 == 0) {
+					return ret.fetch();
+				}
+				return ret.assign(ret.fetch() % imm2);
+			case Op::BitOrInplace:
+				return ret.assign(ret.fetch() | imm2);
+			case Op::BitAndInplace:
+				return ret.assign(ret.fetch() & imm2);
+			case Op::BitXorInplace:
+				return ret.assign(ret.fetch() ^ imm2);
+			case Op::BitShiftLeftInplace:
+				return ret.assign(ret.fetch() << imm2);
+			case Op::BitShiftRightInplace:
+				return ret.assign(ret.fetch() >> imm2);
+			default:
 				return 0;
-			}
-			imm3 = *it++;
-			if (it == end) {
+		}
+	}
+
+	/** @return name used in warnings and the argument count of a function, -1 when unknown */
+	std::pair<const char*, int> GetFunctionSignature(Fn fn) {
+		switch (fn) {
+			case Fn::Rand: return {"rnd", 2};
+			case Fn::Item: return {"item", 2};
+			case Fn::Event: return {"event", 2};
+			case Fn::Actor: return {"actor", 2};
+			case Fn::Party: return {"member", 2};
+			case Fn::Enemy: return {"enemy", 2};
+			case Fn::Misc: return {"misc", 1};
+			case Fn::Pow: return {"pow", 2};
+			case Fn::Sqrt: return {"sqrt", 2};
+			case Fn::Sin: return {"sin", 3};
+			case Fn::Cos: return {"cos", 3};
+			case Fn::Atan2: return {"atan2", 3};
+			case Fn::Min: return {"min", 2};
+			case Fn::Max: return {"max", 2};
+			case Fn::Abs: return {"abs", 1};
+			case Fn::Clamp: return {"clamp", 3};
+			case Fn::Muldiv: return {"muldiv", 3};
+			case Fn::Divmul: return {"divmul", 3};
+			case Fn::Between: return {"between", 3};
+		}
+		return {nullptr, -1};
+	}
+
+	/** @return whether the result of the function only depends on the arguments */
+	bool IsPureFunction(Fn fn) {
+		switch (fn) {
+			case Fn::Rand:
+			case Fn::Item:
+			case Fn::Event:
+			case Fn::Actor:
+			case Fn::Party:
+			case Fn::Enemy:
+			case Fn::Misc:
+				return false;
+			default:
+				return GetFunctionSignature(fn).second >= 0;
+		}
+	}
+
+	/**
+	 * Calls a function. The arguments are stored in reverse order in the
+	 * op codes, args[argc - 1] is the first argument.
+	 */
+	int32_t CallPure(Fn fn, const int32_t* args, int argc) {
+		auto arg = [&](int i) { return args[argc - 1 - i]; };
+
+		switch (fn) {
+			case Fn::Pow:
+				return ControlVariables::Pow(arg(0), arg(1));
+			case Fn::Sqrt:
+				return ControlVariables::Sqrt(arg(0), arg(1));
+			case Fn::Sin:
+				return ControlVariables::Sin(arg(0), arg(1), arg(2));
+			case Fn::Cos:
+				return ControlVariables::Cos(arg(0), arg(1), arg(2));
+			case Fn::Atan2:
+				return ControlVariables::Atan2(arg(0), arg(1), arg(2));
+			case Fn::Min:
+				return ControlVariables::Min(arg(0), arg(1));
+			case Fn::Max:
+				return ControlVariables::Max(arg(0), arg(1));
+			case Fn::Abs:
+				return ControlVariables::Abs(arg(0));
+			case Fn::Clamp:
+				return ControlVariables::Clamp(arg(0), arg(1), arg(2));
+			case Fn::Muldiv:
+				return ControlVariables::Muldiv(arg(0), arg(1), arg(2));
+			case Fn::Divmul:
+				return ControlVariables::Divmul(arg(0), arg(1), arg(2));
+			case Fn::Between:
+				return ControlVariables::Between(arg(0), arg(1), arg(2));
+			default:
 				return 0;
+		}
+	}
+
+	/** Like CallPure but also handles the functions which access the game state */
+	int32_t Call(Fn fn, const int32_t* args, int argc, const Game_BaseInterpreterContext& ip) {
+		auto arg = [&](int i) { return args[argc - 1 - i]; };
+
+		switch (fn) {
+			case Fn::Rand:
+				return ControlVariables::Random(arg(0), arg(1));
+			case Fn::Item:
+				return ControlVariables::Item(arg(0), arg(1));
+			case Fn::Event:
+				return ControlVariables::Event(arg(0), arg(1), ip);
+			case Fn::Actor:
+				return ControlVariables::Actor(arg(0), arg(1));
+			case Fn::Party:
+				return ControlVariables::Party(arg(0), arg(1));
+			case Fn::Enemy:
+				return ControlVariables::Enemy(arg(0), arg(1));
+			case Fn::Misc:
+				return ControlVariables::Other(arg(0));
+			default:
+				return CallPure(fn, args, argc);
+		}
+	}
+
+	/** Translates the op codes into postfix instructions, consuming them like the Maniac Patch does */
+	class ExpressionCompiler {
+	public:
+		ExpressionCompiler(Span<const int32_t> op_codes, CompiledExpression& out);
+
+		/** Compiles the next expression */
+		void Compile();
+
+		/** @return whether there are no further expressions */
+		bool IsDone() const;
+
+	private:
+		bool AtEnd() const;
+		int32_t Read();
+
+		Op CompileAssignment();
+		void CompileFunction();
+
+		void Emit(const Instr& instr, int pops);
+		void EmitPush(int32_t value);
+
+		/** @return whether the topmost n values on the stack are constants */
+		bool IsConstant(int n) const;
+		int32_t PopConstant();
+
+		std::vector<int32_t> bytes;
+		size_t pos = 0;
+		int depth = 0;
+		CompiledExpression& out;
+	};
+
+	ExpressionCompiler::ExpressionCompiler(Span<const int32_t> op_codes, CompiledExpression& out) : out(out) {
+		bytes.reserve(op_codes.size() * 4);
+		for (auto& o: op_codes) {
+			auto uo = static_cast<uint32_t>(o);
+			bytes.push_back(static_cast<int32_t>(uo & 0x000000FF));
+			bytes.push_back(static_cast<int32_t>((uo & 0x0000FF00) >> 8));
+			bytes.push_back(static_cast<int32_t>((uo & 0x00FF0000) >> 16));
+			bytes.push_back(static_cast<int32_t>((uo & 0xFF000000) >> 24));
+		}
+	}
+
+	bool ExpressionCompiler::IsDone() const {
+		return AtEnd() || static_cast<Op>(bytes[pos]) == Op::Null;
+	}
+
+	bool ExpressionCompiler::AtEnd() const {
+		return pos >= bytes.size();
+	}
+
+	int32_t ExpressionCompiler::Read() {
+		return AtEnd() ? 0 : bytes[pos++];
+	}
+
+	void ExpressionCompiler::Emit(const Instr& instr, int pops) {
+		out.code.push_back(instr);
+		depth += 1 - pops;
+		out.max_depth = std::max(out.max_depth, depth);
+	}
+
+	void ExpressionCompiler::EmitPush(int32_t value) {
+		Instr instr;
+		instr.arg = value;
+		Emit(instr, 0);
+	}
+
+	bool ExpressionCompiler::IsConstant(int n) const {
+		// Every Push is a complete subexpression, so the last n instructions produced the topmost n values
+		if (static_cast<int>(out.code.size()) < n) {
+			return false;
+		}
+		return std::all_of(out.code.end() - n, out.code.end(), [](const Instr& instr) { return instr.code == Code::Push; });
+	}
+
+	int32_t ExpressionCompiler::PopConstant() {
+		int32_t value = out.code.back().arg;
+		out.code.pop_back();
+		--depth;
+		return value;
+	}
+
+	void ExpressionCompiler::Compile() {
+		if (AtEnd()) {
+			EmitPush(0);
+			return;
+		}
+
+		auto op = static_cast<Op>(Read());
+
+		// When entering the switch it is on the first argument
+		switch (op) {
+			case Op::Null:
+				Read();
+				EmitPush(0);
+				return;
+			case Op::U8:
+			case Op::UX8:
+				EmitPush(Read());
+				return;
+			case Op::U16:
+			case Op::UX16: {
+				uint32_t imm = Read();
+				if (AtEnd()) {
+					EmitPush(0);
+					return;
+				}
+				uint32_t imm2 = Read();
+				EmitPush(static_cast<int32_t>((imm2 << 8) + imm));
+				return;
 			}
-			value = *it++;
-			value = (value << 24) + (imm3 << 16) + (imm2 << 8) + imm;
-			return value;
-		case Op::Var:
-			imm = Process(it, end, ip);
-			return Main_Data::game_variables->Get(imm);
-		case Op::Switch:
-			imm = Process(it, end, ip);
-			return Main_Data::game_switches->GetInt(imm);
-		case Op::VarIndirect:
-			imm = Process(it, end, ip);
-			return Main_Data::game_variables->GetIndirect(imm);
-		case Op::SwitchIndirect:
-			imm = Process(it, end, ip);
-			return Main_Data::game_switches->GetInt(Main_Data::game_variables->Get(imm));
-		case Op::Negate:
-			imm = Process(it, end, ip);
-			return -imm;
-		case Op::Not:
-			imm = Process(it, end, ip);
-			return !imm ? 0 : 1;
-		case Op::Flip:
-			imm = Process(it, end, ip);
-			return ~imm;
-		case Op::AssignInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(imm2);
-		}
-		case Op::AddInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(ret.fetch()) + imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max())));
-		}
-		case Op::SubInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(ret.fetch()) - imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max())));
-		}
-		case Op::MulInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(ret.fetch()) * imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max())));
-		}
-		case Op::DivInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			if (imm2 == 0) {
-				return ret.fetch();
+			case Op::S32:
+			case Op::SX32: {
+				uint32_t value = 0;
+				for (int i = 0; i < 3; ++i) {
+					value |= static_cast<uint32_t>(Read()) << (i * 8);
+					if (AtEnd()) {
+						EmitPush(0);
+						return;
+					}
+				}
+				value |= static_cast<uint32_t>(Read()) << 24;
+				EmitPush(static_cast<int32_t>(value));
+				return;
 			}
-			return ret.assign(ret.fetch() / imm2);
-		}
-		case Op::ModInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			if (imm2 == 0) {
-				return ret.fetch();
+			case Op::Var:
+			case Op::Switch:
+			case Op::VarIndirect:
+			case Op::SwitchIndirect: {
+				Compile();
+				Instr instr;
+				instr.op = op;
+				if (IsConstant(1)) {
+					instr.code = Code::LoadImm;
+					instr.arg = PopConstant();
+					Emit(instr, 0);
+				} else {
+					instr.code = Code::Load;
+					Emit(instr, 1);
+				}
+				return;
 			}
-			return ret.assign(ret.fetch() % imm2);
-		}
-		case Op::BitOrInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(ret.fetch() | imm2);
-		}
-		case Op::BitAndInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(ret.fetch() & imm2);
-		}
-		case Op::BitXorInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(ret.fetch() ^ imm2);
-		}
-		case Op::BitShiftLeftInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(ret.fetch() << imm2);
-		}
-		case Op::BitShiftRightInplace: {
-			auto ret = ProcessAssignment(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return ret.assign(ret.fetch() >> imm2);
-		}
-		case Op::Add:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) + imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
-		case Op::Sub:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) - imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
-		case Op::Mul:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return static_cast<int32_t>(Utils::Clamp<int64_t>(static_cast<int64_t>(imm) * imm2, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
-		case Op::Div:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			if (imm2 == 0) {
-				return imm;
+			case Op::Negate:
+			case Op::Not:
+			case Op::Flip: {
+				Compile();
+				if (IsConstant(1)) {
+					EmitPush(Unary(op, PopConstant()));
+					return;
+				}
+				Instr instr;
+				instr.code = Code::Unary;
+				instr.op = op;
+				Emit(instr, 1);
+				return;
 			}
-			return imm / imm2;
-		case Op::Mod:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			if (imm2 == 0) {
-				return imm;
+			case Op::AssignInplace:
+			case Op::AddInplace:
+			case Op::SubInplace:
+			case Op::MulInplace:
+			case Op::DivInplace:
+			case Op::ModInplace:
+			case Op::BitOrInplace:
+			case Op::BitAndInplace:
+			case Op::BitXorInplace:
+			case Op::BitShiftLeftInplace:
+			case Op::BitShiftRightInplace: {
+				Instr instr;
+				instr.code = Code::Inplace;
+				instr.op = op;
+				instr.target = CompileAssignment();
+				Compile();
+				Emit(instr, 2);
+				return;
 			}
-			return imm % imm2;
-		case Op::BitOr:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm | imm2;
-		case Op::BitAnd:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm & imm2;
-		case Op::BitXor:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm ^ imm2;
-		case Op::BitShiftLeft:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm << imm2;
-		case Op::BitShiftRight:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm >> imm2;
-		case Op::Equal:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm == imm2 ? 1 : 0;
-		case Op::GreaterEqual:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm >= imm2 ? 1 : 0;
-		case Op::LessEqual:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm <= imm2 ? 1 : 0;
-		case Op::Greater:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm > imm2 ? 1 : 0;
-		case Op::Less:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm < imm2 ? 1 : 0;
-		case Op::NotEqual:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return imm != imm2 ? 1 : 0;
-		case Op::Or:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return !!imm || !!imm2 ? 1 : 0;
-		case Op::And:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			return !!imm && !!imm2 ? 1 : 0;
-		case Op::Ternary:
-			imm = Process(it, end, ip);
-			imm2 = Process(it, end, ip);
-			imm3 = Process(it, end, ip);
-			return imm != 0 ? imm2 : imm3;
-		case Op::Function:
-			imm = *it++; // function
-			imm2 = *it++; // arguments
-
-			if ((imm2 & 0x80) != 0) {
-				// Argument count is 4 bytes, that mode is not supported
-				Output::Warning("Maniac: Expression func long args unsupported");
-				return 0;
+			case Op::Add:
+			case Op::Sub:
+			case Op::Mul:
+			case Op::Div:
+			case Op::Mod:
+			case Op::BitOr:
+			case Op::BitAnd:
+			case Op::BitXor:
+			case Op::BitShiftLeft:
+			case Op::BitShiftRight:
+			case Op::Equal:
+			case Op::GreaterEqual:
+			case Op::LessEqual:
+			case Op::Greater:
+			case Op::Less:
+			case Op::NotEqual:
+			case Op::Or:
+			case Op::And: {
+				Compile();
+				Compile();
+				if (IsConstant(2)) {
+					int32_t imm2 = PopConstant();
+					int32_t imm = PopConstant();
+					EmitPush(Binary(op, imm, imm2));
+					return;
+				}
+				Instr instr;
+				instr.code = Code::Binary;
+				instr.op = op;
+				Emit(instr, 2);
+				return;
 			}
+			case Op::Ternary: {
+				Compile();
+				Compile();
+				Compile();
+				if (IsConstant(3)) {
+					int32_t imm3 = PopConstant();
+					int32_t imm2 = PopConstant();
+					int32_t imm = PopConstant();
+					EmitPush(imm != 0 ? imm2 : imm3);
+					return;
+				}
+				Instr instr;
+				instr.code = Code::Ternary;
+				Emit(instr, 3);
+				return;
+			}
+			case Op::Function:
+				CompileFunction();
+				return;
+			default:
+				Output::Warning("Maniac: Expression contains unsupported operation {}", static_cast<int>(op));
+				EmitPush(0);
+				return;
+		}
+	}
 
-			switch (static_cast<Fn>(imm)) {
-				case Fn::Rand:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression rnd args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Random(Process(it, end, ip), imm3);
-				case Fn::Item:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression item args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Item(Process(it, end, ip), imm3);
-				case Fn::Event:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression event args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Event(Process(it, end, ip), imm3, ip);
-				case Fn::Actor:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression actor args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Actor(Process(it, end, ip), imm3);
-				case Fn::Party:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression member args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Party(Process(it, end, ip), imm3);
-				case Fn::Enemy:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression enemy args {} != 2", imm2);
-						return 0;
-					}
-					imm3 = Process(it, end, ip);
-					return ControlVariables::Enemy(Process(it, end, ip), imm3);
-					break;
-				case Fn::Misc:
-					if (imm2 != 1) {
-						Output::Warning("Maniac: Expression misc args {} != 1", imm2);
-						return 0;
-					}
-					return ControlVariables::Other(Process(it, end, ip));
-				case Fn::Pow:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression pow args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Pow(Process(it, end, ip), Process(it, end, ip));
-				case Fn::Sqrt:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression sqrt args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Sqrt(Process(it, end, ip), Process(it, end, ip));
-				case Fn::Sin:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression sin args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Sin(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Cos:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression cos args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Cos(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Atan2:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression atan2 args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Atan2(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Min:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression min args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Min(Process(it, end, ip), Process(it, end, ip));
-				case Fn::Max:
-					if (imm2 != 2) {
-						Output::Warning("Maniac: Expression max args {} != 2", imm2);
-						return 0;
-					}
-					return ControlVariables::Max(Process(it, end, ip), Process(it, end, ip));
-				case Fn::Abs:
-					if (imm2 != 1) {
-						Output::Warning("Maniac: Expression abs args {} != 1", imm2);
-						return 0;
-					}
-					return ControlVariables::Abs(Process(it, end, ip));
-				case Fn::Clamp:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression clamp args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Clamp(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Muldiv:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression muldiv args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Muldiv(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Divmul:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression divmul args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Divmul(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				case Fn::Between:
-					if (imm2 != 3) {
-						Output::Warning("Maniac: Expression between args {} != 3", imm2);
-						return 0;
-					}
-					return ControlVariables::Between(Process(it, end, ip), Process(it, end, ip), Process(it, end, ip));
-				default:
-					Output::Warning("Maniac: Expression Unknown Func {}", imm);
-					for (int i = 0; i < imm2; ++i) {
-						Process(it, end, ip);
-					}
-					return 0;
+	Op ExpressionCompiler::CompileAssignment() {
+		// Like Compile but it remembers the type (Variable or Switch) without loading it to allow assignments
+		if (AtEnd()) {
+			EmitPush(0);
+			return Op::Null;
+		}
+
+		auto op = static_cast<Op>(bytes[pos]);
+		switch (op) {
+			case Op::Var:
+			case Op::Switch:
+			case Op::VarIndirect:
+			case Op::SwitchIndirect:
+				++pos;
+				Compile();
+				return op;
+			default:
+				// Not a lvalue, the assignment warns when executed
+				Compile();
+				return op;
+		}
+	}
+
+	void ExpressionCompiler::CompileFunction() {
+		auto fn = static_cast<Fn>(Read());
+		int argc = Read();
+
+		if ((argc & 0x80) != 0) {
+			// Argument count is 4 bytes, that mode is not supported
+			Output::Warning("Maniac: Expression func long args unsupported");
+			EmitPush(0);
+			return;
+		}
+
+		auto [name, expected] = GetFunctionSignature(fn);
+		if (expected < 0) {
+			Output::Warning("Maniac: Expression Unknown Func {}", static_cast<int>(fn));
+		} else if (argc != expected) {
+			// The arguments are not consumed
+			Output::Warning("Maniac: Expression {} args {} != {}", name, argc, expected);
+			EmitPush(0);
+			return;
+		}
+
+		for (int i = 0; i < argc; ++i) {
+			Compile();
+		}
+
+		if (IsPureFunction(fn) && IsConstant(argc)) {
+			std::array<int32_t, 3> args;
+			for (int i = argc - 1; i >= 0; --i) {
+				args[i] = PopConstant();
 			}
-		default:
-			Output::Warning("Maniac: Expression contains unsupported operation {}", static_cast<int>(op));
-			return 0;
+			EmitPush(CallPure(fn, args.data(), argc));
+			return;
+		}
+
+		Instr instr;
+		instr.code = Code::Call;
+		instr.argc = static_cast<uint8_t>(argc);
+		instr.arg = static_cast<int32_t>(fn);
+		Emit(instr, argc);
 	}
-}
 
-ProcessAssignmentRet ProcessAssignment(std::vector<int32_t>::iterator& it, std::vector<int32_t>::iterator end, const Game_BaseInterpreterContext& ip) {
-	// Like process but it remembers the type (Variable or Switch) without evaluating it to allow assignments
-	int imm = 0;
+	CompiledExpression CompileExpression(Span<const int32_t> op_codes, bool multiple) {
+		CompiledExpression expr;
+		expr.source.assign(op_codes.begin(), op_codes.end());
+		expr.multiple = multiple;
+
+		ExpressionCompiler compiler(op_codes, expr);
+		do {
+			compiler.Compile();
+			++expr.results;
+		} while (multiple && !compiler.IsDone());
 
-	if (it == end) {
-		return {Op::Null, 0};
+		return expr;
 	}
 
-	auto op = static_cast<Op>(*it);
-	++it;
+	const CompiledExpression& GetExpression(Span<const int32_t> op_codes, bool multiple) {
+		auto* expr = expression_cache.Find(op_codes.data());
+		if (expr && expr->multiple == multiple &&
+				std::equal(expr->source.begin(), expr->source.end(), op_codes.begin(), op_codes.end())) {
+			return *expr;
+		}
 
-	// When entering the switch it is on the first argument
-	switch (op) {
-		case Op::Var:
-		case Op::Switch:
-		case Op::VarIndirect:
-		case Op::SwitchIndirect:
-			imm = Process(it, end, ip);
-			return {op, imm};
-		default:
-			--it; // back on the op as op is fetched again by Process
-			imm = Process(it, end, ip);
-			return {op, imm};
+		auto compiled = CompileExpression(op_codes, multiple);
+		size_t size = sizeof(CompiledExpression) + compiled.source.size() * sizeof(int32_t) + compiled.code.size() * sizeof(Instr);
+
+		expression_cache.Evict([](const CompiledExpression&) { return true; });
+		return expression_cache.Insert(op_codes.data(), std::move(compiled), size);
 	}
-}
 
-int32_t ManiacPatch::ParseExpression(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter) {
-	std::vector<int32_t> ops;
-	for (auto &o: op_codes) {
-		auto uo = static_cast<uint32_t>(o);
-		ops.push_back(static_cast<int32_t>(uo & 0x000000FF));
-		ops.push_back(static_cast<int32_t>((uo & 0x0000FF00) >> 8));
-		ops.push_back(static_cast<int32_t>((uo & 0x00FF0000) >> 16));
-		ops.push_back(static_cast<int32_t>((uo & 0xFF000000) >> 24));
-	}
-	auto beg = ops.begin();
-	return Process(beg, ops.end(), interpreter);
-}
+	/** Runs the instructions, the results are at the bottom of the stack afterwards */
+	void Execute(const CompiledExpression& expr, int32_t* stack, const Game_BaseInterpreterContext& ip) {
+		int32_t* sp = stack;
 
-std::vector<int32_t> ManiacPatch::ParseExpressions(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter) {
-	std::vector<int32_t> ops;
-	for (auto& o : op_codes) {
-		auto uo = static_cast<uint32_t>(o);
-		ops.push_back(static_cast<int32_t>(uo & 0x000000FF));
-		ops.push_back(static_cast<int32_t>((uo & 0x0000FF00) >> 8));
-		ops.push_back(static_cast<int32_t>((uo & 0x00FF0000) >> 16));
-		ops.push_back(static_cast<int32_t>((uo & 0xFF000000) >> 24));
+		for (const auto& instr: expr.code) {
+			switch (instr.code) {
+				case Code::Push:
+					*sp++ = instr.arg;
+					break;
+				case Code::Load:
+					sp[-1] = Load(instr.op, sp[-1]);
+					break;
+				case Code::LoadImm:
+					*sp++ = Load(instr.op, instr.arg);
+					break;
+				case Code::Unary:
+					sp[-1] = Unary(instr.op, sp[-1]);
+					break;
+				case Code::Binary:
+					--sp;
+					sp[-1] = Binary(instr.op, sp[-1], sp[0]);
+					break;
+				case Code::Ternary:
+					sp -= 2;
+					sp[-1] = sp[-1] != 0 ? sp[0] : sp[1];
+					break;
+				case Code::Inplace:
+					--sp;
+					sp[-1] = Assign(instr.op, {instr.target, sp[-1]}, sp[0]);
+					break;
+				case Code::Call:
+					sp -= instr.argc;
+					*sp = Call(static_cast<Fn>(instr.arg), sp, instr.argc, ip);
+					++sp;
+					break;
+			}
+		}
 	}
+}
 
-	if (ops.empty()) {
-		return {};
+int32_t ManiacPatch::ParseExpression(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter) {
+	if (op_codes.empty()) {
+		return 0;
 	}
 
-	auto it = ops.begin();
+	const auto& expr = GetExpression(op_codes, false);
 
-	std::vector<int32_t> results;
+	std::array<int32_t, stack_size> stack;
+	if (expr.max_depth <= stack_size) {
+		Execute(expr, stack.data(), interpreter);
+		return stack[0];
+	}
 
-	while (true) {
-		results.push_back(Process(it, ops.end(), interpreter));
+	std::vector<int32_t> heap_stack(expr.max_depth);
+	Execute(expr, heap_stack.data(), interpreter);
+	return heap_stack[0];
+}
 
-		if (it == ops.end() || static_cast<Op>(*it) == Op::Null) {
-			break;
-		}
+std::vector<int32_t> ManiacPatch::ParseExpressions(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter) {
+	if (op_codes.empty()) {
+		return {};
 	}
 
+	const auto& expr = GetExpression(op_codes, true);
+
+	std::vector<int32_t> results(std::max(expr.max_depth, stack_size));
+	Execute(expr, results.data(), interpreter);
+	results.resize(expr.results);
 	return results;
 }
 
@@ -28,7 +28,24 @@
 class Game_BaseInterpreterContext;
 
 namespace ManiacPatch {
+	/**
+	 * Evaluates an expression.
+	 * The op codes are compiled on first use and the compiled form is cached
+	 * by their address, so they should be owned by an event command.
+	 *
+	 * @param op_codes expression op codes
+	 * @param interpreter interpreter evaluating the expression
+	 * @return result of the expression
+	 */
 	int32_t ParseExpression(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter);
+
+	/**
+	 * Like ParseExpression but evaluates a list of expressions.
+	 *
+	 * @param op_codes expression op codes
+	 * @param interpreter interpreter evaluating the expressions
+	 * @return results of all expressions
+	 */
 	std::vector<int32_t> ParseExpressions(Span<const int32_t> op_codes, const Game_BaseInterpreterContext& interpreter);
 
 	std::array<bool, 50> GetKeyRange();
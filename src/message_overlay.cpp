@@ -23,12 +23,24 @@
 #include "game_message.h"
 #include "drawable_mgr.h"
 #include "baseui.h"
+#include "damage_region.h"
 
 MessageOverlay::MessageOverlay() : Drawable(Priority_Overlay, Drawable::Flags::Global)
 {
 	// Graphics::RegisterDrawable is in the Update function
 }
 
+std::optional<uint64_t> MessageOverlay::GetDamageState(Rect& bounds) {
+	if (!bitmap || (!IsAnyMessageVisible() && !show_all)) {
+		bounds = Rect();
+		return 0;
+	}
+
+	bounds = Rect(ox, oy, bitmap->GetWidth(), bitmap->GetHeight());
+
+	return DamageHash().Add(bitmap->GetRevision()).Add(dirty).Get();
+}
+
 void MessageOverlay::Draw(Bitmap& dst) {
 	if (!IsAnyMessageVisible() && !show_all) {
 		// Don't render overlay when no message visible
@@ -45,6 +45,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
+
 	void Update();
 
 	void AddMessage(const std::string& message, Color color);
@@ -63,6 +63,7 @@ namespace {
 
 	bool ignore_pause = false;
 	bool colored_log = true;
+	thread_local bool thread_muted = false;
 
 	// pair of repeat count + message
 	struct {
@@ -109,6 +110,10 @@ std::string Output::LogLevelToString(LogLevel lvl) {
 	return log_prefix[static_cast<int>(lvl)];
 }
 
+void Output::SetThreadMuted(bool muted) {
+	thread_muted = muted;
+}
+
 LogLevel Output::GetLogLevel() {
 	return log_level;
 }
@@ -136,6 +141,10 @@ void Output::SetLogCallback(LogCallbackFn fn, LogCallbackUserData userdata) {
 }
 
 static void WriteLog(LogLevel lvl, std::string const& msg, Color const& c = Color()) {
+	if (thread_muted) {
+		return;
+	}
+
 // skip writing log file
 #ifndef __EMSCRIPTEN__
 	std::string prefix = Output::LogLevelToString(lvl) + ": ";
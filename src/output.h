@@ -119,6 +119,14 @@ namespace Output {
 	/** @return the Loglevel as string */
 	std::string LogLevelToString(LogLevel lvl);
 
+	/**
+	 * Discards all messages logged by the calling thread.
+	 * Used by worker threads because the log is not thread-safe.
+	 *
+	 * @param muted whether to discard the messages
+	 */
+	void SetThreadMuted(bool muted);
+
 	/**
 	 * Displays an info string with formatted string.
 	 *
@@ -0,0 +1,219 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pathfinder.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+	struct Step {
+		int dx;
+		int dy;
+		int direction;
+	};
+
+	// Same order and direction values as Game_Character::Direction
+	constexpr Step steps[] = {
+		{ 1, 0, 1 }, // Right
+		{ 0, -1, 0 }, // Up
+		{ -1, 0, 3 }, // Left
+		{ 0, 1, 2 }, // Down
+		{ -1, 1, 6 }, // DownLeft
+		{ 1, -1, 4 }, // UpRight
+		{ -1, -1, 7 }, // UpLeft
+		{ 1, 1, 5 }, // DownRight
+	};
+
+	struct Node {
+		// Nodes of older searches are treated as unvisited
+		uint32_t generation = 0;
+		int g = 0;
+		int parent = -1;
+		int8_t direction = -1;
+		bool closed = false;
+	};
+
+	struct OpenEntry {
+		int f;
+		int h;
+		int g;
+		uint32_t seq;
+		int index;
+	};
+
+	// Lowest f first, ties prefer nodes closer to the destination, then FIFO
+	bool operator<(const OpenEntry& a, const OpenEntry& b) {
+		if (a.f != b.f) return a.f > b.f;
+		if (a.h != b.h) return a.h > b.h;
+		return a.seq > b.seq;
+	}
+
+	std::vector<Node> nodes;
+	std::vector<OpenEntry> open;
+	uint32_t generation = 0;
+	int budget = Pathfinder::frame_budget;
+
+	int Wrap(int v, int size, bool loop) {
+		if (loop) {
+			v %= size;
+			return v < 0 ? v + size : v;
+		}
+		return v;
+	}
+
+	int AxisDistance(int a, int b, int size, bool loop) {
+		int d = std::abs(a - b);
+		return loop ? std::min(d, size - d) : d;
+	}
+
+	void NextGeneration(size_t size) {
+		if (nodes.size() != size) {
+			nodes.assign(size, {});
+			generation = 0;
+		}
+
+		++generation;
+		if (generation == 0) {
+			// Wrapped around, old stamps could match again
+			std::fill(nodes.begin(), nodes.end(), Node());
+			generation = 1;
+		}
+	}
+}
+
+Pathfinder::Result Pathfinder::FindPath(const Args& args, const CheckWayFn& check_way) {
+	Result result;
+
+	const int width = args.width;
+	const int height = args.height;
+	if (width <= 0 || height <= 0) {
+		return result;
+	}
+
+	const int start_x = Wrap(args.start_x, width, args.loop_horizontal);
+	const int start_y = Wrap(args.start_y, height, args.loop_vertical);
+	if (start_x < 0 || start_x >= width || start_y < 0 || start_y >= height) {
+		return result;
+	}
+	const int dest_x = Wrap(args.dest_x, width, args.loop_horizontal);
+	const int dest_y = Wrap(args.dest_y, height, args.loop_vertical);
+
+	auto tile_distance = [&](int x, int y, int& dx, int& dy) {
+		dx = AxisDistance(x, dest_x, width, args.loop_horizontal);
+		dy = AxisDistance(y, dest_y, height, args.loop_vertical);
+	};
+
+	// Every step costs 1, a diagonal step covers both axes at once
+	auto heuristic = [&](int x, int y) {
+		int dx, dy;
+		tile_distance(x, y, dx, dy);
+		return args.allow_diagonal ? std::max(dx, dy) : dx + dy;
+	};
+
+	NextGeneration(static_cast<size_t>(width) * height);
+	open.clear();
+	uint32_t seq = 0;
+
+	const int start_index = start_y * width + start_x;
+	nodes[start_index] = { generation, 0, -1, -1, false };
+	int h = heuristic(start_x, start_y);
+	open.push_back({ h, h, 0, seq++, start_index });
+
+	int best_index = start_index;
+	int best_distance = std::numeric_limits<int>::max();
+	const int num_steps = args.allow_diagonal ? 8 : 4;
+
+	while (!open.empty() && result.expanded < args.search_max) {
+		std::pop_heap(open.begin(), open.end());
+		const OpenEntry entry = open.back();
+		open.pop_back();
+
+		auto& node = nodes[entry.index];
+		if (node.closed || node.g != entry.g) {
+			// Superseded by a shorter path
+			continue;
+		}
+		node.closed = true;
+		++result.expanded;
+		--budget;
+
+		const int x = entry.index % width;
+		const int y = entry.index / width;
+
+		int dx, dy;
+		tile_distance(x, y, dx, dy);
+		if (dx + dy < best_distance) {
+			best_distance = dx + dy;
+			best_index = entry.index;
+		}
+		if (x == dest_x && y == dest_y) {
+			result.reached = true;
+			break;
+		}
+
+		for (int i = 0; i < num_steps; ++i) {
+			const auto& step = steps[i];
+			const int to_x = x + step.dx;
+			const int to_y = y + step.dy;
+			const int nx = Wrap(to_x, width, args.loop_horizontal);
+			const int ny = Wrap(to_y, height, args.loop_vertical);
+			if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
+				continue;
+			}
+
+			const int index = ny * width + nx;
+			auto& next = nodes[index];
+			const bool visited = next.generation == generation;
+			if (visited && next.closed) {
+				continue;
+			}
+
+			const bool diagonal = step.dx != 0 && step.dy != 0;
+			const int g = node.g + 1;
+			if (visited && g >= next.g) {
+				continue;
+			}
+
+			if (!check_way(x, y, to_x, to_y)) {
+				continue;
+			}
+			if (diagonal && !check_way(x, y, to_x, y) && !check_way(x, y, x, to_y)) {
+				continue;
+			}
+
+			next = { generation, g, entry.index, static_cast<int8_t>(step.direction), false };
+			h = heuristic(nx, ny);
+			open.push_back({ g + h, h, g, seq++, index });
+			std::push_heap(open.begin(), open.end());
+		}
+	}
+
+	for (int index = best_index; nodes[index].parent >= 0; index = nodes[index].parent) {
+		result.directions.push_back(nodes[index].direction);
+	}
+	std::reverse(result.directions.begin(), result.directions.end());
+
+	return result;
+}
+
+void Pathfinder::ResetFrameBudget() {
+	budget = frame_budget;
+}
+
+bool Pathfinder::HasFrameBudget() {
+	return budget > 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_PATHFINDER_H
+#define EP_PATHFINDER_H
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+/**
+ * A* search on the tile grid of a map.
+ *
+ * The nodes live in a flat arena of the size of the map which is reused
+ * by all searches, so a search only touches the tiles it visits.
+ */
+namespace Pathfinder {
+	/** Node expansions all searches of a frame may use together */
+	constexpr int frame_budget = 100000;
+
+	/**
+	 * Passability of a single step. The target coordinate is not wrapped
+	 * around for looping maps, so the direction can be inferred from it.
+	 */
+	using CheckWayFn = std::function<bool(int from_x, int from_y, int to_x, int to_y)>;
+
+	struct Args {
+		int width = 0;
+		int height = 0;
+		bool loop_horizontal = false;
+		bool loop_vertical = false;
+
+		int start_x = 0;
+		int start_y = 0;
+		int dest_x = 0;
+		int dest_y = 0;
+
+		/** Maximum number of node expansions */
+		int32_t search_max = std::numeric_limits<int32_t>::max();
+		bool allow_diagonal = false;
+	};
+
+	struct Result {
+		/** Directions (Game_Character::Direction) from the start to the closest node found */
+		std::vector<int> directions;
+		/** Whether the destination was reached */
+		bool reached = false;
+		/** Number of expanded nodes */
+		int expanded = 0;
+	};
+
+	/**
+	 * Searches the path with the fewest steps to the destination, diagonal
+	 * steps cost the same as straight ones. When the destination
+	 * is not reachable within search_max expansions the path leads to the
+	 * expanded node with the lowest distance to the destination instead.
+	 *
+	 * Diagonal steps are only possible when one of the two orthogonal
+	 * steps they cut across is passable.
+	 *
+	 * @param args search parameters
+	 * @param check_way passability of a step
+	 * @return the path, empty when the start is not on the map
+	 */
+	Result FindPath(const Args& args, const CheckWayFn& check_way);
+
+	/** Restores the node expansion budget, called once per frame */
+	void ResetFrameBudget();
+
+	/** @return whether the node expansion budget of this frame is not used up */
+	bool HasFrameBudget();
+}
+
+#endif
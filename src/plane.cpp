@@ -23,12 +23,29 @@
 #include "game_map.h"
 #include "drawable_mgr.h"
 #include "game_screen.h"
+#include "damage_region.h"
 
 Plane::Plane() : Drawable(0)
 {
 	DrawableMgr::Register(this);
 }
 
+std::optional<uint64_t> Plane::GetDamageState(Rect& bounds) {
+	if (!bitmap) {
+		bounds = Rect();
+		return 0;
+	}
+
+	bounds = Rect(0, 0, Player::screen_width, Player::screen_height);
+
+	return DamageHash()
+		.Add(bitmap.get()).Add(bitmap->GetRevision()).Add(tone_effect)
+		.Add(ox).Add(oy).Add(GetRenderOx()).Add(GetRenderOy())
+		.Add(Main_Data::game_screen->GetShakeOffsetX()).Add(Main_Data::game_screen->GetShakeOffsetY())
+		.Add(Game_Map::LoopHorizontal()).Add(Game_Map::GetDisplayX()).Add(Game_Map::GetTilesX())
+		.Get();
+}
+
 void Plane::Draw(Bitmap& dst) {
 	if (!bitmap) return;
 
@@ -33,6 +33,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
+
 	BitmapRef const& GetBitmap() const;
 	void SetBitmap(BitmapRef const& bitmap);
 	int GetOx() const;
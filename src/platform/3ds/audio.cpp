@@ -243,8 +243,7 @@ void CtrAudio::SE_Play(std::unique_ptr<AudioSeCache> se_cache, int volume, int p
 		return;
 	}
 
-	auto dec = se_cache->CreateSeDecoder();
-	dec->SetPitch(pitch);
+	auto dec = se_cache->CreateSeDecoder(pitch);
 	dec->SetBalance(balance);
 
 	int frequency;
@@ -0,0 +1,78 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ui.h"
+#include "bitmap.h"
+#include "game_config.h"
+#include "player.h"
+
+HeadlessUi::HeadlessUi(int width, int height, const Game_Config& cfg) : BaseUi(cfg)
+{
+	current_display_mode.width = width;
+	current_display_mode.height = height;
+	current_display_mode.bpp = 32;
+
+	// Nothing is presented, frames are never throttled by a vsync
+	SetFrameRateSynchronized(false);
+
+	const DynamicFormat format(
+		32,
+		0x00FF0000,
+		0x0000FF00,
+		0x000000FF,
+		0xFF000000,
+		PF::NoAlpha);
+
+	Bitmap::SetFormat(Bitmap::ChooseFormat(format));
+
+	main_surface = Bitmap::Create(current_display_mode.width,
+		current_display_mode.height,
+		false,
+		current_display_mode.bpp
+	);
+
+#ifdef SUPPORT_AUDIO
+	audio_ = std::make_unique<EmptyAudio>(cfg.audio);
+#endif
+}
+
+bool HeadlessUi::vChangeDisplaySurfaceResolution(int new_width, int new_height) {
+	current_display_mode.width = new_width;
+	current_display_mode.height = new_height;
+
+	main_surface = Bitmap::Create(new_width, new_height, false, current_display_mode.bpp);
+
+	return true;
+}
+
+void HeadlessUi::UpdateDisplay() {
+}
+
+bool HeadlessUi::ProcessEvents() {
+	// Set when the input log ended
+	return !Player::exit_flag;
+}
+
+void HeadlessUi::vGetConfig(Game_ConfigVideo& cfg) const {
+	cfg.renderer.Lock("Headless (Software)");
+}
+
+#ifdef SUPPORT_AUDIO
+AudioInterface& HeadlessUi::GetAudio() {
+	return *audio_;
+}
+#endif
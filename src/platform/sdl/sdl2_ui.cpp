@@ -250,6 +250,7 @@ bool Sdl2Ui::vChangeDisplaySurfaceResolution(int new_width, int new_height) {
 	}
 
 	sdl_texture_game = new_sdl_texture_game;
+	texture_game_reset = true;
 
 	BitmapRef new_main_surface = Bitmap::Create(new_width, new_height, Color(0, 0, 0, 255));
 
@@ -438,6 +439,7 @@ bool Sdl2Ui::RefreshDisplayMode() {
 			Output::Debug("SDL_CreateTexture failed : {}", SDL_GetError());
 			return false;
 		}
+		texture_game_reset = true;
 
 		renderer_sg.Dismiss();
 		window_sg.Dismiss();
@@ -592,7 +594,14 @@ void Sdl2Ui::SetScreenScale(int scale) {
 }
 
 void Sdl2Ui::UpdateDisplay() {
+	Rect damage = ConsumeDisplayDamage();
+	if (texture_game_reset) {
+		damage = main_surface->GetRect();
+		texture_game_reset = false;
+	}
+
 #ifdef __WIIU__
+	(void)damage;
 	if (vcfg.scaling_mode.Get() == ConfigEnum::ScalingMode::Bilinear && window.scale > 0.f) {
 		// Workaround WiiU bug: Bilinear uses a render target and for these the format is not converted
 		void* target_pixels;
@@ -607,7 +616,12 @@ void Sdl2Ui::UpdateDisplay() {
 	}
 #else
 	// SDL_UpdateTexture was found to be faster than SDL_LockTexture / SDL_UnlockTexture.
-	SDL_UpdateTexture(sdl_texture_game, nullptr, main_surface->pixels(), main_surface->pitch());
+	// Only the area that changed since the last frame is uploaded.
+	if (!damage.IsEmpty()) {
+		SDL_Rect rect = { damage.x, damage.y, damage.width, damage.height };
+		auto* pixels = reinterpret_cast<uint8_t*>(main_surface->pixels()) + damage.y * main_surface->pitch() + damage.x * main_surface->bpp();
+		SDL_UpdateTexture(sdl_texture_game, &rect, pixels, main_surface->pitch());
+	}
 #endif
 
 #ifndef __PS4__
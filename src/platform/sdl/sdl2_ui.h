@@ -130,6 +130,8 @@ private:
 
 	/** Main SDL window. */
 	SDL_Texture* sdl_texture_game = nullptr;
+	/** sdl_texture_game was recreated and needs a full upload */
+	bool texture_game_reset = true;
 	SDL_Texture* sdl_texture_scaled = nullptr;
 	SDL_Window* sdl_window = nullptr;
 	SDL_Renderer* sdl_renderer = nullptr;
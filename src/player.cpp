@@ -22,6 +22,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <unordered_map>
 
 #ifdef _WIN32
@@ -31,6 +32,7 @@
 #  include <emscripten.h>
 #endif
 
+#include "async_decoder.h"
 #include "async_handler.h"
 #include "audio.h"
 #include "cache.h"
@@ -42,6 +44,7 @@
 #include "fileext_guesser.h"
 #include "filesystem_hook.h"
 #include "game_actors.h"
+#include "event_program.h"
 #include "game_battle.h"
 #include "game_destiny.h"
 #include "game_map.h"
@@ -71,6 +74,7 @@
 #include "scene_battle.h"
 #include "scene_logo.h"
 #include "scene_map.h"
+#include "scene_save.h"
 #include "utils.h"
 #include "version.h"
 #include "game_quit.h"
@@ -81,6 +85,7 @@
 #include <lcf/scope_guard.h>
 #include <lcf/log_handler.h>
 #include "baseui.h"
+#include "platform/headless/ui.h"
 #include "game_clock.h"
 #include "message_overlay.h"
 #include "audio_midi.h"
@@ -117,6 +122,7 @@ namespace Player {
 	bool no_rtp_flag;
 	std::string rtp_path;
 	bool no_audio_flag;
+	bool headless_flag;
 	bool is_easyrpg_project;
 	std::string encoding;
 	std::string escape_symbol;
@@ -194,6 +200,13 @@ void Player::Init(std::vector<std::string> args) {
 
 	DisplayUi.reset();
 
+	if (headless_flag) {
+		if (replay_input_path.empty()) {
+			Output::Warning("--headless without --replay-input runs until the game ends");
+		}
+		DisplayUi = std::make_shared<HeadlessUi>(Player::screen_width, Player::screen_height, cfg);
+	}
+
 	if(! DisplayUi) {
 		DisplayUi = BaseUi::CreateUi(Player::screen_width, Player::screen_height, cfg);
 	}
@@ -241,8 +254,11 @@ void Player::MainLoop() {
 		return;
 	}
 
+	AsyncHandler::Update();
+
+	// Headless mode simulates exactly one frame per iteration regardless of the elapsed time
 	int num_updates = 0;
-	while (Game_Clock::NextGameTimeStep()) {
+	while (headless_flag ? num_updates == 0 : Game_Clock::NextGameTimeStep()) {
 		if (num_updates > 0) {
 			Player::UpdateInput();
 
@@ -265,7 +281,9 @@ void Player::MainLoop() {
 		Input::UpdateSystem();
 	}
 
-	Player::Draw();
+	if (!headless_flag) {
+		Player::Draw();
+	}
 
 	Scene::old_instances.clear();
 
@@ -283,7 +301,7 @@ void Player::MainLoop() {
 	}
 
 	auto frame_limit = DisplayUi->GetFrameLimit();
-	if (frame_limit == Game_Clock::duration()) {
+	if (headless_flag || frame_limit == Game_Clock::duration()) {
 		return;
 	}
 
@@ -355,6 +373,7 @@ void Player::Update(bool update_scene) {
 	}
 
 	Audio().Update();
+	AudioSeCache::Update();
 	Input::Update();
 
 	// Game events can query full screen status and change their behavior, so this needs to
@@ -391,7 +410,7 @@ void Player::Update(bool update_scene) {
 
 void Player::Draw() {
 	Graphics::Update();
-	Graphics::Draw(*DisplayUi->GetDisplaySurface());
+	DisplayUi->SetDisplayDamage(Graphics::Draw(*DisplayUi->GetDisplaySurface()));
 	DisplayUi->UpdateDisplay();
 }
 
@@ -422,6 +441,13 @@ void Player::Exit() {
 	auto ret = FileFinder::Root().OpenOutputStream("/tmp/message.png", std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
 	if (ret) Output::TakeScreenshot(ret);
 #endif
+	if (headless_flag) {
+		std::cout << fmt::format("Frames: {} State hash: {:08x}", frames, GetStateHash()) << std::endl;
+	}
+
+	Instrumentation::WriteTrace();
+
+	AsyncDecoder::Quit();
 	Player::ResetGameObjects();
 	Font::Dispose();
 	Graphics::Quit();
@@ -430,6 +456,22 @@ void Player::Exit() {
 	DisplayUi.reset();
 }
 
+uint32_t Player::GetStateHash() {
+	if (!Main_Data::game_system || !Main_Data::game_party) {
+		return 0;
+	}
+
+	auto save = Scene_Save::CreateSaveData(false);
+
+	std::stringstream ss;
+	auto lcf_engine = Player::IsRPG2k3() ? lcf::EngineVersion::e2k3 : lcf::EngineVersion::e2k;
+	if (!lcf::LSD_Reader::Save(ss, save, lcf_engine, Player::encoding)) {
+		return 0;
+	}
+
+	return Utils::CRC32(ss);
+}
+
 Game_Config Player::ParseCommandLine() {
 	debug_flag = false;
 	hide_title_flag = false;
@@ -441,6 +483,7 @@ Game_Config Player::ParseCommandLine() {
 	start_map_id = -1;
 	no_rtp_flag = false;
 	no_audio_flag = false;
+	headless_flag = false;
 	is_easyrpg_project = false;
 	Game_Battle::battle_test.enabled = false;
 
@@ -645,6 +688,14 @@ Game_Config Player::ParseCommandLine() {
 			no_audio_flag = true;
 			continue;
 		}
+		if (cp.ParseNext(arg, 0, "--headless")) {
+			headless_flag = true;
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--profile")) {
+			Instrumentation::EnableProfiler(arg.NumValues() > 0 ? arg.Value(0) : std::string());
+			continue;
+		}
 		if (cp.ParseNext(arg, 0, {"--no-rtp", "--disable-rtp"})) {
 			no_rtp_flag = true;
 			continue;
@@ -865,6 +916,7 @@ void Player::CreateGameObjects() {
 	game_config.PrintActivePatches();
 
 	ResetGameObjects();
+	Main_Data::game_system->PreloadSe();
 
 	if (!game_constant_overrides.empty()) {
 		for (auto it = game_constant_overrides.begin(); it != game_constant_overrides.end();++it) {
@@ -944,6 +996,7 @@ void Player::ResetGameObjects() {
 	ManiacPatch::GlobalSave::Save(true);
 
 	Main_Data::Cleanup();
+	EventProgram::ClearShared();
 
 	Main_Data::game_constants = std::make_unique<Game_Constants>();
 
@@ -1475,6 +1528,12 @@ Engine options:
  --font2-size PX      Size of font 2 in pixel. The default is 12.
  --font-path PATH     The path in which the settings scene looks for fonts.
                       The default is config-path/Font.
+ --headless           Run without window and audio and simulate as fast as
+                      possible. Intended for --replay-input. The game exits at
+                      the end of the input log and prints a hash of the state.
+ --image-cache-size MB
+                      Memory in MB used for caching images. Unused images are
+                      freed when the cache grows beyond it. The default is 10.
  --language LANG      Load the game translation in language/LANG folder.
  --language-path PATH Use the translations at PATH instead of the translations
                       in the language folder.
@@ -1524,6 +1583,8 @@ Engine options:
 Providing any patch option disables the patch autodetection of the engine.
 
 Video options:
+ --damage-tracking    Only redraw the parts of the screen that changed. This is
+                      experimental. Disable with --no-damage-tracking.
  --fps-limit          In combination with --no-vsync sets a custom frames per
                       second limit. The default is 60 FPS. Use --no-fps-limit
                       to run with unlimited frames per second.
@@ -1559,6 +1620,11 @@ Video options:
 Audio options:
  --no-audio           Disable audio (in case you prefer your own music).
  --music-volume V     Set volume of background music to V (0-100).
+ --preload-se         Decode all sound effects used by the game in the
+                      background after loading it.
+ --se-cache-size MB   Memory in MB used for caching sound effects. Unused sound
+                      effects are freed when the cache grows beyond it.
+                      The default is 3.
  --sound-volume V     Set volume of sound effects to V (0-100).
  --soundfont FILE     Soundfont in sf2 format to use when playing MIDI files.
  --soundfont-path P   The path in which the settings scene looks for soundfonts.
@@ -1572,6 +1638,11 @@ Debug options:
                       condition and terrain ID.
  --hide-title         Hide the title background image and center the command
                       menu.
+ --profile [FILE]     Measure the time spent in the subsystems of the Player.
+                      The average and maximum is shown below the FPS. When FILE
+                      is given a trace in the Chrome trace format is written to
+                      it on exit, it can be opened with chrome://tracing or
+                      Perfetto.
  --start-map-id N     Overwrite the map used for new games and use MapN.lmu
                       instead (N is padded to four digits).
                       Incompatible with --load-game-id.
@@ -121,6 +121,14 @@ namespace Player {
 	 */
 	void Exit();
 
+	/**
+	 * Calculates a hash of the game state. The state is serialized like a
+	 * savegame, two runs with identical progress result in the same hash.
+	 *
+	 * @return CRC32 of the game state or 0 when no game is running
+	 */
+	uint32_t GetStateHash();
+
 	/**
 	 * Parses the command line arguments.
 	 */
@@ -381,6 +389,12 @@ namespace Player {
 	/** Mutes audio playback */
 	extern bool no_audio_flag;
 
+	/**
+	 * Runs without window and audio and simulates frames as fast as
+	 * possible instead of in real time. Used to replay input logs.
+	 */
+	extern bool headless_flag;
+
 	/** Is this project using EasyRPG files, or the RPG_RT format? */
 	extern bool is_easyrpg_project;
 
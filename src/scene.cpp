@@ -34,6 +34,7 @@
 #include "scene_settings.h"
 #include "scene_title.h"
 #include "game_map.h"
+#include "instrumentation.h"
 
 #ifndef NDEBUG
 #define DEBUG_VALIDATE(x) Scene::DebugValidate(x)
@@ -245,6 +246,8 @@ bool Scene::IsAsyncPending() {
 }
 
 void Scene::Update() {
+	Instrumentation::ZoneScope zone(Instrumentation::Zone::SceneUpdate);
+
 	// Allow calling of settings scene everywhere except from Logo (Player is currently starting up)
 	// and from Map (has own handling to prevent breakage)
 	if (instance->type != Scene::Logo &&
@@ -642,6 +642,11 @@ void Scene_Debug::vUpdate() {
 			case eOpenMenu:
 				DoOpenMenu();
 				break;
+			case eImageCache:
+				if (sz == 1) {
+					PushUiRangeList();
+				}
+				break;
 		}
 		Game_Map::SetNeedRefresh(true);
 	} else if (range_window->GetActive() && Input::IsRepeated(Input::RIGHT)) {
@@ -778,6 +783,7 @@ void Scene_Debug::UpdateRangeListWindow() {
 				addItem("Strings", Player::IsPatchManiac());
 				addItem("Interpreter");
 				addItem("Open Menu", !is_battle);
+				addItem("Image Cache");
 			}
 			break;
 		case eSwitch:
@@ -848,6 +854,17 @@ void Scene_Debug::UpdateRangeListWindow() {
 				}
 			}
 			break;
+		case eImageCache:
+		{
+			const auto stats = Cache::GetStats();
+			addItem(fmt::format("Used: {:.1f}MB", stats.size / (1024.0 * 1024.0)));
+			addItem(fmt::format("Limit: {}MB", stats.budget / (1024 * 1024)));
+			addItem(fmt::format("Items: {}", stats.count));
+			addItem(fmt::format("Hits: {}", stats.hits));
+			addItem(fmt::format("Miss: {}", stats.misses));
+			addItem(fmt::format("Evict: {}", stats.evictions));
+		}
+		break;
 		case eInterpreter:
 		{
 			auto& bg_states = state_interpreter.background_states;
@@ -74,6 +74,7 @@ public:
 		eString,
 		eInterpreter,
 		eOpenMenu,
+		eImageCache,
 		eLastMainMenuOption,
 	};
 
@@ -91,6 +91,21 @@ bool Scene_Save::Save(const FilesystemView& fs, int slot_id, bool prepare_save)
 }
 
 bool Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
+	Main_Data::game_system->SetSaveSlot(slot_id);
+
+	auto save = CreateSaveData(prepare_save);
+
+	auto lcf_engine = Player::IsRPG2k3() ? lcf::EngineVersion::e2k3 : lcf::EngineVersion::e2k;
+	bool res = lcf::LSD_Reader::Save(os, save, lcf_engine, Player::encoding);
+
+	Main_Data::game_dynrpg->Save(slot_id);
+
+	AsyncHandler::SaveFilesystem();
+
+	return res;
+}
+
+lcf::rpg::Save Scene_Save::CreateSaveData(bool prepare_save) {
 	lcf::rpg::Save save;
 	auto& title = save.title;
 	// TODO: Maybe find a better place to setup the save file?
@@ -122,7 +137,6 @@ bool Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
 		title.hero_name = ToString(actor->GetName());
 	}
 
-	Main_Data::game_system->SetSaveSlot(slot_id);
 	save.party_location = Main_Data::game_player->GetSaveData();
 	Game_Map::PrepareSave(save);
 
@@ -153,14 +167,8 @@ bool Scene_Save::Save(std::ostream& os, int slot_id, bool prepare_save) {
 			sme.map_id = 0;
 		}
 	}
-	auto lcf_engine = Player::IsRPG2k3() ? lcf::EngineVersion::e2k3 : lcf::EngineVersion::e2k;
-	bool res = lcf::LSD_Reader::Save(os, save, lcf_engine, Player::encoding);
 
-	Main_Data::game_dynrpg->Save(slot_id);
-
-	AsyncHandler::SaveFilesystem();
-
-	return res;
+	return save;
 }
 
 bool Scene_Save::IsSlotValid(int) {
@@ -20,6 +20,7 @@
 
 // Headers
 #include <vector>
+#include <lcf/rpg/save.h>
 #include "scene.h"
 #include "scene_file.h"
 
@@ -42,6 +43,15 @@ public:
 	static std::string GetSaveFilename(const FilesystemView& tree, int slot_id);
 	static bool Save(const FilesystemView& tree, int slot_id, bool prepare_save = true);
 	static bool Save(std::ostream& os, int slot_id, bool prepare_save = true);
+
+	/**
+	 * Collects the current game state in the savegame format.
+	 *
+	 * @param prepare_save when true the save count and the timestamp
+	 *   are updated like when saving from the menu.
+	 * @return the save data
+	 */
+	static lcf::rpg::Save CreateSaveData(bool prepare_save);
 };
 
 #endif
@@ -91,6 +91,7 @@ void Scene_Title::Continue(SceneType prev_scene) {
 		AudioSeCache::Clear();
 
 		Player::ResetGameObjects();
+		Main_Data::game_system->PreloadSe();
 		if (Player::IsPatchKeyPatch()) {
 			Main_Data::game_ineluki->ExecuteScriptList(FileFinder::Game().FindFile("autorun.script"));
 		}
@@ -23,12 +23,26 @@
 #include "main_data.h"
 #include "screen.h"
 #include "drawable_mgr.h"
+#include "damage_region.h"
+#include "player.h"
 
 Screen::Screen() : Drawable(Priority_Screen)
 {
 	DrawableMgr::Register(this);
 }
 
+std::optional<uint64_t> Screen::GetDamageState(Rect& bounds) {
+	auto flash_color = Main_Data::game_screen->GetFlashColor();
+	if (flash_color.alpha == 0 && viewport == Rect()) {
+		bounds = Rect();
+		return 0;
+	}
+
+	bounds = Rect(0, 0, Player::screen_width, Player::screen_height);
+
+	return DamageHash().Add(flash_color).Add(viewport).Get();
+}
+
 void Screen::Draw(Bitmap& dst) {
 	auto flash_color = Main_Data::game_screen->GetFlashColor();
 	if (flash_color.alpha > 0) {
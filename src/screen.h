@@ -38,6 +38,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
+
 	Rect GetViewport() const;
 	void SetViewport(const Rect& rect);
 
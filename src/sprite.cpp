@@ -23,6 +23,8 @@
 #include "bitmap.h"
 #include "cache.h"
 #include "drawable_mgr.h"
+#include "damage_region.h"
+#include "transform.h"
 
 // Constructor
 Sprite::Sprite(Drawable::Flags flags) : Drawable(0, flags)
@@ -37,6 +39,51 @@ void Sprite::Draw(Bitmap& dst) {
 	BlitScreen(dst);
 }
 
+std::optional<uint64_t> Sprite::GetDamageState(Rect& bounds) {
+	if (!bitmap || GetWidth() <= 0 || GetHeight() <= 0 || (opacity_top_effect <= 0 && opacity_bottom_effect <= 0)) {
+		bounds = Rect();
+		return 0;
+	}
+
+	const int render_ox = ox - GetRenderOx();
+	const int render_oy = oy - GetRenderOy();
+
+	if (angle_effect != 0.0) {
+		// Same transformation as used by RotateZoomOpacityBlit
+		Transform fwd = Transform::Translation(x, y);
+		fwd *= Transform::Rotation(angle_effect);
+		fwd *= Transform::Scale(zoom_x_effect, zoom_y_effect);
+		fwd *= Transform::Translation(-render_ox, -render_oy);
+		bounds = Bitmap::TransformRectangle(fwd, Rect(0, 0, GetWidth(), GetHeight()));
+	} else {
+		bounds = Rect(
+			x - static_cast<int>(std::floor(render_ox * zoom_x_effect)),
+			y - static_cast<int>(std::floor(render_oy * zoom_y_effect)),
+			static_cast<int>(std::ceil(GetWidth() * zoom_x_effect)),
+			static_cast<int>(std::ceil(GetHeight() * zoom_y_effect)));
+	}
+
+	// Rounding of the blit functions can touch one more pixel
+	int pad = 1;
+	if (waver_effect_depth != 0) {
+		pad += static_cast<int>(std::ceil(2 * waver_effect_depth * zoom_x_effect));
+	}
+	bounds = Rect(bounds.x - pad, bounds.y - 1, bounds.width + pad * 2, bounds.height + 2);
+
+	return DamageHash()
+		.Add(bitmap.get()).Add(bitmap->GetRevision())
+		.Add(src_rect).Add(src_rect_effect)
+		.Add(x).Add(y).Add(ox).Add(oy)
+		.Add(GetRenderOx()).Add(GetRenderOy())
+		.Add(zoom_x_effect).Add(zoom_y_effect).Add(angle_effect)
+		.Add(flipx_effect).Add(flipy_effect)
+		.Add(bush_effect).Add(opacity_top_effect).Add(opacity_bottom_effect)
+		.Add(blend_type_effect).Add(blend_color_effect)
+		.Add(tone_effect).Add(flash_effect)
+		.Add(waver_effect_depth).Add(waver_effect_phase)
+		.Get();
+}
+
 void Sprite::BlitScreen(Bitmap& dst) {
 	if (!bitmap || (opacity_top_effect <= 0 && opacity_bottom_effect <= 0))
 		return;
@@ -34,6 +34,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
+
 	virtual int GetWidth() const;
 	virtual int GetHeight() const;
 
@@ -56,6 +56,18 @@ void Sprite_AirshipShadow::RecreateShadow() {
 }
 
 void Sprite_AirshipShadow::Draw(Bitmap &dst) {
+	UpdateRenderState();
+
+	Sprite::Draw(dst);
+}
+
+std::optional<uint64_t> Sprite_AirshipShadow::GetDamageState(Rect& bounds) {
+	UpdateRenderState();
+
+	return Sprite::GetDamageState(bounds);
+}
+
+void Sprite_AirshipShadow::UpdateRenderState() {
 	Game_Vehicle* airship = Game_Map::GetVehicle(Game_Vehicle::Airship);
 	const int altitude = airship->GetAltitude();
 	const int max_altitude = TILE_SIZE;
@@ -64,8 +76,6 @@ void Sprite_AirshipShadow::Draw(Bitmap &dst) {
 
 	SetX(Main_Data::game_player->GetScreenX() + x_offset);
 	SetY(Main_Data::game_player->GetScreenY() + y_offset + Main_Data::game_player->GetJumpHeight());
-
-	Sprite::Draw(dst);
 }
 
 void Sprite_AirshipShadow::Update() {
@@ -43,6 +43,9 @@ public:
 	 */
 	Sprite_Battler(Game_Battler* battler, int battle_index);
 
+	/** Battle sprites are not damage tracked */
+	std::optional<uint64_t> GetDamageState(Rect&) override { return std::nullopt; }
+
 	~Sprite_Battler() override;
 
 	Game_Battler* GetBattler() const;
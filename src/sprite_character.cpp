@@ -36,6 +36,18 @@ Sprite_Character::Sprite_Character(Game_Character* character, int x_offset, int
 }
 
 void Sprite_Character::Draw(Bitmap &dst) {
+	UpdateRenderState();
+
+	Sprite::Draw(dst);
+}
+
+std::optional<uint64_t> Sprite_Character::GetDamageState(Rect& bounds) {
+	UpdateRenderState();
+
+	return Sprite::GetDamageState(bounds);
+}
+
+void Sprite_Character::UpdateRenderState() {
 	if (UsesCharset()) {
 		int row = character->GetFacing();
 		auto frame = character->GetAnimFrame();
@@ -52,8 +64,6 @@ void Sprite_Character::Draw(Bitmap &dst) {
 
 	int bush_split = 4 - character->GetBushDepth();
 	SetBushDepth(bush_split > 3 ? 0 : GetHeight() / bush_split);
-
-	Sprite::Draw(dst);
 }
 
 void Sprite_Character::Update() {
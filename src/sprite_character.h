@@ -43,6 +43,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
+
 	/**
 	 * Updates sprite state.
 	 */
@@ -79,6 +81,9 @@ public:
 	void ChipsetUpdated();
 
 private:
+	/** Applies the character state, done lazily right before drawing */
+	void UpdateRenderState();
+
 	Game_Character* character;
 
 	int tile_id;
@@ -63,13 +63,28 @@ void Sprite_Picture::OnPictureShow() {
 
 
 void Sprite_Picture::Draw(Bitmap& dst) {
+	if (UpdateRenderState()) {
+		Sprite::Draw(dst);
+	}
+}
+
+std::optional<uint64_t> Sprite_Picture::GetDamageState(Rect& bounds) {
+	if (!UpdateRenderState()) {
+		bounds = Rect();
+		return 0;
+	}
+
+	return Sprite::GetDamageState(bounds);
+}
+
+bool Sprite_Picture::UpdateRenderState() {
 	const auto& pic = Main_Data::game_pictures->GetPicture(pic_id);
 	const auto& data = pic.data;
 
 	auto& bitmap = GetBitmap();
 
 	if (!bitmap) {
-		return;
+		return false;
 	}
 
 	if (data.easyrpg_type == lcf::rpg::SavePicture::EasyRpgType_window) {
@@ -81,7 +96,7 @@ void Sprite_Picture::Draw(Bitmap& dst) {
 	const bool is_battle = Game_Battle::IsBattleRunning();
 
 	if (is_battle ? !pic.IsOnBattle() : !pic.IsOnMap()) {
-		return;
+		return false;
 	}
 
 	// RPG Maker 2k3 1.12: Spritesheets
@@ -187,10 +202,7 @@ void Sprite_Picture::Draw(Bitmap& dst) {
 	SetBlendType(data.easyrpg_blend_mode);
 
 	// Don't draw anything if zoom is at zero, helps avoid a glitchy rotated sprite in the top left corner
-	if (GetZoomX() <= 0.0 || GetZoomY() <= 0.0) {
-		return;
-	}
-	Sprite::Draw(dst);
+	return GetZoomX() > 0.0 && GetZoomY() > 0.0;
 }
 
 int Sprite_Picture::GetFrameWidth() const {
@@ -36,6 +36,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
+
 	void OnPictureShow();
 
 	/** @return Width of a single spritesheet frame or the entire width if the picture has no spritesheet */
@@ -45,6 +47,13 @@ public:
 	int GetFrameHeight() const;
 
 private:
+	/**
+	 * Applies the picture state, done lazily right before drawing.
+	 *
+	 * @return whether the picture is drawn
+	 */
+	bool UpdateRenderState();
+
 	int last_spritesheet_frame = -1;
 	const int pic_id = 0;
 	const bool feature_spritesheet = false;
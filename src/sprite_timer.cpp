@@ -24,6 +24,7 @@
 #include "game_system.h"
 #include "game_battle.h"
 #include "window_message.h"
+#include "damage_region.h"
 #include <player.h>
 
 Sprite_Timer::Sprite_Timer(int which) :
@@ -62,14 +63,29 @@ Sprite_Timer::~Sprite_Timer() {
 }
 
 void Sprite_Timer::Draw(Bitmap& dst) {
+	if (UpdateRenderState()) {
+		Sprite::Draw(dst);
+	}
+}
+
+std::optional<uint64_t> Sprite_Timer::GetDamageState(Rect& bounds) {
+	if (!UpdateRenderState()) {
+		bounds = Rect();
+		return 0;
+	}
+
+	return Sprite::GetDamageState(bounds);
+}
+
+bool Sprite_Timer::UpdateRenderState() {
 	if (!Main_Data::game_party->GetTimerVisible(which, Game_Battle::IsBattleRunning())) {
-		return;
+		return false;
 	}
 
 	// RPG_RT never displays timers if there is no system graphic.
 	BitmapRef system = Cache::System();
 	if (!system) {
-		return;
+		return false;
 	}
 
 	const int all_secs = Main_Data::game_party->GetTimerSeconds(which);
@@ -101,17 +117,27 @@ void Sprite_Timer::Draw(Bitmap& dst) {
 		SetY(Player::menu_offset_y + 4);
 	}
 
+	int frames = Main_Data::game_party->GetTimerFrames(which);
+	bool colon_visible = frames % DEFAULT_FPS >= DEFAULT_FPS / 2;
+
+	// Only repaint when the displayed time changes
+	auto key = DamageHash()
+		.Add(system.get()).Add(system->GetRevision()).Add(colon_visible)
+		.Add(digits[0].x).Add(digits[1].x).Add(digits[3].x).Add(digits[4].x)
+		.Get();
+	if (key == render_key) {
+		return true;
+	}
+	render_key = key;
+
 	GetBitmap()->Clear();
 	for (int i = 0; i < 5; ++i) {
-		if (i == 2) { // :
-			int frames =  Main_Data::game_party->GetTimerFrames(which);
-			if (frames % DEFAULT_FPS < DEFAULT_FPS / 2) {
-				continue;
-			}
+		if (i == 2 && !colon_visible) { // :
+			continue;
 		}
 		GetBitmap()->Blit(i * 8, 0, *system, digits[i], Opacity());
 	}
 
-	Sprite::Draw(dst);
+	return true;
 }
 
@@ -38,8 +38,20 @@ public:
 protected:
 	void Draw(Bitmap& dst) override;
 
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
+
+	/**
+	 * Repaints the timer digits when the time changed.
+	 *
+	 * @return whether the timer is drawn
+	 */
+	bool UpdateRenderState();
+
 	int which = 0;
 
+	/** Hash of the displayed time, the bitmap is only repainted when it changes */
+	uint64_t render_key = 0;
+
 	Rect digits[5];
 };
 
@@ -54,6 +54,9 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	/** Battle sprites are not damage tracked */
+	std::optional<uint64_t> GetDamageState(Rect&) override { return std::nullopt; }
+
 protected:
 	void CreateSprite();
 	void OnBattleWeaponReady(FileRequestResult* result, int32_t weapon_index);
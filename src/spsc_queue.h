@@ -0,0 +1,105 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_SPSC_QUEUE_H
+#define EP_SPSC_QUEUE_H
+
+// Headers
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * A bounded lock-free queue for exactly one producer and one consumer
+ * thread. Neither side ever blocks or allocates.
+ *
+ * Push must only be called by the producer, Pop only by the consumer.
+ * The consumer may change to another thread when the threads are
+ * synchronized otherwise, e.g. through a mutex.
+ *
+ * @tparam T element type, must be default constructible and movable
+ * @tparam N capacity, must be a power of two
+ */
+template <typename T, size_t N>
+class SpscQueue {
+	public:
+		static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity must be a power of two");
+
+		/**
+		 * Appends an element.
+		 *
+		 * @param value element, only moved from on success
+		 * @return false when the queue is full
+		 */
+		bool Push(T&& value);
+
+		/**
+		 * Removes the oldest element.
+		 *
+		 * @param value receives the element
+		 * @return false when the queue is empty
+		 */
+		bool Pop(T& value);
+
+		/** @return whether the queue is empty, only a snapshot when called by the producer */
+		bool IsEmpty() const;
+
+		/** @return maximum number of elements */
+		static constexpr size_t GetCapacity();
+
+	private:
+		std::array<T, N> slots = {};
+
+		// On separate cache lines, each is only written by one side
+		alignas(64) std::atomic<size_t> head = { 0 };
+		alignas(64) std::atomic<size_t> tail = { 0 };
+};
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::Push(T&& value) {
+	const size_t t = tail.load(std::memory_order_relaxed);
+	if (t - head.load(std::memory_order_acquire) == N) {
+		return false;
+	}
+	slots[t & (N - 1)] = std::move(value);
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::Pop(T& value) {
+	const size_t h = head.load(std::memory_order_relaxed);
+	if (h == tail.load(std::memory_order_acquire)) {
+		return false;
+	}
+	value = std::move(slots[h & (N - 1)]);
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::IsEmpty() const {
+	return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
+
+template <typename T, size_t N>
+constexpr size_t SpscQueue<T, N>::GetCapacity() {
+	return N;
+}
+
+#endif
@@ -108,9 +108,8 @@
 #  define JOYSTICK_TRIGGER_SENSIBILITY 0.2
 #endif
 
-#if defined(HAVE_LIBSAMPLERATE) || defined(HAVE_LIBSPEEXDSP)
-#  define USE_AUDIO_RESAMPLER
-#endif
+// Without libsamplerate or libspeexdsp the built-in resampler is used
+#define USE_AUDIO_RESAMPLER
 
 #if defined(SUPPORT_MOUSE) || defined(SUPPORT_TOUCH)
 #  define SUPPORT_MOUSE_OR_TOUCH
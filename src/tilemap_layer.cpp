@@ -16,6 +16,7 @@
  */
 
 // Headers
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include "tilemap_layer.h"
@@ -29,6 +30,7 @@
 #include "game_system.h"
 #include "drawable_mgr.h"
 #include "baseui.h"
+#include "damage_region.h"
 
 // Blocks subtiles IDs
 // Mess with this code and you will die in 3 days...
@@ -209,14 +211,14 @@ TilemapLayer::TilemapLayer(int ilayer) :
 // was created intentionally. Inlining the transparency check was measured and shown
 // to provide a performance improvement
 EP_ALWAYS_INLINE
-void TilemapLayer::DrawTile(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, uint32_t tone_hash, bool allow_fast_blit) {
+void TilemapLayer::DrawTile(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, int atlas_index, bool allow_fast_blit) {
 	auto op = tileset.GetTileOpacity(col, row);
 	if (op != ImageOpacity::Transparent) {
-		DrawTileImpl(dst, tileset, tone_tileset, x, y, row, col, tone_hash, op, allow_fast_blit);
+		DrawTileImpl(dst, tileset, tone_tileset, x, y, row, col, atlas_index, op, allow_fast_blit);
 	}
 }
 
-void TilemapLayer::DrawTileImpl(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, uint32_t tone_hash, ImageOpacity op, bool allow_fast_blit) {
+void TilemapLayer::DrawTileImpl(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, int atlas_index, ImageOpacity op, bool allow_fast_blit) {
 
 	auto rect = Rect{ col * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE };
 
@@ -224,7 +226,8 @@ void TilemapLayer::DrawTileImpl(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tiles
 
 	// Create tone changed tile
 	if (tone != Tone()) {
-		if (chipset_tone_tiles.insert(tone_hash).second) {
+		if (!tile_atlas_toned[atlas_index]) {
+			tile_atlas_toned[atlas_index] = 1;
 			tone_tileset.ToneBlit(col * TILE_SIZE, row * TILE_SIZE, tileset, rect, tone, Opacity::Opaque());
 		}
 		src = &tone_tileset;
@@ -238,24 +241,30 @@ void TilemapLayer::DrawTileImpl(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tiles
 	}
 }
 
-static uint32_t MakeFTileHash(int id) {
-	return static_cast<uint32_t>(id);
-}
-
-static uint32_t MakeETileHash(int id) {
-	return static_cast<uint32_t>(id | (1 << 24));
-}
-
-static uint32_t MakeDTileHash(int id) {
-	return static_cast<uint32_t>(id | (2 << 24));
-}
+/**
+ * Splits the tiles [start, start + count) into runs which are contiguous on
+ * the map and do not cross a chunk border.
+ * fn is called with the offset of the run, the map position and the length.
+ */
+template <typename F>
+static void ForEachChunkRun(int start, int count, int size, bool loop, F&& fn) {
+	int pos = start;
+	int end = start + count;
+	if (!loop) {
+		pos = std::max(pos, 0);
+		end = std::min(end, size);
+	}
 
-static uint32_t MakeCTileHash(int id, int anim_step) {
-	return static_cast<uint32_t>((id + (anim_step << 12)) | (3 << 24));
-}
+	while (pos < end) {
+		int map_pos = pos % size;
+		if (map_pos < 0) {
+			map_pos += size;
+		}
 
-static uint32_t MakeAbTileHash(int id, int anim_step) {
-	return static_cast<uint32_t>((id + (anim_step << 12)) | (4 << 24));
+		int length = std::min({ end - pos, size - map_pos, TilemapLayer::CHUNK_SIZE - map_pos % TilemapLayer::CHUNK_SIZE });
+		fn(pos - start, map_pos, length);
+		pos += length;
+	}
 }
 
 void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order, int render_ox, int render_oy) {
@@ -303,6 +312,52 @@ void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order, int render_ox, int render_
 	const int mod_ox = mod(ox - render_ox, TILE_SIZE);
 	const int mod_oy = mod(oy - render_oy, TILE_SIZE);
 
+	// Frame offset into the atlas for each TileAnimation
+	const uint32_t anim_steps[Anim_Count] = { 0, animation_step_ab, animation_step_c };
+
+	Bitmap* sheets[Sheet_Count] = { chipset.get(), autotiles_ab_screen.get(), autotiles_d_screen.get() };
+	Bitmap* effect_sheets[Sheet_Count] = { chipset_effect.get(), autotiles_ab_screen_effect.get(), autotiles_d_screen_effect.get() };
+
+	auto draw_cell = [&](const TileData& tile, int draw_x, int draw_y) {
+		// Only the lower sublayer of the lower layer can ignore the tile opacity
+		bool allow_fast_blit = (layer != 0 || tile.z == TileBelow);
+
+		const int atlas_index = tile.atlas + anim_steps[tile.anim];
+		const AtlasTile& atlas_tile = tile_atlas[atlas_index];
+		DrawTile(dst, *sheets[atlas_tile.sheet], *effect_sheets[atlas_tile.sheet], draw_x, draw_y, atlas_tile.row, atlas_tile.col, atlas_index, allow_fast_blit);
+	};
+
+	if (UpdateChunkCache() && width > 0 && height > 0) {
+		// Blit the static part of every visible chunk and draw the animated tiles on top
+		ForEachChunkRun(div_oy, tiles_y, height, loop_v, [&](int screen_y, int map_y, int run_h) {
+			ForEachChunkRun(div_ox, tiles_x, width, loop_h, [&](int screen_x, int map_x, int run_w) {
+				const TileChunk& chunk = GetChunk(map_x / CHUNK_SIZE, map_y / CHUNK_SIZE, z_order);
+
+				const int local_x = map_x % CHUNK_SIZE;
+				const int local_y = map_y % CHUNK_SIZE;
+				const int draw_x = screen_x * TILE_SIZE - mod_ox;
+				const int draw_y = screen_y * TILE_SIZE - mod_oy;
+
+				if (chunk.bitmap) {
+					auto rect = Rect{ local_x * TILE_SIZE, local_y * TILE_SIZE, run_w * TILE_SIZE, run_h * TILE_SIZE };
+					dst.Blit(draw_x, draw_y, *chunk.bitmap, rect, 255);
+				}
+
+				for (auto cell: chunk.animated) {
+					const int cell_x = cell % CHUNK_SIZE;
+					const int cell_y = cell / CHUNK_SIZE;
+					if (cell_x < local_x || cell_x >= local_x + run_w || cell_y < local_y || cell_y >= local_y + run_h) {
+						continue;
+					}
+
+					const TileData& tile = GetDataCache(map_x - local_x + cell_x, map_y - local_y + cell_y);
+					draw_cell(tile, draw_x + (cell_x - local_x) * TILE_SIZE, draw_y + (cell_y - local_y) * TILE_SIZE);
+				}
+			});
+		});
+		return;
+	}
+
 	for (int y = 0; y < tiles_y; y++) {
 		for (int x = 0; x < tiles_x; x++) {
 
@@ -320,94 +375,114 @@ void TilemapLayer::Draw(Bitmap& dst, uint8_t z_order, int render_ox, int render_
 				continue;
 			}
 
-			int map_draw_x = x * TILE_SIZE - mod_ox;
-			int map_draw_y = y * TILE_SIZE - mod_oy;
-
 			// Get the tile data
-			TileData &tile = GetDataCache(map_x, map_y);
+			const TileData& tile = GetDataCache(map_x, map_y);
 
 			// Draw the sublayer if its z is being draw now
-			if (z_order == tile.z) {
-				if (layer == 0) {
-					// If lower layer
-					bool allow_fast_blit = (tile.z == TileBelow);
-
-					if (tile.ID >= BLOCK_E && tile.ID < BLOCK_E + BLOCK_E_TILES) {
-						int id = substitutions[tile.ID - BLOCK_E];
-						// If Block E
-
-						int row, col;
-
-						// Get the tile coordinates from chipset
-						if (id < 96) {
-							// If from first column of the block
-							col = 12 + id % 6;
-							row = id / 6;
-						} else {
-							// If from second column of the block
-							col = 18 + (id - 96) % 6;
-							row = (id - 96) / 6;
-						}
-
-						auto tone_hash = MakeETileHash(id);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else if (tile.ID >= BLOCK_C && tile.ID < BLOCK_D) {
-						// If Block C
-
-						// Get the tile coordinates from chipset
-						int col = 3 + (tile.ID - BLOCK_C) / 50;
-						int row = 4 + animation_step_c;
-
-						auto tone_hash = MakeCTileHash(tile.ID, animation_step_c);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else if (tile.ID < BLOCK_C) {
-						// If Blocks A1, A2, B
-
-						// Draw the tile from autotile cache
-						TileXY pos = GetCachedAutotileAB(tile.ID, animation_step_ab);
-
-						int col = pos.x;
-						int row = pos.y;
-
-						// Create tone changed tile
-						auto tone_hash = MakeAbTileHash(tile.ID,  animation_step_ab);
-						DrawTile(dst, *autotiles_ab_screen, *autotiles_ab_screen_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else {
-						// If blocks D1-D12
-
-						// Draw the tile from autotile cache
-						TileXY pos = GetCachedAutotileD(tile.ID);
-
-						int col = pos.x;
-						int row = pos.y;
-
-						auto tone_hash = MakeDTileHash(tile.ID);
-						DrawTile(dst, *autotiles_d_screen, *autotiles_d_screen_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					}
-				} else {
-					// If upper layer
-
-					// Check that block F is being drawn
-					if (tile.ID >= BLOCK_F && tile.ID < BLOCK_F + BLOCK_F_TILES) {
-						int id = substitutions[tile.ID - BLOCK_F];
-						int row, col;
-
-						// Get the tile coordinates from chipset
-						if (id < 48) {
-							// If from first column of the block
-							col = 18 + id % 6;
-							row = 8 + id / 6;
-						} else {
-							// If from second column of the block
-							col = 24 + (id - 48) % 6;
-							row = (id - 48) / 6;
-						}
-
-						auto tone_hash = MakeFTileHash(id);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash);
-					}
-				}
+			if (z_order != tile.z || tile.atlas == NoAtlasTile) {
+				continue;
+			}
+
+			draw_cell(tile, x * TILE_SIZE - mod_ox, y * TILE_SIZE - mod_oy);
+		}
+	}
+}
+
+bool TilemapLayer::UpdateChunkCache() {
+	const uint64_t chipset_revision = chipset->GetRevision();
+
+	if (revision != chunk_revision || chipset_revision != chunk_chipset_revision || fast_blit != chunk_fast_blit) {
+		chunks.clear();
+		chunk_revision = revision;
+		chunk_chipset_revision = chipset_revision;
+		chunk_fast_blit = fast_blit;
+		chunk_stable_draws = 0;
+	}
+
+	++chunk_draw_stamp;
+
+	// Layers which change every frame (e.g. during a tone fade) are drawn per tile,
+	// rebuilding the chunks each frame would be slower
+	if (chunk_stable_draws < CHUNK_STABLE_DRAWS) {
+		++chunk_stable_draws;
+		return false;
+	}
+	return true;
+}
+
+const TilemapLayer::TileChunk& TilemapLayer::GetChunk(int cx, int cy, uint8_t z) {
+	TileChunk* lru = nullptr;
+	for (auto& chunk: chunks) {
+		if (chunk.cx == cx && chunk.cy == cy && chunk.z == z) {
+			chunk.last_used = chunk_draw_stamp;
+			return chunk;
+		}
+		if (!lru || chunk.last_used < lru->last_used) {
+			lru = &chunk;
+		}
+	}
+
+	// Only reuse chunks which were not visible in this frame. Each sublayer
+	// draws once per frame, therefore the previous draw counts as well.
+	if (chunks.size() < MAX_CHUNKS || !lru || lru->last_used + 1 >= chunk_draw_stamp) {
+		chunks.emplace_back();
+		lru = &chunks.back();
+	}
+
+	lru->cx = cx;
+	lru->cy = cy;
+	lru->z = z;
+	lru->last_used = chunk_draw_stamp;
+	CreateChunk(*lru);
+	return *lru;
+}
+
+void TilemapLayer::CreateChunk(TileChunk& chunk) {
+	chunk.bitmap.reset();
+	chunk.animated.clear();
+
+	Bitmap* sheets[Sheet_Count] = { chipset.get(), autotiles_ab_screen.get(), autotiles_d_screen.get() };
+	Bitmap* effect_sheets[Sheet_Count] = { chipset_effect.get(), autotiles_ab_screen_effect.get(), autotiles_d_screen_effect.get() };
+
+	const int x0 = chunk.cx * CHUNK_SIZE;
+	const int y0 = chunk.cy * CHUNK_SIZE;
+	const int chunk_w = std::min(CHUNK_SIZE, width - x0);
+	const int chunk_h = std::min(CHUNK_SIZE, height - y0);
+
+	for (int y = 0; y < chunk_h; ++y) {
+		for (int x = 0; x < chunk_w; ++x) {
+			const TileData& tile = GetDataCache(x0 + x, y0 + y);
+			if (tile.z != chunk.z || tile.atlas == NoAtlasTile) {
+				continue;
+			}
+
+			if (tile.anim != Anim_None) {
+				chunk.animated.push_back(static_cast<uint16_t>(x + y * CHUNK_SIZE));
+				continue;
 			}
+
+			const AtlasTile& atlas_tile = tile_atlas[tile.atlas];
+			Bitmap& sheet = *sheets[atlas_tile.sheet];
+
+			auto op = sheet.GetTileOpacity(atlas_tile.col, atlas_tile.row);
+			if (op == ImageOpacity::Transparent) {
+				continue;
+			}
+
+			if (!chunk.bitmap) {
+				chunk.bitmap = Bitmap::Create(chunk_w * TILE_SIZE, chunk_h * TILE_SIZE, true);
+				chunk.bitmap->Clear();
+			}
+
+			bool allow_fast_blit = (layer != 0 || tile.z == TileBelow);
+			if (fast_blit && allow_fast_blit && op != ImageOpacity::Opaque) {
+				// The chunk is alpha blended onto the screen. An opaque black
+				// background gives the same colors as copying the tile directly.
+				chunk.bitmap->FillRect(Rect{ x * TILE_SIZE, y * TILE_SIZE, TILE_SIZE, TILE_SIZE }, Color(0, 0, 0, 255));
+				allow_fast_blit = false;
+			}
+
+			DrawTileImpl(*chunk.bitmap, sheet, *effect_sheets[atlas_tile.sheet], x * TILE_SIZE, y * TILE_SIZE, atlas_tile.row, atlas_tile.col, tile.atlas, op, allow_fast_blit);
 		}
 	}
 }
@@ -433,6 +508,104 @@ void TilemapLayer::CreateTileCache(const std::vector<short>& nmap_data) {
 			CreateTileCacheAt(x, y, tile_id);
 		}
 	}
+
+	CreateTileAtlas();
+}
+
+void TilemapLayer::CreateTileAtlas() {
+	tile_atlas.clear();
+
+	// Maps a tile ID to its first atlas entry
+	std::vector<uint16_t> id_to_atlas(BLOCK_F_END, NoAtlasTile);
+
+	for (auto& tile: data_cache_vec) {
+		tile.anim = Anim_None;
+		tile.atlas = NoAtlasTile;
+
+		if (tile.ID < 0 || tile.ID >= BLOCK_F_END) {
+			continue;
+		}
+
+		int frames = 1;
+		if (layer == 0) {
+			if (tile.ID < BLOCK_C) {
+				tile.anim = Anim_AB;
+				frames = 3;
+			} else if (tile.ID < BLOCK_D) {
+				tile.anim = Anim_C;
+				frames = 4;
+			} else if (tile.ID >= BLOCK_E_END || (tile.ID >= BLOCK_D_END && tile.ID < BLOCK_E)) {
+				continue;
+			}
+		} else if (tile.ID < BLOCK_F) {
+			// The upper layer only draws block F
+			continue;
+		}
+
+		auto& index = id_to_atlas[tile.ID];
+		if (index == NoAtlasTile) {
+			if (tile_atlas.size() + frames >= NoAtlasTile) {
+				continue;
+			}
+
+			index = static_cast<uint16_t>(tile_atlas.size());
+			for (int i = 0; i < frames; ++i) {
+				tile_atlas.push_back(ResolveAtlasTile(tile.ID, i));
+			}
+		}
+		tile.atlas = index;
+	}
+
+	tile_atlas_toned.assign(tile_atlas.size(), 0);
+}
+
+TilemapLayer::AtlasTile TilemapLayer::ResolveAtlasTile(short ID, int anim_step) {
+	AtlasTile tile = { Sheet_Chipset, 0, 0 };
+
+	if (ID >= BLOCK_F) {
+		int id = substitutions[ID - BLOCK_F];
+
+		// Get the tile coordinates from chipset
+		if (id < 48) {
+			// If from first column of the block
+			tile.col = 18 + id % 6;
+			tile.row = 8 + id / 6;
+		} else {
+			// If from second column of the block
+			tile.col = 24 + (id - 48) % 6;
+			tile.row = (id - 48) / 6;
+		}
+	} else if (ID >= BLOCK_E) {
+		int id = substitutions[ID - BLOCK_E];
+
+		// Get the tile coordinates from chipset
+		if (id < 96) {
+			// If from first column of the block
+			tile.col = 12 + id % 6;
+			tile.row = id / 6;
+		} else {
+			// If from second column of the block
+			tile.col = 18 + (id - 96) % 6;
+			tile.row = (id - 96) / 6;
+		}
+	} else if (ID >= BLOCK_D) {
+		// Tile from the autotile cache
+		TileXY pos = GetCachedAutotileD(ID);
+		tile.sheet = Sheet_AutotilesD;
+		tile.col = pos.x;
+		tile.row = pos.y;
+	} else if (ID >= BLOCK_C) {
+		tile.col = 3 + (ID - BLOCK_C) / 50;
+		tile.row = 4 + anim_step;
+	} else {
+		// Tile from the autotile cache
+		TileXY pos = GetCachedAutotileAB(ID, anim_step);
+		tile.sheet = Sheet_AutotilesAB;
+		tile.col = pos.x;
+		tile.row = pos.y;
+	}
+
+	return tile;
 }
 
 void TilemapLayer::CreateTileCacheAt(int x, int y, int tile_id) {
@@ -670,9 +843,10 @@ BitmapRef TilemapLayer::GenerateAutotiles(int count, const std::unordered_map<ui
 }
 
 void TilemapLayer::SetChipset(BitmapRef const& nchipset) {
+	++revision;
 	chipset = nchipset;
 	chipset_effect = Bitmap::Create(chipset->width(), chipset->height());
-	chipset_tone_tiles.clear();
+	std::fill(tile_atlas_toned.begin(), tile_atlas_toned.end(), 0);
 
 	if (autotiles_ab_next != 0 && autotiles_d_screen != nullptr && layer == 0) {
 		autotiles_ab_screen = GenerateAutotiles(autotiles_ab_next, autotiles_ab_map);
@@ -684,6 +858,8 @@ void TilemapLayer::SetChipset(BitmapRef const& nchipset) {
 }
 
 void TilemapLayer::SetMapData(std::vector<short> nmap_data) {
+	++revision;
+
 	// Create the tiles data cache
 	CreateTileCache(nmap_data);
 	memset(autotiles_ab, 0, sizeof(autotiles_ab));
@@ -716,7 +892,8 @@ void TilemapLayer::SetMapData(std::vector<short> nmap_data) {
 		autotiles_ab_screen_effect = Bitmap::Create(autotiles_ab_screen->width(), autotiles_ab_screen->height());
 		autotiles_d_screen_effect = Bitmap::Create(autotiles_d_screen->width(), autotiles_d_screen->height());
 
-		chipset_tone_tiles.clear();
+		// Autotile positions are known now
+		CreateTileAtlas();
 	}
 
 	map_data = std::move(nmap_data);
@@ -738,6 +915,8 @@ void TilemapLayer::SetMapTileDataAt(int x, int y, int tile_id, bool disable_auto
 	if(!IsInMapBounds(x, y))
 		return;
 
+	++revision;
+
 	substitutions = Game_Map::GetTilesLayer(layer);
 
 	bool is_autotile = IsTileFromBlock(tile_id, BLOCK_A) || IsTileFromBlock(tile_id, BLOCK_B) || IsTileFromBlock(tile_id, BLOCK_D);
@@ -858,6 +1037,7 @@ void TilemapLayer::RecalculateAutotile(int x, int y, int tile_id) {
 	}
 }
 void TilemapLayer::SetPassable(std::vector<unsigned char> npassable) {
+	++revision;
 	passable = std::move(npassable);
 
 	// Recalculate z values of all tiles
@@ -865,6 +1045,7 @@ void TilemapLayer::SetPassable(std::vector<unsigned char> npassable) {
 }
 
 void TilemapLayer::OnSubstitute() {
+	++revision;
 	substitutions = Game_Map::GetTilesLayer(layer);
 
 	// Recalculate z values of all tiles
@@ -887,11 +1068,47 @@ void TilemapSubLayer::Draw(Bitmap& dst) {
 	tilemap->Draw(dst, internal_z, GetRenderOx(), GetRenderOy());
 }
 
+std::optional<uint64_t> TilemapSubLayer::GetDamageState(Rect& bounds) {
+	if (!tilemap->GetChipset()) {
+		bounds = Rect();
+		return 0;
+	}
+
+	return tilemap->GetDamageState(bounds, GetRenderOx(), GetRenderOy());
+}
+
+std::optional<uint64_t> TilemapLayer::GetDamageState(Rect& bounds, int render_ox, int render_oy) const {
+	bounds = Rect(0, 0, Player::screen_width, Player::screen_height);
+
+	// Same animation steps as calculated in Draw
+	const auto frames = Main_Data::game_system ? static_cast<uint32_t>(Main_Data::game_system->GetFrameCounter()) : 0u;
+	auto animation_step_c = (frames / 6) % 4;
+	auto animation_step_ab = frames / animation_speed;
+	if (animation_type) {
+		animation_step_ab %= 3;
+	} else {
+		animation_step_ab %= 4;
+		if (animation_step_ab == 3) {
+			animation_step_ab = 1;
+		}
+	}
+
+	return DamageHash()
+		.Add(revision).Add(chipset.get()).Add(chipset->GetRevision())
+		.Add(ox).Add(oy).Add(render_ox).Add(render_oy)
+		.Add(width).Add(height).Add(fast_blit)
+		.Add(animation_step_c).Add(animation_step_ab)
+		.Add(Game_Map::LoopHorizontal()).Add(Game_Map::LoopVertical())
+		.Get();
+}
+
 void TilemapLayer::SetTone(Tone tone) {
 	if (tone == this->tone) {
 		return;
 	}
 
+	++revision;
+
 	this->tone = tone;
 
 	if (autotiles_d_screen_effect) {
@@ -903,5 +1120,5 @@ void TilemapLayer::SetTone(Tone tone) {
 	if (chipset_effect) {
 		chipset_effect->Clear();
 	}
-	chipset_tone_tiles.clear();
+	std::fill(tile_atlas_toned.begin(), tile_atlas_toned.end(), 0);
 }
@@ -22,7 +22,6 @@
 #include <cstdint>
 #include <vector>
 #include <map>
-#include <unordered_set>
 #include <unordered_map>
 #include "system.h"
 #include "drawable.h"
@@ -41,6 +40,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
+
 private:
 	TilemapLayer* tilemap = nullptr;
 
@@ -58,10 +59,20 @@ public:
 	static constexpr uint8_t TileBelow = 0;
 	static constexpr uint8_t TileAbove = 100;
 
+	/** Width and height of a cached chunk in tiles */
+	static constexpr int CHUNK_SIZE = 16;
+
 	TilemapLayer(int ilayer);
 
 	void Draw(Bitmap& dst, uint8_t z_order, int render_ox, int render_oy);
 
+	/**
+	 * Damage tracking state shared by both sub layers.
+	 *
+	 * @see Drawable::GetDamageState
+	 */
+	std::optional<uint64_t> GetDamageState(Rect& bounds, int render_ox, int render_oy) const;
+
 	BitmapRef const& GetChipset() const;
 	void SetChipset(BitmapRef const& nchipset);
 	const std::vector<short>& GetMapData() const;
@@ -102,7 +113,6 @@ public:
 private:
 	BitmapRef chipset;
 	BitmapRef chipset_effect;
-	std::unordered_set<uint32_t> chipset_tone_tiles;
 	std::vector<short> map_data;
 	std::vector<uint8_t> passable;
 	std::vector<uint8_t> substitutions;
@@ -115,13 +125,16 @@ private:
 	int layer = 0;
 	bool fast_blit = false;
 
+	/** Incremented whenever tiles, passability, chipset or tone change */
+	uint64_t revision = 0;
+
 	void CreateTileCache(const std::vector<short>& nmap_data);
 	void CreateTileCacheAt(int x, int y, int tile_id);
 	void RecreateTileDataAt(int x, int y, int tile_id);
 	void GenerateAutotileAB(short ID, short animID);
 	void GenerateAutotileD(short ID);
-	void DrawTile(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, uint32_t tone_hash, bool allow_fast_blit = true);
-	void DrawTileImpl(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, uint32_t tone_hash, ImageOpacity op, bool allow_fast_blit);
+	void DrawTile(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, int atlas_index, bool allow_fast_blit = true);
+	void DrawTileImpl(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, int atlas_index, ImageOpacity op, bool allow_fast_blit);
 	void RecalculateAutotile(int x, int y, int tile_id);
 
 	static const int TILES_PER_ROW = 64;
@@ -152,11 +165,87 @@ private:
 	std::unordered_map<uint32_t, TileXY> autotiles_ab_map;
 	std::unordered_map<uint32_t, TileXY> autotiles_d_map;
 
+	/** Bitmap an atlas tile is read from */
+	enum AtlasSheet : uint8_t {
+		Sheet_Chipset,
+		Sheet_AutotilesAB,
+		Sheet_AutotilesD,
+		Sheet_Count
+	};
+
+	/** Animation a tile follows, selects the frame offset in the atlas */
+	enum TileAnimation : uint8_t {
+		Anim_None,
+		Anim_AB,
+		Anim_C,
+		Anim_Count
+	};
+
+	/** Atlas index of cells which are not drawn by this layer */
+	static constexpr uint16_t NoAtlasTile = UINT16_MAX;
+
+	/** Source position of a tile, one entry per animation frame */
+	struct AtlasTile {
+		uint8_t sheet;
+		uint8_t col;
+		uint8_t row;
+	};
+
 	struct TileData {
 		short ID;
 		uint8_t z;
+		uint8_t anim = Anim_None;
+		uint16_t atlas = NoAtlasTile;
 	};
 
+	/**
+	 * Resolves the source positions of all tiles in the data cache into the
+	 * atlas. Every distinct tile ID gets one entry per animation frame, so
+	 * drawing a cell is a plain array lookup.
+	 */
+	void CreateTileAtlas();
+	AtlasTile ResolveAtlasTile(short ID, int anim_step);
+
+	std::vector<AtlasTile> tile_atlas;
+	/** Whether the atlas entry was already tone changed into the effect sheet */
+	std::vector<uint8_t> tile_atlas_toned;
+
+	/**
+	 * Pre-rendered static tiles of a CHUNK_SIZE x CHUNK_SIZE area of one
+	 * sublayer. Animated tiles are drawn on top of it every frame.
+	 */
+	struct TileChunk {
+		int cx = 0;
+		int cy = 0;
+		uint8_t z = 0;
+		/** Static tiles, null when the chunk contains none */
+		BitmapRef bitmap;
+		/** Cells (x + y * CHUNK_SIZE) containing animated tiles */
+		std::vector<uint16_t> animated;
+		uint32_t last_used = 0;
+	};
+
+	/** Chunks kept when they are not visible, the least recently drawn one is reused */
+	static constexpr size_t MAX_CHUNKS = 32;
+	/** Draws without a change of the layer before the chunks are used */
+	static constexpr int CHUNK_STABLE_DRAWS = 4;
+
+	/**
+	 * Drops the chunks when the layer changed since they were created.
+	 *
+	 * @return whether the chunks shall be used for drawing
+	 */
+	bool UpdateChunkCache();
+	const TileChunk& GetChunk(int cx, int cy, uint8_t z);
+	void CreateChunk(TileChunk& chunk);
+
+	std::vector<TileChunk> chunks;
+	uint64_t chunk_revision = 0;
+	uint64_t chunk_chipset_revision = 0;
+	bool chunk_fast_blit = false;
+	int chunk_stable_draws = 0;
+	uint32_t chunk_draw_stamp = 0;
+
 	TileData& GetDataCache(int x, int y);
 
 	std::vector<TileData> data_cache_vec;
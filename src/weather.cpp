@@ -41,6 +41,16 @@ Weather::Weather() :
 void Weather::Update() {
 }
 
+std::optional<uint64_t> Weather::GetDamageState(Rect& bounds) {
+	if (Main_Data::game_screen->GetWeatherType() == Game_Screen::Weather_None) {
+		bounds = Rect();
+		return 0;
+	}
+
+	// The particles move every frame
+	return std::nullopt;
+}
+
 void Weather::Draw(Bitmap& dst) {
 	SetTone(Main_Data::game_screen->GetTone());
 
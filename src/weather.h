@@ -33,6 +33,8 @@ public:
 	Weather();
 
 	void Draw(Bitmap& dst) override;
+
+	std::optional<uint64_t> GetDamageState(Rect& bounds) override;
 	void Update();
 
 	Tone GetTone() const;
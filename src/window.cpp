@@ -24,6 +24,7 @@
 #include "window.h"
 #include "bitmap.h"
 #include "drawable_mgr.h"
+#include "damage_region.h"
 
 constexpr int arrow_animation_frames = 20;
 
@@ -192,6 +193,34 @@ void Window::Draw(Bitmap& dst) {
 	}
 }
 
+std::optional<uint64_t> Window::GetDamageState(Rect& bounds) {
+	if (width <= 0 || height <= 0) {
+		bounds = Rect();
+		return 0;
+	}
+
+	// The rotated side arrows can exceed the window rectangle
+	bounds = Rect(x - 8, y - 8, width + 16, height + 16);
+
+	DamageHash hash;
+	hash.Add(x).Add(y).Add(width).Add(height).Add(ox).Add(oy)
+		.Add(border_x).Add(border_y)
+		.Add(opacity).Add(frame_opacity).Add(back_opacity).Add(contents_opacity)
+		.Add(stretch).Add(background_alpha).Add(bg_preserve_transparent_color)
+		.Add(cursor_rect).Add(cursor_frame <= 10)
+		.Add(pause).Add(up_arrow).Add(down_arrow).Add(left_arrow).Add(right_arrow)
+		.Add(animate_arrows).Add(arrow_animation_frame < arrow_animation_frames)
+		.Add(animation_frames).Add(static_cast<int>(animation_count)).Add(closing)
+		.Add(windowskin.get()).Add(contents.get());
+	if (windowskin) {
+		hash.Add(windowskin->GetRevision());
+	}
+	if (contents) {
+		hash.Add(contents->GetRevision());
+	}
+	return hash.Get();
+}
+
 void Window::RefreshBackground() {
 	background_needs_refresh = false;
 
@@ -282,6 +282,7 @@ void Window_Settings::RefreshVideo() {
 	AddOption(cfg.stretch, []() { DisplayUi->ToggleStretch(); });
 	AddOption(cfg.scaling_mode, [this](){ DisplayUi->SetScalingMode(static_cast<ConfigEnum::ScalingMode>(GetCurrentOption().current_value)); });
 	AddOption(cfg.pause_when_focus_lost, [cfg]() mutable { DisplayUi->SetPauseWhenFocusLost(cfg.pause_when_focus_lost.Toggle()); });
+	AddOption(cfg.damage_tracking, [cfg]() mutable { DisplayUi->SetDamageTracking(cfg.damage_tracking.Toggle()); });
 	AddOption(cfg.touch_ui, [](){ DisplayUi->ToggleTouchUi(); });
 	AddOption(cfg.game_resolution, [this]() { DisplayUi->SetGameResolution(static_cast<ConfigEnum::GameResolution>(GetCurrentOption().current_value)); });
 	AddOption(cfg.screen_scale, [this](){ DisplayUi->SetScreenScale(GetCurrentOption().current_value); });
@@ -296,6 +297,8 @@ void Window_Settings::RefreshAudio() {
 		AddOption(MenuItem("MIDI drivers", "Configure MIDI playback", ""), [this]() { Push(eAudioMidi); });
 	}
 	AddOption(cfg.soundfont, [this](){ Push(eAudioSoundfont); });
+	AddOption(cfg.se_cache_size, [this](){ Audio().SE_SetCacheSize(GetCurrentOption().current_value); });
+	AddOption(cfg.se_preload, [](){ Audio().SE_SetPreloadEnabled(Audio().GetConfig().se_preload.Toggle()); });
 }
 
 void Window_Settings::RefreshAudioMidi() {
@@ -452,6 +455,7 @@ void Window_Settings::RefreshEngine() {
 		GetFrame().options.back().help2 = fmt::format("Sample name: {}", fmt_sample_name(true));
 	}
 	AddOption(cfg.automatic_screenshots_interval, [this, &cfg]() { cfg.automatic_screenshots_interval.Set(GetCurrentOption().current_value); });
+	AddOption(cfg.image_cache_size, [this, &cfg]() { cfg.image_cache_size.Set(GetCurrentOption().current_value); });
 }
 
 void Window_Settings::RefreshEngineFont(bool mincho) {
@@ -0,0 +1,48 @@
+#include "async_decoder.h"
+#include "doctest.h"
+#include <atomic>
+#include <vector>
+
+TEST_SUITE_BEGIN("AsyncDecoder");
+
+TEST_CASE("Flush") {
+	std::atomic<int> work_count = 0;
+	std::vector<int> done_order;
+
+	for (int i = 0; i < 16; ++i) {
+		AsyncDecoder::Submit([&work_count]() { ++work_count; }, [&done_order, i]() { done_order.push_back(i); });
+	}
+
+	AsyncDecoder::Flush();
+
+	REQUIRE_EQ(work_count, 16);
+	REQUIRE_EQ(done_order.size(), 16);
+	REQUIRE_FALSE(AsyncDecoder::IsBusy());
+}
+
+TEST_CASE("DoneQueuesWork") {
+	int result = 0;
+
+	AsyncDecoder::Submit([]() {}, [&result]() {
+		result = 1;
+		AsyncDecoder::Submit([]() {}, [&result]() { result = 2; });
+	});
+
+	AsyncDecoder::Flush();
+
+	REQUIRE_EQ(result, 2);
+	REQUIRE_FALSE(AsyncDecoder::IsBusy());
+}
+
+TEST_CASE("Quit") {
+	AsyncDecoder::Quit();
+
+	// Workers are started again on demand
+	bool done = false;
+	AsyncDecoder::Submit([]() {}, [&done]() { done = true; });
+	AsyncDecoder::Flush();
+
+	REQUIRE(done);
+}
+
+TEST_SUITE_END();
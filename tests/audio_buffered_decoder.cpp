@@ -0,0 +1,113 @@
+#include "audio_buffered_decoder.h"
+#include "doctest.h"
+
+#ifdef WANT_ASYNC_DECODE
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+TEST_SUITE_BEGIN("AudioBufferedDecoder");
+
+namespace {
+// Stereo float ramp, the left sample is the frame number + 1, negated when pitched
+class RampDecoder : public AudioDecoder {
+public:
+	bool Open(Filesystem_Stream::InputStream) override { return true; }
+	bool Seek(std::streamoff, std::ios_base::seekdir) override { pos = 0; return true; }
+	bool IsFinished() const override { return pos >= length; }
+	void GetFormat(int& frequency, Format& format, int& channels) const override {
+		frequency = 44100;
+		format = Format::F32;
+		channels = 2;
+	}
+	int GetPitch() const override { return pitch; }
+	bool SetPitch(int new_pitch) override { pitch = new_pitch; return true; }
+	int GetTicks() const override { return pos; }
+
+	int length = 1000;
+
+private:
+	int FillBuffer(uint8_t* buffer, int size) override {
+		float* samples = reinterpret_cast<float*>(buffer);
+		int frames = std::min(size / 8, length - pos);
+		for (int i = 0; i < frames; ++i) {
+			samples[i * 2] = static_cast<float>(pos + i + 1) * (pitch == 100 ? 1.0f : -1.0f);
+			samples[i * 2 + 1] = 0.0f;
+		}
+		pos += frames;
+		return frames * 8;
+	}
+
+	int pos = 0;
+	int pitch = 100;
+};
+
+std::vector<float> ReadFrames(AudioDecoderBase& decoder, int frames) {
+	std::vector<float> out;
+	std::vector<float> buf(64 * 2);
+	while (static_cast<int>(out.size()) < frames) {
+		int res = decoder.Decode(reinterpret_cast<uint8_t*>(buf.data()), buf.size() * sizeof(float));
+		REQUIRE(res > 0);
+		for (int i = 0; i < res / 4; i += 2) {
+			// Skip the silence played while the worker starts
+			if (buf[i] != 0.0f) {
+				out.push_back(buf[i]);
+			}
+		}
+		std::this_thread::yield();
+	}
+	out.resize(frames);
+	return out;
+}
+}
+
+TEST_CASE("Loop") {
+	auto ramp = std::make_unique<RampDecoder>();
+	ramp->SetLooping(true);
+	AudioBufferedDecoder decoder(std::move(ramp), std::chrono::milliseconds(50));
+
+	auto frames = ReadFrames(decoder, 2500);
+	for (int i = 0; i < 2500; ++i) {
+		REQUIRE_EQ(frames[i], static_cast<float>(i % 1000 + 1));
+	}
+	REQUIRE_GE(decoder.GetLoopCount(), 1);
+}
+
+TEST_CASE("Finish") {
+	auto ramp = std::make_unique<RampDecoder>();
+	AudioBufferedDecoder decoder(std::move(ramp), std::chrono::milliseconds(50));
+
+	auto frames = ReadFrames(decoder, 1000);
+	REQUIRE_EQ(frames.back(), 1000.0f);
+
+	// The worker flags the end after publishing the last chunk
+	for (int i = 0; i < 1000 && !decoder.IsFinished(); ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	REQUIRE(decoder.IsFinished());
+}
+
+TEST_CASE("Pitch") {
+	auto ramp = std::make_unique<RampDecoder>();
+	ramp->length = 1000000;
+	AudioBufferedDecoder decoder(std::move(ramp), std::chrono::milliseconds(50));
+
+	ReadFrames(decoder, 100);
+	decoder.SetPitch(150);
+	REQUIRE_EQ(decoder.GetPitch(), 150);
+
+	// Audio decoded with the old pitch is dropped
+	bool pitched = false;
+	for (int i = 0; i < 1000 && !pitched; ++i) {
+		pitched = ReadFrames(decoder, 1)[0] < 0.0f;
+	}
+	REQUIRE(pitched);
+	auto frames = ReadFrames(decoder, 100);
+	for (auto f: frames) {
+		REQUIRE_LT(f, 0.0f);
+	}
+}
+
+TEST_SUITE_END();
+
+#endif
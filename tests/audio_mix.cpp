@@ -0,0 +1,89 @@
+#include "audio_mix.h"
+#include "doctest.h"
+#include <cmath>
+#include <vector>
+
+TEST_SUITE_BEGIN("AudioMix");
+
+namespace {
+std::vector<float> MakeSamples(int count, uint32_t seed, float range) {
+	std::vector<float> samples(count);
+	for (auto& s: samples) {
+		seed = seed * 1664525u + 1013904223u;
+		s = (static_cast<float>(seed >> 8) / (1 << 24) * 2.0f - 1.0f) * range;
+	}
+	return samples;
+}
+}
+
+TEST_CASE("ToFloat") {
+	const int16_t s16[] = { 0, 1, -1, 16384, -16384, 32767, -32768, 100, -100, 12345, -12345 };
+	constexpr int n = sizeof(s16) / sizeof(s16[0]);
+
+	std::vector<float> out(n);
+	AudioMix::ToFloat(out.data(), s16, AudioDecoder::Format::S16, n);
+	for (int i = 0; i < n; ++i) {
+		REQUIRE_EQ(out[i], doctest::Approx(s16[i] / 32768.0));
+	}
+
+	const uint8_t u8[] = { 0, 128, 255 };
+	AudioMix::ToFloat(out.data(), u8, AudioDecoder::Format::U8, 3);
+	REQUIRE_EQ(out[0], -1.0f);
+	REQUIRE_EQ(out[1], 0.0f);
+	REQUIRE_EQ(out[2], doctest::Approx(127 / 128.0));
+
+	const int32_t s32[] = { INT32_MIN, 0, 1 << 30 };
+	AudioMix::ToFloat(out.data(), s32, AudioDecoder::Format::S32, 3);
+	REQUIRE_EQ(out[0], -1.0f);
+	REQUIRE_EQ(out[1], 0.0f);
+	REQUIRE_EQ(out[2], 0.5f);
+}
+
+TEST_CASE("Accumulate") {
+	for (int channels = 1; channels <= 3; ++channels) {
+		for (int frames: { 0, 1, 3, 4, 7, 64, 131 }) {
+			auto src = MakeSamples(frames * channels, frames + channels, 1.0f);
+			auto mix = MakeSamples(frames * 2, frames, 0.5f);
+			auto expected = mix;
+
+			for (int i = 0; i < frames; ++i) {
+				float l = src[i * channels];
+				float r = channels > 1 ? src[i * channels + 1] : l;
+				expected[i * 2] += l * 0.25f;
+				expected[i * 2 + 1] += r * 0.75f;
+			}
+
+			AudioMix::Accumulate(mix.data(), src.data(), frames, channels, 0.25f, 0.75f);
+			for (int i = 0; i < frames * 2; ++i) {
+				REQUIRE_EQ(mix[i], doctest::Approx(expected[i]));
+			}
+		}
+	}
+}
+
+TEST_CASE("ToS16") {
+	for (float total_volume: { 0.5f, 1.0f, 1.5f, 4.0f }) {
+		auto mix = MakeSamples(133, 7, total_volume * 1.25f);
+		mix[0] = 0.0f;
+		mix[1] = 1.0f;
+		mix[2] = -1.0f;
+		mix[3] = 100.0f;
+		mix[4] = -100.0f;
+
+		std::vector<int16_t> out(mix.size());
+		AudioMix::ToS16(out.data(), mix.data(), static_cast<int>(mix.size()), total_volume);
+
+		const float threshold = 0.8f;
+		for (size_t i = 0; i < mix.size(); ++i) {
+			float sample = std::abs(mix[i]);
+			if (total_volume > 1.0f && sample > threshold) {
+				sample = threshold + (1.0f - threshold) * (sample - threshold) / (total_volume - threshold);
+			}
+			double expected = std::copysign(sample, mix[i]) * 32768.0;
+			expected = std::trunc(std::min(std::max(expected, -32768.0), 32767.0));
+			REQUIRE_LE(std::abs(out[i] - expected), 1.0);
+		}
+	}
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,114 @@
+#include "audio_sinc_resampler.h"
+#include "doctest.h"
+#include <cmath>
+#include <vector>
+
+TEST_SUITE_BEGIN("AudioSincResampler");
+
+namespace {
+std::vector<float> Resample(AudioSincResampler& resampler, const std::vector<float>& in, int channels, int chunk) {
+	std::vector<float> out;
+	std::vector<float> buffer(64 * channels);
+	const int frames = static_cast<int>(in.size()) / channels;
+	int pos = 0;
+
+	for (;;) {
+		int in_frames = std::min(chunk, frames - pos);
+		int out_frames = 64;
+		resampler.Process(in.data() + pos * channels, in_frames, buffer.data(), out_frames);
+		pos += in_frames;
+		out.insert(out.end(), buffer.begin(), buffer.begin() + out_frames * channels);
+		if (in_frames == 0 && out_frames == 0) {
+			break;
+		}
+	}
+	return out;
+}
+
+std::vector<float> Sine(int frames, double frequency, int rate) {
+	std::vector<float> samples(frames);
+	for (int i = 0; i < frames; ++i) {
+		samples[i] = static_cast<float>(std::sin(2.0 * 3.14159265358979 * frequency * i / rate) * 0.5);
+	}
+	return samples;
+}
+}
+
+TEST_CASE("Linear") {
+	AudioSincResampler resampler(1, AudioSincResampler::Quality::Linear);
+	resampler.SetRatio(0.25);
+
+	std::vector<float> ramp = { 0.0f, 1.0f, 2.0f, 3.0f };
+	auto out = Resample(resampler, ramp, 1, 4);
+
+	REQUIRE_EQ(out.size(), 12);
+	for (size_t i = 0; i < out.size(); ++i) {
+		REQUIRE_EQ(out[i], doctest::Approx(i * 0.25f));
+	}
+}
+
+TEST_CASE("Stereo") {
+	AudioSincResampler resampler(2, AudioSincResampler::Quality::Low);
+	resampler.SetRatio(1.5);
+
+	std::vector<float> in(2000);
+	for (size_t i = 0; i < in.size(); i += 2) {
+		in[i] = 0.5f;
+		in[i + 1] = -0.25f;
+	}
+	auto out = Resample(resampler, in, 2, 100);
+
+	REQUIRE_GT(out.size(), 1200);
+	// Skip the start, the filter reads the zeros before the first frame
+	for (size_t i = 32; i < out.size(); i += 2) {
+		REQUIRE_EQ(out[i], doctest::Approx(0.5f).epsilon(0.001));
+		REQUIRE_EQ(out[i + 1], doctest::Approx(-0.25f).epsilon(0.001));
+	}
+}
+
+TEST_CASE("Sine") {
+	for (auto quality : { AudioSincResampler::Quality::Low, AudioSincResampler::Quality::Medium, AudioSincResampler::Quality::High }) {
+		AudioSincResampler resampler(1, quality);
+		resampler.SetRatio(22050.0 / 44100.0);
+
+		auto out = Resample(resampler, Sine(4410, 1000.0, 22050), 1, 77);
+		auto expected = Sine(8820, 1000.0, 44100);
+
+		// The last frames within half the filter are not output
+		REQUIRE_GE(out.size(), 8820 - resampler.GetTaps());
+		for (size_t i = resampler.GetTaps(); i < out.size() - resampler.GetTaps(); ++i) {
+			REQUIRE_EQ(out[i], doctest::Approx(expected[i]).epsilon(0.01));
+		}
+	}
+}
+
+TEST_CASE("Chunks") {
+	auto in = Sine(3000, 440.0, 44100);
+
+	AudioSincResampler whole(1, AudioSincResampler::Quality::Medium);
+	whole.SetRatio(44100.0 / 48000.0);
+	AudioSincResampler split(1, AudioSincResampler::Quality::Medium);
+	split.SetRatio(44100.0 / 48000.0);
+
+	auto a = Resample(whole, in, 1, 3000);
+	auto b = Resample(split, in, 1, 7);
+
+	REQUIRE_EQ(a.size(), b.size());
+	for (size_t i = 0; i < a.size(); ++i) {
+		REQUIRE_EQ(a[i], b[i]);
+	}
+}
+
+TEST_CASE("Reset") {
+	AudioSincResampler resampler(1, AudioSincResampler::Quality::Low);
+	resampler.SetRatio(0.5);
+
+	auto in = Sine(500, 440.0, 22050);
+	auto a = Resample(resampler, in, 1, 500);
+	resampler.Reset();
+	auto b = Resample(resampler, in, 1, 500);
+
+	REQUIRE_EQ(a, b);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,117 @@
+#include "bitmap_tone.h"
+#include "doctest.h"
+#include <vector>
+
+TEST_SUITE_BEGIN("BitmapTone");
+
+namespace {
+std::vector<uint32_t> MakePixels(int count, uint32_t seed) {
+	std::vector<uint32_t> pixels(count);
+	for (auto& px: pixels) {
+		seed = seed * 1664525u + 1013904223u;
+		px = seed;
+	}
+	// Ensure the special alpha values are covered
+	for (int i = 0; i < count; i += 7) {
+		pixels[i] &= 0x00FFFFFF;
+	}
+	for (int i = 3; i < count; i += 11) {
+		pixels[i] |= 0xFF000000;
+	}
+	return pixels;
+}
+
+void TestIsa(BitmapTone::Isa isa) {
+	const Tone tones[] = {
+		Tone(128, 128, 128, 0),
+		Tone(128, 128, 128, 255),
+		Tone(0, 255, 128, 128),
+		Tone(255, 0, 129, 64),
+		Tone(127, 200, 30, 200),
+		Tone(50, 128, 255, 0),
+	};
+	const int shifts[][4] = {
+		{ 0, 8, 16, 24 },
+		{ 16, 8, 0, 24 },
+		{ 8, 16, 24, 0 },
+	};
+
+	for (auto& tone: tones) {
+		for (auto& s: shifts) {
+			for (int flags = 0; flags < 4; ++flags) {
+				auto params = BitmapTone::MakeParams(tone, s[0], s[1], s[2], s[3]);
+				params.skip_transparent = (flags & 1) != 0;
+				params.premultiply = (flags & 2) != 0;
+
+				for (int count: { 1, 5, 16, 37, 301 }) {
+					auto expected = MakePixels(count, count * 31 + flags);
+					auto actual = expected;
+
+					BitmapTone::Apply(expected.data(), count, params, BitmapTone::Isa::Scalar);
+					BitmapTone::Apply(actual.data(), count, params, isa);
+
+					REQUIRE_EQ(expected, actual);
+				}
+			}
+		}
+	}
+}
+}
+
+TEST_CASE("MakeParams") {
+	auto params = BitmapTone::MakeParams(Tone(128, 128, 128, 128), 0, 8, 16, 24);
+	REQUIRE_FALSE(params.apply_sat);
+	REQUIRE_FALSE(params.apply_tone);
+	REQUIRE_EQ(params.sat, 1024);
+
+	params = BitmapTone::MakeParams(Tone(128, 0, 128, 0), 0, 8, 16, 24);
+	REQUIRE(params.apply_sat);
+	REQUIRE(params.apply_tone);
+	REQUIRE_EQ(params.sat, 0);
+
+	params = BitmapTone::MakeParams(Tone(128, 128, 128, 255), 0, 8, 16, 24);
+	REQUIRE(params.apply_sat);
+	REQUIRE_FALSE(params.apply_tone);
+	REQUIRE_EQ(params.sat, 1024 + 127 * 16);
+}
+
+TEST_CASE("Scalar") {
+	auto params = BitmapTone::MakeParams(Tone(255, 0, 128, 128), 0, 8, 16, 24);
+
+	uint32_t pixels[] = { 0xFF406080, 0x00406080, 0x80FF00FF };
+	BitmapTone::Apply(pixels, 3, params, BitmapTone::Isa::Scalar);
+
+	REQUIRE_EQ(pixels[0], 0xFF4000FFu);
+	REQUIRE_EQ(pixels[1], 0x004000FFu);
+	REQUIRE_EQ(pixels[2], 0x80FF00FFu);
+
+	params.skip_transparent = true;
+	params.premultiply = true;
+	uint32_t alpha_pixels[] = { 0x00406080, 0x80406080 };
+	BitmapTone::Apply(alpha_pixels, 2, params, BitmapTone::Isa::Scalar);
+
+	REQUIRE_EQ(alpha_pixels[0], 0x00406080u);
+	REQUIRE_EQ(alpha_pixels[1], 0x80200080u);
+}
+
+TEST_CASE("Vectorized") {
+	for (auto isa: { BitmapTone::Isa::SSE2, BitmapTone::Isa::AVX2, BitmapTone::Isa::NEON }) {
+		if (BitmapTone::IsSupported(isa)) {
+			TestIsa(isa);
+		}
+	}
+}
+
+TEST_CASE("Unsupported format") {
+	// Non byte aligned channels fall back to the scalar code
+	auto params = BitmapTone::MakeParams(Tone(0, 255, 128, 40), 0, 5, 10, 15);
+
+	auto expected = MakePixels(33, 7);
+	auto actual = expected;
+	BitmapTone::Apply(expected.data(), 33, params, BitmapTone::Isa::Scalar);
+	BitmapTone::Apply(actual.data(), 33, params);
+
+	REQUIRE_EQ(expected, actual);
+}
+
+TEST_SUITE_END();
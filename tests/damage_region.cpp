@@ -0,0 +1,119 @@
+#include "damage_region.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("DamageRegion");
+
+TEST_CASE("Default") {
+	DamageRegion region;
+
+	REQUIRE(region.IsEmpty());
+	REQUIRE(region.GetRects().empty());
+	REQUIRE(region.GetBounds().IsEmpty());
+}
+
+TEST_CASE("AddEmpty") {
+	DamageRegion region;
+
+	region.Add(Rect());
+	region.Add(Rect(5, 5, 0, 10));
+	region.Add(Rect(5, 5, 10, -1));
+
+	REQUIRE(region.IsEmpty());
+}
+
+TEST_CASE("AddDisjoint") {
+	DamageRegion region;
+
+	region.Add(Rect(0, 0, 10, 10));
+	region.Add(Rect(20, 20, 10, 10));
+
+	REQUIRE_EQ(region.GetRects().size(), 2);
+	REQUIRE_EQ(region.GetBounds(), Rect(0, 0, 30, 30));
+}
+
+TEST_CASE("AddOverlapping") {
+	DamageRegion region;
+
+	region.Add(Rect(0, 0, 10, 10));
+	region.Add(Rect(5, 5, 10, 10));
+
+	REQUIRE_EQ(region.GetRects().size(), 1);
+	REQUIRE_EQ(region.GetRects()[0], Rect(0, 0, 15, 15));
+}
+
+TEST_CASE("AddAdjacent") {
+	DamageRegion region;
+
+	region.Add(Rect(0, 0, 16, 16));
+	region.Add(Rect(16, 0, 16, 16));
+
+	REQUIRE_EQ(region.GetRects().size(), 1);
+	REQUIRE_EQ(region.GetRects()[0], Rect(0, 0, 32, 16));
+}
+
+TEST_CASE("AddChainMerge") {
+	DamageRegion region;
+
+	region.Add(Rect(0, 0, 10, 10));
+	region.Add(Rect(40, 0, 10, 10));
+	REQUIRE_EQ(region.GetRects().size(), 2);
+
+	// Touches both rectangles
+	region.Add(Rect(5, 0, 40, 5));
+	REQUIRE_EQ(region.GetRects().size(), 1);
+	REQUIRE_EQ(region.GetRects()[0], Rect(0, 0, 50, 10));
+}
+
+TEST_CASE("AddLimit") {
+	DamageRegion region;
+
+	for (int i = 0; i < 20; ++i) {
+		region.Add(Rect(i * 20, 0, 5, 5));
+	}
+
+	REQUIRE_LE(region.GetRects().size(), DamageRegion::max_rects);
+	REQUIRE_EQ(region.GetBounds(), Rect(0, 0, 19 * 20 + 5, 5));
+
+	// Every added rectangle is still covered
+	for (int i = 0; i < 20; ++i) {
+		Rect r(i * 20, 0, 5, 5);
+		bool covered = false;
+		for (auto& rect: region.GetRects()) {
+			covered |= r.x >= rect.x && r.y >= rect.y
+				&& r.x + r.width <= rect.x + rect.width
+				&& r.y + r.height <= rect.y + rect.height;
+		}
+		REQUIRE(covered);
+	}
+}
+
+TEST_CASE("Clip") {
+	DamageRegion region;
+
+	region.Add(Rect(-10, -10, 20, 20));
+	region.Add(Rect(300, 300, 20, 20));
+	region.Clip(Rect(0, 0, 320, 240));
+
+	REQUIRE_EQ(region.GetRects().size(), 1);
+	REQUIRE_EQ(region.GetRects()[0], Rect(0, 0, 10, 10));
+}
+
+TEST_CASE("Union") {
+	REQUIRE_EQ(DamageRegion::Union(Rect(), Rect(1, 2, 3, 4)), Rect(1, 2, 3, 4));
+	REQUIRE_EQ(DamageRegion::Union(Rect(1, 2, 3, 4), Rect()), Rect(1, 2, 3, 4));
+	REQUIRE_EQ(DamageRegion::Union(Rect(0, 0, 1, 1), Rect(9, 9, 1, 1)), Rect(0, 0, 10, 10));
+}
+
+TEST_CASE("Intersects") {
+	REQUIRE(DamageRegion::Intersects(Rect(0, 0, 10, 10), Rect(5, 5, 10, 10)));
+	REQUIRE_FALSE(DamageRegion::Intersects(Rect(0, 0, 10, 10), Rect(10, 0, 10, 10)));
+	REQUIRE_FALSE(DamageRegion::Intersects(Rect(), Rect(0, 0, 10, 10)));
+}
+
+TEST_CASE("Hash") {
+	REQUIRE_EQ(DamageHash().Add(1).Add(2).Get(), DamageHash().Add(1).Add(2).Get());
+	REQUIRE_NE(DamageHash().Add(1).Add(2).Get(), DamageHash().Add(2).Add(1).Get());
+	REQUIRE_NE(DamageHash().Add(Rect(0, 0, 1, 1)).Get(), DamageHash().Add(Rect(0, 0, 1, 2)).Get());
+}
+
+TEST_SUITE_END();
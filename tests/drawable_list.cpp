@@ -16,6 +16,20 @@ class TestSprite : public Drawable {
 		void Draw(Bitmap&) override {}
 };
 
+class TrackedSprite : public Drawable {
+	public:
+		TrackedSprite(Drawable::Z_t z = 0) : Drawable(z, Drawable::Flags::Global) {}
+		void Draw(Bitmap&) override { ++draw_count; }
+		std::optional<uint64_t> GetDamageState(Rect& bounds) override {
+			bounds = rect;
+			return state;
+		}
+
+		Rect rect;
+		std::optional<uint64_t> state = 0;
+		int draw_count = 0;
+};
+
 class TestFrame : public Drawable {
 	public:
 		TestFrame(Drawable::Z_t z = 0) : Drawable(z, Drawable::Flags::Global | Drawable::Flags::Shared) {}
@@ -350,4 +364,68 @@ TEST_CASE("TakeFromPred") {
 	REQUIRE(list2.IsDirty());
 }
 
+TEST_CASE("CollectDamage") {
+	DrawableList default_list;
+	DrawableMgr::SetLocalList(&default_list);
+
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Bitmap bitmap(64, 64, false);
+
+	auto min_z = std::numeric_limits<Drawable::Z_t>::min();
+	auto max_z = std::numeric_limits<Drawable::Z_t>::max();
+
+	DrawableList list;
+	TrackedSprite s1(1);
+	TrackedSprite s2(2);
+	s1.rect = Rect(0, 0, 8, 8);
+	s2.rect = Rect(32, 32, 8, 8);
+	list.Append(&s1);
+	list.Append(&s2);
+
+	// First collection reports everything
+	DamageRegion damage;
+	REQUIRE(list.CollectDamage(damage, min_z, max_z));
+	REQUIRE_EQ(damage.GetBounds(), Rect(0, 0, 40, 40));
+
+	// Nothing changed
+	damage.Clear();
+	REQUIRE(list.CollectDamage(damage, min_z, max_z));
+	REQUIRE(damage.IsEmpty());
+
+	// Moving reports the old and the new area
+	s1.rect = Rect(8, 0, 8, 8);
+	damage.Clear();
+	REQUIRE(list.CollectDamage(damage, min_z, max_z));
+	REQUIRE_EQ(damage.GetBounds(), Rect(0, 0, 16, 8));
+
+	// Only drawables in the clip rect are drawn
+	list.Draw(bitmap, min_z, max_z, damage.GetBounds());
+	REQUIRE_EQ(s1.draw_count, 1);
+	REQUIRE_EQ(s2.draw_count, 0);
+
+	// State change without movement
+	s2.state = 1;
+	damage.Clear();
+	REQUIRE(list.CollectDamage(damage, min_z, max_z));
+	REQUIRE_EQ(damage.GetBounds(), Rect(32, 32, 8, 8));
+
+	// Hiding reports the old area
+	s2.SetVisible(false);
+	damage.Clear();
+	REQUIRE(list.CollectDamage(damage, min_z, max_z));
+	REQUIRE_EQ(damage.GetBounds(), Rect(32, 32, 8, 8));
+
+	// Removing reports the old area
+	list.Take(&s1);
+	damage.Clear();
+	REQUIRE(list.CollectDamage(damage, min_z, max_z));
+	REQUIRE_EQ(damage.GetBounds(), Rect(8, 0, 8, 8));
+
+	// Untracked drawables
+	s2.SetVisible(true);
+	s2.state = std::nullopt;
+	damage.Clear();
+	REQUIRE_FALSE(list.CollectDamage(damage, min_z, max_z));
+}
+
 TEST_SUITE_END();
@@ -0,0 +1,199 @@
+#include "event_program.h"
+#include "doctest.h"
+#include <vector>
+
+using Cmd = EventProgram::Cmd;
+
+namespace {
+lcf::rpg::EventCommand Make(Cmd code, int indent, std::vector<int32_t> params = {}) {
+	lcf::rpg::EventCommand com;
+	com.code = static_cast<int32_t>(code);
+	com.indent = indent;
+	com.parameters = lcf::DBArray<int32_t>(params.begin(), params.end());
+	return com;
+}
+
+// 0  Label 1
+// 1  Loop
+// 2    ConditionalBranch
+// 3      BreakLoop
+// 4    ElseBranch
+// 5      JumpToLabel 1
+// 6    EndBranch
+// 7  EndLoop
+// 8  Label 2
+std::vector<lcf::rpg::EventCommand> MakeList() {
+	return {
+		Make(Cmd::Label, 0, { 1 }),
+		Make(Cmd::Loop, 0),
+		Make(Cmd::ConditionalBranch, 1),
+		Make(Cmd::BreakLoop, 2),
+		Make(Cmd::ElseBranch, 1),
+		Make(Cmd::JumpToLabel, 2, { 1 }),
+		Make(Cmd::EndBranch, 1),
+		Make(Cmd::EndLoop, 0),
+		Make(Cmd::Label, 0, { 2 }),
+	};
+}
+}
+
+TEST_SUITE_BEGIN("EventProgram");
+
+TEST_CASE("Decode") {
+	auto list = MakeList();
+	EventProgram program(list);
+
+	REQUIRE(program.IsCompiledFrom(list));
+	REQUIRE_EQ(program.GetSize(), 9);
+	REQUIRE_EQ(program.GetCode(3), Cmd::BreakLoop);
+	REQUIRE_EQ(program.GetIndent(3), 2);
+
+	auto copy = list;
+	REQUIRE_FALSE(program.IsCompiledFrom(copy));
+}
+
+TEST_CASE("FindNext") {
+	auto list = MakeList();
+	EventProgram program(list);
+
+	REQUIRE_EQ(program.FindNext(2, { Cmd::ElseBranch, Cmd::EndBranch }, 1), 4);
+	REQUIRE_EQ(program.FindNext(4, { Cmd::EndBranch }, 1), 6);
+	REQUIRE_EQ(program.FindNext(3, { Cmd::EndLoop }, 0), 7);
+	// Stops at lower indentation
+	REQUIRE_EQ(program.FindNext(2, { Cmd::Label }, 1), 8);
+	REQUIRE_EQ(program.FindNext(7, { Cmd::EndLoop }, 0), 9);
+	REQUIRE_EQ(program.FindNext(8, { Cmd::EndLoop }, 0), 9);
+}
+
+TEST_CASE("FindLoopStart") {
+	auto list = MakeList();
+	EventProgram program(list);
+
+	REQUIRE_EQ(program.FindLoopStart(7, 0), 1);
+	REQUIRE_EQ(program.FindLoopStart(0, 0), -1);
+	REQUIRE_EQ(program.FindLoopStart(5, 2), EventProgram::out_of_scope);
+}
+
+TEST_CASE("FindLabel") {
+	auto list = MakeList();
+	EventProgram program(list);
+
+	REQUIRE_EQ(program.FindLabel(1), 0);
+	REQUIRE_EQ(program.FindLabel(2), 8);
+	REQUIRE_EQ(program.FindLabel(3), -1);
+}
+
+TEST_CASE("CachedJumps") {
+	auto list = MakeList();
+	EventProgram program(list);
+
+	for (int i = 0; i < 2; ++i) {
+		REQUIRE_EQ(program.FindNext(3, { Cmd::EndLoop }, 0), 7);
+		REQUIRE_EQ(program.FindLoopStart(7, 0), 1);
+		REQUIRE_EQ(program.FindLabel(1), 0);
+	}
+
+	// Different arguments from the same command are not answered from the cache
+	REQUIRE_EQ(program.FindNext(3, { Cmd::EndLoop }, std::numeric_limits<int>::max()), 7);
+	REQUIRE_EQ(program.FindNext(3, { Cmd::EndBranch }, 1), 6);
+	REQUIRE_EQ(program.FindNext(3, { Cmd::EndLoop }, 0), 7);
+	REQUIRE_EQ(program.FindNext(3, { Cmd::EndLoop, Cmd::EndBranch, Cmd::ElseBranch, Cmd::Label }, 0), 7);
+}
+
+TEST_CASE("Operands") {
+	using Kind = EventProgram::Operands::Kind;
+
+	std::vector<lcf::rpg::EventCommand> list = {
+		Make(Cmd::ControlSwitches, 0, { 1, 3, 5, 2 }),
+		Make(Cmd::ControlVars, 0, { 0, 7, 7, 1, 1, 9, 0 }),
+		Make(Cmd::ConditionalBranch, 0, { 0, 4, 1, 0, 0, 0 }),
+		Make(Cmd::ConditionalBranch, 0, { 1, 2, 0, 10, 3, 0 }),
+		Make(Cmd::Wait, 0, { 15, 0, 0 }),
+		Make(Cmd::Loop, 0),
+		Make(Cmd::EndLoop, 0),
+		// Forms left to the generic handlers
+		Make(Cmd::ControlVars, 0, { 1, 1, 5, 0, 0, 1, 0 }),
+		Make(Cmd::ControlVars, 0, { 0, 1, 1, 6, 0, 1, 0 }),
+		Make(Cmd::ConditionalBranch, 0, { 1, 2, 2, 10, 3, 0 }),
+		Make(Cmd::ConditionalBranch, 0, { 3, 100, 0, 0, 0, 0 }),
+		Make(Cmd::Wait, 0, { 0, 1 }),
+		Make(Cmd::Loop, 0, { 1, 0, 3, 0, 0 }),
+		Make(Cmd::ControlSwitches, 0, { 0, 1 }),
+	};
+	EventProgram program(list);
+
+	const auto& switches = program.GetOperands(0);
+	REQUIRE_EQ(switches.kind, Kind::ControlSwitches);
+	REQUIRE_EQ(switches.a, 3);
+	REQUIRE_EQ(switches.b, 5);
+	REQUIRE_EQ(switches.op, 2);
+
+	const auto& variable = program.GetOperands(1);
+	REQUIRE_EQ(variable.kind, Kind::ControlVariable);
+	REQUIRE_EQ(variable.a, 7);
+	REQUIRE_EQ(variable.b, 9);
+	REQUIRE_EQ(variable.op, 1);
+	REQUIRE(variable.indirect);
+
+	const auto& branch_switch = program.GetOperands(2);
+	REQUIRE_EQ(branch_switch.kind, Kind::BranchSwitch);
+	REQUIRE_EQ(branch_switch.a, 4);
+	REQUIRE_EQ(branch_switch.b, 0);
+
+	const auto& branch_variable = program.GetOperands(3);
+	REQUIRE_EQ(branch_variable.kind, Kind::BranchVariable);
+	REQUIRE_EQ(branch_variable.a, 2);
+	REQUIRE_EQ(branch_variable.b, 10);
+	REQUIRE_EQ(branch_variable.op, 3);
+	REQUIRE_FALSE(branch_variable.indirect);
+
+	REQUIRE_EQ(program.GetOperands(4).kind, Kind::Wait);
+	REQUIRE_EQ(program.GetOperands(4).a, 15);
+	REQUIRE_EQ(program.GetOperands(5).kind, Kind::Loop);
+	REQUIRE_EQ(program.GetOperands(6).kind, Kind::EndLoop);
+
+	for (int i = 7; i < program.GetSize(); ++i) {
+		REQUIRE_EQ(program.GetOperands(i).kind, Kind::None);
+	}
+
+	// Changed parameters are noticed
+	REQUIRE(program.IsCompiledFrom(list));
+	list[0].parameters[3] = 0;
+	REQUIRE_FALSE(program.IsCompiledFrom(list));
+}
+
+TEST_CASE("Shared") {
+	auto list = MakeList();
+	auto common = MakeList();
+
+	auto shared = EventProgram::GetShared(EventProgram::Owner::MapEvent, 1, 1, list);
+	auto program = shared.get();
+	REQUIRE(program->IsCompiledFrom(list));
+	REQUIRE_EQ(EventProgram::GetShared(EventProgram::Owner::MapEvent, 1, 1, list).get(), program);
+	REQUIRE_NE(EventProgram::GetShared(EventProgram::Owner::MapEvent, 1, 2, list).get(), program);
+	REQUIRE_NE(EventProgram::GetShared(EventProgram::Owner::CommonEvent, 1, 0, common).get(), program);
+
+	// A changed list is decoded again
+	list.pop_back();
+	auto changed = EventProgram::GetShared(EventProgram::Owner::MapEvent, 1, 1, list);
+	REQUIRE_NE(changed.get(), program);
+	REQUIRE_EQ(changed->GetSize(), 8);
+
+	// Same address and length but different commands
+	list[0] = Make(Cmd::Label, 0, { 3 });
+	REQUIRE_FALSE(changed->IsCompiledFrom(list));
+	auto relabeled = EventProgram::GetShared(EventProgram::Owner::MapEvent, 1, 1, list);
+	REQUIRE_EQ(relabeled->FindLabel(3), 0);
+
+	// Only the programs of the event are dropped
+	auto common_program = EventProgram::GetShared(EventProgram::Owner::CommonEvent, 1, 0, common);
+	EventProgram::DropShared(EventProgram::Owner::MapEvent, 1);
+	REQUIRE_NE(EventProgram::GetShared(EventProgram::Owner::MapEvent, 1, 1, list).get(), relabeled.get());
+	REQUIRE_EQ(EventProgram::GetShared(EventProgram::Owner::CommonEvent, 1, 0, common).get(), common_program.get());
+
+	EventProgram::ClearShared();
+	REQUIRE_NE(EventProgram::GetShared(EventProgram::Owner::MapEvent, 1, 1, list).get(), changed.get());
+	EventProgram::ClearShared();
+}
+
+TEST_SUITE_END();
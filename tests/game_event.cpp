@@ -5,6 +5,8 @@
 #include "main_data.h"
 #include <climits>
 
+#include "mock_game.h"
+
 TEST_SUITE_BEGIN("Game_Event");
 
 TEST_CASE("IdName") {
@@ -28,4 +30,38 @@ TEST_CASE("IdName") {
 	}
 }
 
+static int ActivePageId(int event_id) {
+	auto* page = Game_Map::GetEvent(event_id)->GetActivePage();
+	return page ? page->ID : 0;
+}
+
+TEST_CASE("RefreshObservingEvents") {
+	const MockGame mg(MockMap::ePageConditions);
+	Game_Map::Refresh();
+	REQUIRE_FALSE(Game_Map::GetNeedRefresh());
+
+	Main_Data::game_switches->Set(1, true);
+	Main_Data::game_switches->Set(2, true);
+	Game_Map::SetNeedRefreshForSwitchChange(1);
+	REQUIRE(Game_Map::GetNeedRefresh());
+
+	// Only event 2 observes switch 1
+	Game_Map::Refresh();
+	REQUIRE_FALSE(Game_Map::GetNeedRefresh());
+	REQUIRE_EQ(ActivePageId(2), 2);
+	REQUIRE_EQ(ActivePageId(3), 1);
+	REQUIRE_EQ(ActivePageId(4), 1);
+
+	Main_Data::game_variables->Set(1, 5);
+	Game_Map::SetNeedRefreshForVarChange(1);
+	Game_Map::Refresh();
+	REQUIRE_EQ(ActivePageId(3), 1);
+	REQUIRE_EQ(ActivePageId(4), 2);
+
+	// A full refresh reaches everything
+	Game_Map::SetNeedRefresh(true);
+	Game_Map::Refresh();
+	REQUIRE_EQ(ActivePageId(3), 2);
+}
+
 TEST_SUITE_END();
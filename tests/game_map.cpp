@@ -0,0 +1,131 @@
+#include "game_map.h"
+#include "doctest.h"
+#include "event_program.h"
+#include "main_data.h"
+#include "map_data.h"
+
+#include "mock_game.h"
+
+TEST_SUITE_BEGIN("Game_Map");
+
+static std::vector<int> EventIdsXY(int x, int y) {
+	std::vector<int> ids;
+	for (auto* ev: Game_Map::GetEventsXY(x, y)) {
+		ids.push_back(ev->GetId());
+	}
+	return ids;
+}
+
+TEST_CASE("EventsAtPosition") {
+	const MockGame mg(MockMap::ePageConditions);
+
+	REQUIRE_EQ(Game_Map::GetEventAt(1, 0, false)->GetId(), 2);
+	REQUIRE_EQ(EventIdsXY(1, 0), std::vector<int>{ 2 });
+	REQUIRE_FALSE(Game_Map::GetEventAt(5, 5, false));
+
+	// Highest id wins
+	Game_Map::GetEvent(3)->SetX(1);
+	REQUIRE_EQ(Game_Map::GetEventAt(1, 0, false)->GetId(), 3);
+	REQUIRE_EQ(EventIdsXY(1, 0), std::vector<int>{ 2, 3 });
+	REQUIRE(EventIdsXY(2, 0).empty());
+
+	// Into another bucket and back
+	Game_Map::GetEvent(3)->SetX(12);
+	Game_Map::GetEvent(3)->SetY(10);
+	REQUIRE_EQ(Game_Map::GetEventAt(12, 10, false)->GetId(), 3);
+	REQUIRE_EQ(Game_Map::GetEventAt(1, 0, false)->GetId(), 2);
+
+	Game_Map::GetEvent(3)->SetX(1);
+	Game_Map::GetEvent(3)->SetY(0);
+	REQUIRE_EQ(EventIdsXY(1, 0), std::vector<int>{ 2, 3 });
+	REQUIRE_FALSE(Game_Map::GetEventAt(12, 10, false));
+}
+
+TEST_CASE("EventsOutsideOfMap") {
+	const MockGame mg(MockMap::ePageConditions);
+
+	Game_Map::GetEvent(2)->SetX(-3);
+	Game_Map::GetEvent(4)->SetY(100);
+
+	REQUIRE_EQ(Game_Map::GetEventAt(-3, 0, false)->GetId(), 2);
+	REQUIRE_EQ(Game_Map::GetEventAt(3, 100, false)->GetId(), 4);
+	REQUIRE_FALSE(Game_Map::GetEventAt(1, 0, false));
+	REQUIRE(EventIdsXY(-3, 100).empty());
+}
+
+TEST_CASE("PassableTile") {
+	const MockGame mg(MockMap::ePassBlock20x15);
+
+	// Upper tiles drawn above, the lower layer decides
+	lcf::Data::chipsets[0].passable_data_upper[0] = Passable::Down | Passable::Left | Passable::Right | Passable::Up | Passable::Above;
+	Game_Map::SetChipset(0);
+
+	REQUIRE(Game_Map::IsPassableTile(nullptr, Passable::Down, 2, 2));
+	REQUIRE_FALSE(Game_Map::IsPassableTile(nullptr, Passable::Down, 15, 2));
+	REQUIRE_FALSE(Game_Map::IsPassableTile(nullptr, 0, 2, 2));
+
+	Game_Map::ReplaceTileAt(15, 2, BLOCK_E, 0);
+	REQUIRE(Game_Map::IsPassableTile(nullptr, Passable::Down, 15, 2));
+	REQUIRE_FALSE(Game_Map::IsPassableTile(nullptr, Passable::Down, 16, 2));
+
+	Game_Map::SubstituteDown(1, 0);
+	REQUIRE(Game_Map::IsPassableTile(nullptr, Passable::Down, 16, 2));
+
+	Game_Map::SubstituteDown(0, 1);
+	REQUIRE_FALSE(Game_Map::IsPassableTile(nullptr, Passable::Down, 2, 2));
+	REQUIRE_FALSE(Game_Map::IsPassableTile(nullptr, Passable::Down, 16, 2));
+
+	// Upper tile not drawn above
+	lcf::Data::chipsets[0].passable_data_upper[0] = Passable::Left;
+	Game_Map::SetChipset(0);
+	REQUIRE(Game_Map::IsPassableTile(nullptr, Passable::Left, 16, 2));
+	REQUIRE_FALSE(Game_Map::IsPassableTile(nullptr, Passable::Down, 16, 2));
+}
+
+TEST_CASE("DirtyEventsRecordedOnce") {
+	using Op = Game_Map::Caching::ObservedVarOps;
+	Game_Map::Caching::MapCache cache;
+
+	lcf::rpg::Event ev3;
+	ev3.ID = 3;
+	lcf::rpg::Event ev5;
+	ev5.ID = 5;
+	cache.AddEventAsRefreshTarget<Op::SwitchSet>(1, ev3);
+	cache.AddEventAsRefreshTarget<Op::SwitchSet>(1, ev5);
+	cache.AddEventAsRefreshTarget<Op::VarSet>(2, ev5);
+
+	// Many writes in one frame, e.g. a loop of a parallel event
+	for (int i = 0; i < 1000; ++i) {
+		REQUIRE(cache.MarkRefreshTargets<Op::VarSet>(2));
+		REQUIRE(cache.MarkRefreshTargets<Op::SwitchSet>(1));
+	}
+	REQUIRE_FALSE(cache.MarkRefreshTargets<Op::VarSet>(1));
+
+	REQUIRE(cache.HasDirtyEvents());
+	REQUIRE_EQ(cache.TakeDirtyEvents(), std::vector<int>{ 3, 5 });
+	REQUIRE_FALSE(cache.HasDirtyEvents());
+
+	cache.MarkRefreshTargets<Op::VarSet>(2);
+	REQUIRE_EQ(cache.TakeDirtyEvents(), std::vector<int>{ 5 });
+}
+
+TEST_CASE("SharedProgramOfClonedEvent") {
+	const MockGame mg(MockMap::ePageConditions);
+	using Cmd = EventProgram::Cmd;
+	using Owner = EventProgram::Owner;
+
+	auto program = EventProgram::GetShared(Owner::MapEvent, 2, 1, Game_Map::GetEvent(2)->GetPage(1)->event_commands);
+	REQUIRE_EQ(program->FindLabel(2), 3);
+
+	// Event 3 replaces event 2, the command list has the same length
+	REQUIRE(Game_Map::CloneMapEvent(Game_Map::GetMapId(), 3, 1, 0, 2, ""));
+	auto cloned = EventProgram::GetShared(Owner::MapEvent, 2, 1, Game_Map::GetEvent(2)->GetPage(1)->event_commands);
+	REQUIRE_NE(cloned.get(), program.get());
+	REQUIRE_EQ(cloned->FindNext(1, { Cmd::EndLoop }, 0), 2);
+	REQUIRE_EQ(cloned->FindLabel(2), -1);
+	REQUIRE_EQ(cloned->FindLabel(3), 3);
+
+	EventProgram::ClearShared();
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,55 @@
+#include "game_strings.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Game_Strings");
+
+TEST_CASE("Dense") {
+	Game_Strings s;
+
+	REQUIRE_EQ(s.Get(3), "");
+	s.Asg({ 3 }, "");
+	REQUIRE(s.GetData().empty());
+
+	REQUIRE_EQ(s.Asg({ 3 }, "abc"), "abc");
+	REQUIRE_EQ(s.GetData().size(), 3u);
+	REQUIRE_EQ(s.Get(1), "");
+	REQUIRE_EQ(s.Get(3), "abc");
+	REQUIRE_EQ(s.Get(4), "");
+
+	REQUIRE_EQ(s.Cat({ 3 }, "def"), "abcdef");
+	REQUIRE_EQ(s.Cat({ 5 }, "x"), "x");
+	REQUIRE_EQ(s.GetData().size(), 5u);
+
+	// Source pointing into the table
+	REQUIRE_EQ(s.Cat({ 3 }, s.Get(3)), "abcdefabcdef");
+	REQUIRE_EQ(s.Asg({ 10 }, s.Get(5)), "x");
+
+	auto lcf_data = s.GetLcfData();
+	REQUIRE_EQ(lcf_data.size(), 10u);
+	REQUIRE_EQ(ToString(lcf_data[2]), "abcdefabcdef");
+	REQUIRE_EQ(ToString(lcf_data[9]), "x");
+
+	Game_Strings t;
+	t.SetData(lcf_data);
+	REQUIRE_EQ(t.GetData(), s.GetData());
+}
+
+TEST_CASE("Edit") {
+	REQUIRE_EQ(Game_Strings::Insert("abcd", "XY", 2), "abXYcd");
+	REQUIRE_EQ(Game_Strings::Insert("abcd", "XY", -1), "abcXYd");
+	REQUIRE_EQ(Game_Strings::Erase("abcd", 1, 2), "ad");
+	REQUIRE_EQ(Game_Strings::Erase("abcd", 2, 10), "ab");
+	REQUIRE_EQ(Game_Strings::PrependMin("ab", 4, '0'), "00ab");
+	REQUIRE_EQ(Game_Strings::PrependMin("ab", -4, ' '), "ab  ");
+	REQUIRE_EQ(Game_Strings::PrependMin("abcde", 4, '0'), "abcde");
+}
+
+TEST_CASE("RegExReplace") {
+	for (int i = 0; i < 2; ++i) {
+		REQUIRE_EQ(Game_Strings::RegExReplace("a1b22c", "[0-9]+", "#"), "a#b#c");
+	}
+	REQUIRE_EQ(Game_Strings::RegExReplace("a1b22c", "[0-9]", "", std::regex_constants::format_first_only), "ab22c");
+	REQUIRE_THROWS(Game_Strings::RegExReplace("abc", "(", ""));
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,45 @@
+#include "instrumentation.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Instrumentation");
+
+TEST_CASE("ZoneNames") {
+	for (int i = 0; i < Instrumentation::num_zones; ++i) {
+		REQUIRE(Instrumentation::GetZoneName(static_cast<Instrumentation::Zone>(i)));
+	}
+	REQUIRE_EQ(std::string(Instrumentation::GetZoneName(Instrumentation::Zone::GraphicsDraw)), "Graphics::Draw");
+}
+
+TEST_CASE("RecentFrames") {
+	Instrumentation::EnableProfiler({});
+	REQUIRE(Instrumentation::IsProfilerEnabled());
+
+	auto before = Instrumentation::GetRecentFrames().size();
+
+	for (int i = 0; i < 3; ++i) {
+		Instrumentation::FrameScope frame;
+		Instrumentation::ZoneScope zone(Instrumentation::Zone::SceneUpdate);
+		Game_Clock::SleepFor(std::chrono::milliseconds(1));
+	}
+
+	auto frames = Instrumentation::GetRecentFrames();
+	REQUIRE_EQ(frames.size(), before + 3);
+
+	auto& last = frames.back();
+	auto scene = last.zones[static_cast<int>(Instrumentation::Zone::SceneUpdate)];
+	REQUIRE(scene >= std::chrono::milliseconds(1));
+	REQUIRE(last.total >= scene);
+	REQUIRE_EQ(last.zones[static_cast<int>(Instrumentation::Zone::AudioDecode)].count(), 0);
+}
+
+TEST_CASE("RingBuffer") {
+	Instrumentation::EnableProfiler({});
+
+	for (int i = 0; i < Instrumentation::num_recent_frames + 10; ++i) {
+		Instrumentation::FrameScope frame;
+	}
+
+	REQUIRE_EQ(Instrumentation::GetRecentFrames().size(), Instrumentation::num_recent_frames);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,213 @@
+#include "lru_cache.h"
+#include "doctest.h"
+#include <string>
+#include <vector>
+
+using IntCache = LruCache<std::string, int>;
+
+namespace {
+std::vector<std::string> Keys(const IntCache& cache) {
+	std::vector<std::string> keys;
+	for (auto& entry: cache) {
+		keys.push_back(entry.key);
+	}
+	return keys;
+}
+}
+
+TEST_SUITE_BEGIN("LruCache");
+
+TEST_CASE("Default") {
+	IntCache cache;
+
+	REQUIRE_EQ(cache.GetSize(), 0);
+	REQUIRE_EQ(cache.GetCount(), 0);
+	REQUIRE_EQ(cache.GetBudget(), 0);
+	REQUIRE_EQ(cache.begin(), cache.end());
+}
+
+TEST_CASE("InsertFind") {
+	IntCache cache(100);
+
+	cache.Insert("a", 1, 10);
+	cache.Insert("b", 2, 20);
+
+	REQUIRE_EQ(cache.GetSize(), 30);
+	REQUIRE_EQ(cache.GetCount(), 2);
+
+	auto* a = cache.Find("a");
+	REQUIRE(a);
+	REQUIRE_EQ(*a, 1);
+	REQUIRE_FALSE(cache.Find("c"));
+
+	REQUIRE_EQ(cache.GetStats().hits, 1);
+	REQUIRE_EQ(cache.GetStats().misses, 1);
+
+	REQUIRE(cache.Contains("b"));
+	REQUIRE_FALSE(cache.Contains("c"));
+	REQUIRE_EQ(cache.GetStats().hits, 1);
+	REQUIRE_EQ(cache.GetStats().misses, 1);
+}
+
+TEST_CASE("Order") {
+	IntCache cache(100);
+
+	cache.Insert("a", 1, 10);
+	cache.Insert("b", 2, 10);
+	cache.Insert("c", 3, 10);
+	REQUIRE_EQ(Keys(cache), std::vector<std::string>{ "c", "b", "a" });
+
+	cache.Find("a");
+	REQUIRE_EQ(Keys(cache), std::vector<std::string>{ "a", "c", "b" });
+}
+
+TEST_CASE("Replace") {
+	IntCache cache(100);
+
+	cache.Insert("a", 1, 10);
+	cache.Insert("b", 2, 10);
+	cache.Insert("a", 3, 30);
+
+	REQUIRE_EQ(cache.GetSize(), 40);
+	REQUIRE_EQ(cache.GetCount(), 2);
+	REQUIRE_EQ(*cache.Find("a"), 3);
+}
+
+TEST_CASE("Erase") {
+	IntCache cache(100);
+
+	cache.Insert("a", 1, 10);
+	cache.Insert("b", 2, 20);
+
+	REQUIRE(cache.Erase("a"));
+	REQUIRE_FALSE(cache.Erase("a"));
+	REQUIRE_EQ(cache.GetSize(), 20);
+	REQUIRE_EQ(cache.GetCount(), 1);
+}
+
+TEST_CASE("EvictWithinBudget") {
+	IntCache cache(100);
+
+	cache.Insert("a", 1, 50);
+	cache.Insert("b", 2, 50);
+
+	REQUIRE_EQ(cache.Evict([](int) { return true; }), 0);
+	REQUIRE_EQ(cache.GetCount(), 2);
+}
+
+TEST_CASE("EvictLeastRecentlyUsed") {
+	IntCache cache(100);
+
+	cache.Insert("a", 1, 40);
+	cache.Insert("b", 2, 40);
+	cache.Insert("c", 3, 40);
+	cache.Find("a");
+
+	REQUIRE_EQ(cache.Evict([](int) { return true; }), 1);
+	REQUIRE_EQ(Keys(cache), std::vector<std::string>{ "a", "c" });
+	REQUIRE_EQ(cache.GetSize(), 80);
+	REQUIRE_EQ(cache.GetStats().evictions, 1);
+}
+
+TEST_CASE("EvictSkipsPinned") {
+	IntCache cache(50);
+
+	cache.Insert("a", 1, 40);
+	cache.Insert("b", 2, 40);
+	cache.Insert("c", 3, 40);
+
+	// "a" can not be evicted, "b" is the next candidate
+	REQUIRE_EQ(cache.Evict([](int v) { return v != 1; }), 2);
+	REQUIRE_EQ(Keys(cache), std::vector<std::string>{ "a" });
+	REQUIRE_EQ(cache.GetSize(), 40);
+}
+
+TEST_CASE("EvictAllPinned") {
+	IntCache cache(10);
+
+	cache.Insert("a", 1, 40);
+	cache.Insert("b", 2, 40);
+
+	REQUIRE_EQ(cache.Evict([](int) { return false; }), 0);
+	REQUIRE_EQ(cache.GetSize(), 80);
+}
+
+TEST_CASE("EvictPinnedNotRechecked") {
+	IntCache cache(50);
+
+	cache.Insert("a", 1, 40);
+	cache.Insert("b", 2, 40);
+	cache.Insert("c", 3, 40);
+
+	int calls = 0;
+	auto keep = [&](int) { ++calls; return false; };
+
+	REQUIRE_EQ(cache.Evict(keep), 0);
+	REQUIRE_EQ(calls, 3);
+	REQUIRE_EQ(cache.GetPinnedCount(), 3);
+
+	REQUIRE_EQ(cache.Evict(keep), 0);
+	REQUIRE_EQ(calls, 3);
+
+	// Iteration still covers the pinned entries
+	REQUIRE_EQ(Keys(cache), std::vector<std::string>{ "c", "b", "a" });
+}
+
+TEST_CASE("Unpin") {
+	IntCache cache(50);
+
+	cache.Insert("a", 1, 40);
+	cache.Insert("b", 2, 40);
+	cache.Insert("c", 3, 40);
+
+	REQUIRE_EQ(cache.Evict([](int) { return false; }), 0);
+
+	// "b" stays pinned, "a" and "c" are evictable again
+	REQUIRE_EQ(cache.Unpin([](int v) { return v != 2; }), 2);
+	REQUIRE_EQ(cache.GetPinnedCount(), 1);
+	REQUIRE_EQ(Keys(cache).back(), "b");
+
+	REQUIRE_EQ(cache.Evict([](int) { return true; }), 2);
+	REQUIRE_EQ(Keys(cache), std::vector<std::string>{ "b" });
+	REQUIRE_EQ(cache.GetSize(), 40);
+}
+
+TEST_CASE("FindUnpins") {
+	IntCache cache(50);
+
+	cache.Insert("a", 1, 40);
+	cache.Insert("b", 2, 40);
+
+	REQUIRE_EQ(cache.Evict([](int) { return false; }), 0);
+	REQUIRE(cache.Find("a"));
+	REQUIRE_EQ(cache.GetPinnedCount(), 1);
+	REQUIRE_EQ(Keys(cache), std::vector<std::string>{ "a", "b" });
+
+	// Only "a" is checked again, "b" stays pinned
+	int calls = 0;
+	REQUIRE_EQ(cache.Evict([&](int) { ++calls; return true; }), 1);
+	REQUIRE_EQ(calls, 1);
+	REQUIRE_EQ(Keys(cache), std::vector<std::string>{ "b" });
+
+	REQUIRE(cache.Erase("b"));
+	REQUIRE_EQ(cache.GetPinnedCount(), 0);
+	REQUIRE_EQ(cache.GetSize(), 0);
+}
+
+TEST_CASE("Clear") {
+	IntCache cache(100);
+
+	cache.Insert("a", 1, 40);
+	cache.Find("a");
+	cache.Clear();
+
+	REQUIRE_EQ(cache.GetSize(), 0);
+	REQUIRE_EQ(cache.GetCount(), 0);
+	REQUIRE_FALSE(cache.Find("a"));
+	REQUIRE_EQ(cache.GetStats().hits, 1);
+
+	cache.ResetStats();
+	REQUIRE_EQ(cache.GetStats().hits, 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,85 @@
+#include "maniac_patch.h"
+#include "game_interpreter.h"
+#include "game_variables.h"
+#include "main_data.h"
+#include "doctest.h"
+
+#include "mock_game.h"
+
+TEST_SUITE_BEGIN("ManiacPatch");
+
+namespace {
+	constexpr int U8 = 1;
+	constexpr int Var = 8;
+	constexpr int Add = 48;
+	constexpr int Mul = 50;
+	constexpr int Function = 78;
+	constexpr int FnPow = 7;
+
+	// Packs the bytes of an expression into op codes like the event command stores them
+	std::vector<int32_t> Pack(std::initializer_list<int> bytes) {
+		std::vector<int32_t> op_codes((bytes.size() + 3) / 4 + 1, 0);
+		int i = 0;
+		for (int b: bytes) {
+			op_codes[i / 4] |= static_cast<int32_t>(static_cast<uint32_t>(b) << ((i % 4) * 8));
+			++i;
+		}
+		return op_codes;
+	}
+}
+
+TEST_CASE("Constants") {
+	const MockGame mg(MockMap::eNone);
+	Game_Interpreter interpreter;
+
+	// 5 + 3 * 4
+	auto op_codes = Pack({ Add, U8, 5, Mul, U8, 3, U8, 4 });
+	REQUIRE_EQ(ManiacPatch::ParseExpression(op_codes, interpreter), 17);
+	REQUIRE_EQ(ManiacPatch::ParseExpression(op_codes, interpreter), 17);
+
+	// The arguments of functions are stored last to first: pow(2, 3)
+	op_codes = Pack({ Function, FnPow, 2, U8, 3, U8, 2 });
+	REQUIRE_EQ(ManiacPatch::ParseExpression(op_codes, interpreter), 8);
+}
+
+TEST_CASE("Variables") {
+	const MockGame mg(MockMap::eNone);
+	Game_Interpreter interpreter;
+
+	// V[1] + 2
+	auto op_codes = Pack({ Add, Var, U8, 1, U8, 2 });
+
+	Main_Data::game_variables->Set(1, 10);
+	REQUIRE_EQ(ManiacPatch::ParseExpression(op_codes, interpreter), 12);
+
+	Main_Data::game_variables->Set(1, 20);
+	REQUIRE_EQ(ManiacPatch::ParseExpression(op_codes, interpreter), 22);
+}
+
+TEST_CASE("ChangedOpCodes") {
+	const MockGame mg(MockMap::eNone);
+	Game_Interpreter interpreter;
+
+	auto op_codes = Pack({ Add, U8, 1, U8, 2 });
+	REQUIRE_EQ(ManiacPatch::ParseExpression(op_codes, interpreter), 3);
+
+	// Same address, different expression
+	auto changed = Pack({ Mul, U8, 4, U8, 2 });
+	std::copy(changed.begin(), changed.end(), op_codes.begin());
+	REQUIRE_EQ(ManiacPatch::ParseExpression(op_codes, interpreter), 8);
+}
+
+TEST_CASE("MultipleExpressions") {
+	const MockGame mg(MockMap::eNone);
+	Game_Interpreter interpreter;
+
+	auto op_codes = Pack({ U8, 1, Add, U8, 2, U8, 3 });
+	auto results = ManiacPatch::ParseExpressions(op_codes, interpreter);
+	REQUIRE_EQ(results.size(), 2);
+	REQUIRE_EQ(results[0], 1);
+	REQUIRE_EQ(results[1], 5);
+
+	REQUIRE(ManiacPatch::ParseExpressions({}, interpreter).empty());
+}
+
+TEST_SUITE_END();
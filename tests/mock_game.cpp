@@ -9,6 +9,15 @@ static lcf::rpg::Terrain MakeTerrain() {
 	return {};
 }
 
+static lcf::rpg::EventCommand MakeCommand(lcf::rpg::EventCommand::Code code, int indent, int32_t param = 0) {
+	lcf::rpg::EventCommand com;
+	com.code = static_cast<int32_t>(code);
+	com.indent = indent;
+	std::vector<int32_t> params = { param };
+	com.parameters = lcf::DBArray<int32_t>(params.begin(), params.end());
+	return com;
+}
+
 static lcf::rpg::Chipset MakeChipset() {
 	lcf::rpg::Chipset chipset;
 	chipset.passable_data_lower.resize(162, 0xF);
@@ -115,6 +124,36 @@ std::unique_ptr<lcf::rpg::Map> MakeMockMap(MockMap maptag) {
 		case MockMap::eMapCount:
 		case MockMap::ePass40x30:
 			break;
+		case MockMap::ePageConditions:
+			for (int i = 0; i < 3; ++i) {
+				map->events.push_back({});
+				auto& ev = map->events.back();
+				ev.ID = i + 2;
+				ev.x = i + 1;
+
+				ev.pages.push_back({});
+				ev.pages.back().ID = 1;
+				using Cmd = lcf::rpg::EventCommand::Code;
+				ev.pages.back().event_commands = {
+					MakeCommand(Cmd::Loop, 0),
+					MakeCommand(Cmd::BreakLoop, 1),
+					MakeCommand(Cmd::EndLoop, 0),
+					MakeCommand(Cmd::Label, 0, ev.ID),
+				};
+
+				ev.pages.push_back({});
+				auto& cond = ev.pages.back().condition;
+				ev.pages.back().ID = 2;
+				if (i < 2) {
+					cond.flags.switch_a = true;
+					cond.switch_a_id = i + 1;
+				} else {
+					cond.flags.variable = true;
+					cond.variable_id = 1;
+					cond.variable_value = 5;
+				}
+			}
+			break;
 		case MockMap::ePassBlock20x15:
 			for (int y = 0; y < h; ++y) {
 				for (int x = 0; x < w; ++x) {
@@ -22,6 +22,7 @@ enum class MockMap {
 	eNone,
 	ePassBlock20x15, // Left half is passable, right half is blocked
 	ePass40x30,
+	ePageConditions, // Events 2, 3 and 4 have a second page conditioned on switch 1, switch 2 and variable 1 >= 5, the first page ends with a label of the event id
 	eMapCount
 };
 
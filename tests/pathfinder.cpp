@@ -0,0 +1,164 @@
+#include "pathfinder.h"
+#include "doctest.h"
+#include <string>
+#include <vector>
+
+namespace {
+// '#' is a wall, everything else is passable
+struct Grid {
+	std::vector<std::string> rows;
+	bool loop = false;
+
+	bool IsFree(int x, int y) const {
+		int w = static_cast<int>(rows[0].size());
+		int h = static_cast<int>(rows.size());
+		if (loop) {
+			x = (x % w + w) % w;
+			y = (y % h + h) % h;
+		}
+		if (x < 0 || y < 0 || x >= w || y >= h) {
+			return false;
+		}
+		return rows[y][x] != '#';
+	}
+
+	Pathfinder::Args MakeArgs(int sx, int sy, int dx, int dy) const {
+		Pathfinder::Args args;
+		args.width = static_cast<int>(rows[0].size());
+		args.height = static_cast<int>(rows.size());
+		args.loop_horizontal = args.loop_vertical = loop;
+		args.start_x = sx;
+		args.start_y = sy;
+		args.dest_x = dx;
+		args.dest_y = dy;
+		return args;
+	}
+
+	Pathfinder::Result Find(const Pathfinder::Args& args) const {
+		return Pathfinder::FindPath(args, [this](int, int, int to_x, int to_y) {
+			return IsFree(to_x, to_y);
+		});
+	}
+};
+
+constexpr int Up = 0;
+constexpr int Right = 1;
+constexpr int Down = 2;
+constexpr int Left = 3;
+constexpr int UpRight = 4;
+constexpr int DownRight = 5;
+}
+
+TEST_SUITE_BEGIN("Pathfinder");
+
+TEST_CASE("Straight") {
+	Grid grid{{ "....." }};
+
+	auto path = grid.Find(grid.MakeArgs(0, 0, 4, 0));
+	REQUIRE(path.reached);
+	REQUIRE_EQ(path.directions, std::vector<int>{ Right, Right, Right, Right });
+}
+
+TEST_CASE("AroundWall") {
+	Grid grid{{
+		".#.",
+		".#.",
+		"...",
+	}};
+
+	auto path = grid.Find(grid.MakeArgs(0, 0, 2, 0));
+	REQUIRE(path.reached);
+	REQUIRE_EQ(path.directions, std::vector<int>{ Down, Down, Right, Right, Up, Up });
+}
+
+TEST_CASE("Diagonal") {
+	Grid grid{{
+		"...",
+		"...",
+		"...",
+	}};
+
+	auto args = grid.MakeArgs(0, 0, 2, 2);
+	args.allow_diagonal = true;
+	auto path = grid.Find(args);
+	REQUIRE(path.reached);
+	REQUIRE_EQ(path.directions, std::vector<int>{ DownRight, DownRight });
+}
+
+TEST_CASE("DiagonalStepCost") {
+	Grid grid{{
+		".....",
+		"...#.",
+		"...#.",
+		".....",
+	}};
+
+	// Diagonal steps cost the same as straight steps, the fewest steps win
+	auto args = grid.MakeArgs(0, 0, 4, 2);
+	args.allow_diagonal = true;
+	auto path = grid.Find(args);
+	REQUIRE(path.reached);
+	REQUIRE_EQ(path.directions, std::vector<int>{ DownRight, DownRight, DownRight, UpRight });
+}
+
+TEST_CASE("DiagonalCorner") {
+	Grid grid{{
+		".#",
+		"#.",
+	}};
+
+	auto args = grid.MakeArgs(0, 0, 1, 1);
+	args.allow_diagonal = true;
+	auto path = grid.Find(args);
+	REQUIRE_FALSE(path.reached);
+	REQUIRE(path.directions.empty());
+}
+
+TEST_CASE("Loop") {
+	Grid grid{{ "......" }, true};
+
+	auto path = grid.Find(grid.MakeArgs(1, 0, 5, 0));
+	REQUIRE(path.reached);
+	REQUIRE_EQ(path.directions, std::vector<int>{ Left, Left });
+}
+
+TEST_CASE("Unreachable") {
+	Grid grid{{
+		"...#.",
+		"...#.",
+	}};
+
+	// Ends next to the wall, closest to the destination
+	auto path = grid.Find(grid.MakeArgs(0, 0, 4, 0));
+	REQUIRE_FALSE(path.reached);
+	REQUIRE_EQ(path.directions, std::vector<int>{ Right, Right });
+}
+
+TEST_CASE("SearchMax") {
+	Grid grid{{ ".........." }};
+
+	auto args = grid.MakeArgs(0, 0, 9, 0);
+	args.search_max = 4;
+	auto path = grid.Find(args);
+	REQUIRE_FALSE(path.reached);
+	REQUIRE_EQ(path.expanded, 4);
+	REQUIRE_EQ(path.directions.size(), 3);
+}
+
+TEST_CASE("Budget") {
+	Grid grid{{ ".........." }};
+
+	Pathfinder::ResetFrameBudget();
+	REQUIRE(Pathfinder::HasFrameBudget());
+
+	auto args = grid.MakeArgs(0, 0, 9, 0);
+	for (int i = 0; i < Pathfinder::frame_budget / 10; ++i) {
+		grid.Find(args);
+	}
+	REQUIRE_FALSE(Pathfinder::HasFrameBudget());
+
+	Pathfinder::ResetFrameBudget();
+	REQUIRE(Pathfinder::HasFrameBudget());
+}
+
+TEST_SUITE_END();
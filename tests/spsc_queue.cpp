@@ -0,0 +1,80 @@
+#include "spsc_queue.h"
+#include "doctest.h"
+#include <memory>
+
+#ifdef WANT_ASYNC_DECODE
+#include <thread>
+#endif
+
+TEST_SUITE_BEGIN("SpscQueue");
+
+TEST_CASE("PushPop") {
+	SpscQueue<int, 4> queue;
+	int value = 0;
+
+	REQUIRE(queue.IsEmpty());
+	REQUIRE_FALSE(queue.Pop(value));
+
+	for (int i = 0; i < 4; ++i) {
+		REQUIRE(queue.Push(int(i)));
+	}
+	REQUIRE_FALSE(queue.Push(4));
+
+	for (int i = 0; i < 4; ++i) {
+		REQUIRE(queue.Pop(value));
+		REQUIRE_EQ(value, i);
+	}
+	REQUIRE(queue.IsEmpty());
+}
+
+TEST_CASE("MoveOnly") {
+	SpscQueue<std::unique_ptr<int>, 2> queue;
+
+	REQUIRE(queue.Push(std::make_unique<int>(1)));
+	REQUIRE(queue.Push(std::make_unique<int>(2)));
+
+	// A rejected element stays with the caller
+	auto rejected = std::make_unique<int>(3);
+	REQUIRE_FALSE(queue.Push(std::move(rejected)));
+	REQUIRE(rejected);
+
+	std::unique_ptr<int> value;
+	REQUIRE(queue.Pop(value));
+	REQUIRE_EQ(*value, 1);
+	REQUIRE(queue.Push(std::move(rejected)));
+	REQUIRE(queue.Pop(value));
+	REQUIRE_EQ(*value, 2);
+	REQUIRE(queue.Pop(value));
+	REQUIRE_EQ(*value, 3);
+}
+
+#ifdef WANT_ASYNC_DECODE
+TEST_CASE("Threads") {
+	constexpr int count = 100000;
+	SpscQueue<int, 64> queue;
+
+	std::thread producer([&]() {
+		for (int i = 0; i < count; ++i) {
+			while (!queue.Push(int(i))) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	int expected = 0;
+	while (expected < count) {
+		int value;
+		if (queue.Pop(value)) {
+			REQUIRE_EQ(value, expected);
+			++expected;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	REQUIRE(queue.IsEmpty());
+}
+#endif
+
+TEST_SUITE_END();
@@ -123,6 +123,65 @@ TEST_CASE("FlipRange") {
 	REQUIRE_FALSE(s.Get(n + 1));
 }
 
+TEST_CASE("RangeWordBoundaries") {
+	constexpr int n = 200;
+	auto s = make();
+	std::vector<bool> expected(n);
+
+	auto check = [&]() {
+		for (int i = 1; i <= n; ++i) {
+			REQUIRE_EQ(s.Get(i), expected[i - 1]);
+		}
+	};
+
+	s.SetRange(60, 70, true);
+	for (int i = 60; i <= 70; ++i) {
+		expected[i - 1] = true;
+	}
+	check();
+
+	s.FlipRange(1, 130);
+	for (int i = 1; i <= 130; ++i) {
+		expected[i - 1] = !expected[i - 1];
+	}
+	check();
+
+	s.SetRange(64, 65, false);
+	expected[63] = expected[64] = false;
+	check();
+
+	s.FlipRange(128, n);
+	for (int i = 128; i <= n; ++i) {
+		expected[i - 1] = !expected[i - 1];
+	}
+	check();
+
+	REQUIRE_EQ(s.GetSize(), n);
+	REQUIRE(s.GetData() == expected);
+}
+
+TEST_CASE("SetData") {
+	auto s = make();
+	std::vector<bool> data(70);
+	data[0] = data[63] = data[64] = data[69] = true;
+
+	s.SetData(data);
+	REQUIRE_EQ(s.GetSize(), 70);
+	REQUIRE(s.Get(1));
+	REQUIRE_FALSE(s.Get(2));
+	REQUIRE(s.Get(64));
+	REQUIRE(s.Get(65));
+	REQUIRE(s.Get(70));
+	REQUIRE(s.GetData() == data);
+
+	// Growing does not reveal old bits
+	s.SetData(std::vector<bool>(3, true));
+	s.Set(100, false);
+	for (int i = 4; i <= 100; ++i) {
+		REQUIRE_FALSE(s.Get(i));
+	}
+}
+
 TEST_CASE("GetSize") {
 	auto s = make();
 	REQUIRE_EQ(s.GetSizeWithLimit(), max_switches);
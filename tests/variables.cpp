@@ -555,6 +555,44 @@ TEST_CASE("Overflow/Underflow") {
 	REQUIRE(v.Get(1) == _min);
 }
 
+TEST_CASE("RangeMatchesSingle") {
+	// Long ranges go through the vector kernels, they must saturate and clamp like the single variable operations
+	constexpr int n = 37;
+	lcf::Data::variables.resize(n);
+
+	Game_Variables::Var_t values[] = { 0, 1, -1, 7, maxval, minval, maxval - 3, minval + 3 };
+	Game_Variables::Var_t operands[] = { 5, -5, maxval, minval, 0x0F0F0F };
+
+	using RangeFn = void (Game_Variables::*)(int, int, Game_Variables::Var_t);
+	using SingleFn = Game_Variables::Var_t (Game_Variables::*)(int, Game_Variables::Var_t);
+	std::pair<RangeFn, SingleFn> ops[] = {
+		{ &Game_Variables::SetRange, &Game_Variables::Set },
+		{ &Game_Variables::AddRange, &Game_Variables::Add },
+		{ &Game_Variables::SubRange, &Game_Variables::Sub },
+		{ &Game_Variables::MultRange, &Game_Variables::Mult },
+		{ &Game_Variables::BitOrRange, &Game_Variables::BitOr },
+		{ &Game_Variables::BitAndRange, &Game_Variables::BitAnd },
+		{ &Game_Variables::BitXorRange, &Game_Variables::BitXor },
+	};
+
+	for (auto& op: ops) {
+		for (auto operand: operands) {
+			Game_Variables range(minval, maxval);
+			Game_Variables single(minval, maxval);
+			for (int i = 1; i <= n; ++i) {
+				range.Set(i, values[i % 8]);
+				single.Set(i, values[i % 8]);
+			}
+
+			(range.*op.first)(2, n - 1, operand);
+			for (int i = 2; i <= n - 1; ++i) {
+				(single.*op.second)(i, operand);
+			}
+			REQUIRE(range.GetData() == single.GetData());
+		}
+	}
+}
+
 TEST_CASE("Enumerate") {
 	auto s = make();
 